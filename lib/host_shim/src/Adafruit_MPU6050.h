@@ -0,0 +1,52 @@
+/**
+ * Host Shim - Adafruit MPU6050
+ *
+ * Same interface as the Adafruit driver, with no device behind it:
+ * begin() and getEvent() fail, exactly as on a board with no IMU fitted.
+ */
+
+#pragma once
+
+#include "Wire.h"
+#include "Adafruit_Sensor.h"
+
+#define MPU6050_I2CADDR_DEFAULT 0x68
+
+typedef enum {
+    MPU6050_RANGE_2_G,
+    MPU6050_RANGE_4_G,
+    MPU6050_RANGE_8_G,
+    MPU6050_RANGE_16_G
+} mpu6050_accel_range_t;
+
+typedef enum {
+    MPU6050_RANGE_250_DEG,
+    MPU6050_RANGE_500_DEG,
+    MPU6050_RANGE_1000_DEG,
+    MPU6050_RANGE_2000_DEG
+} mpu6050_gyro_range_t;
+
+typedef enum {
+    MPU6050_BAND_260_HZ,
+    MPU6050_BAND_184_HZ,
+    MPU6050_BAND_94_HZ,
+    MPU6050_BAND_44_HZ,
+    MPU6050_BAND_21_HZ,
+    MPU6050_BAND_10_HZ,
+    MPU6050_BAND_5_HZ
+} mpu6050_bandwidth_t;
+
+class Adafruit_MPU6050 {
+public:
+    bool begin(uint8_t address = MPU6050_I2CADDR_DEFAULT, TwoWire* wire = &Wire, int32_t sensorId = 0) {
+        (void)address; (void)wire; (void)sensorId;
+        return false;
+    }
+    void setAccelerometerRange(mpu6050_accel_range_t range) { (void)range; }
+    void setGyroRange(mpu6050_gyro_range_t range) { (void)range; }
+    void setFilterBandwidth(mpu6050_bandwidth_t bandwidth) { (void)bandwidth; }
+    bool getEvent(sensors_event_t* accel, sensors_event_t* gyro, sensors_event_t* temp) {
+        (void)accel; (void)gyro; (void)temp;
+        return false;
+    }
+};
@@ -0,0 +1,26 @@
+/**
+ * Host Shim - Adafruit Unified Sensor types
+ *
+ * Only the event fields read by the IMU driver.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+    float x;
+    float y;
+    float z;
+} sensors_vec_t;
+
+typedef struct {
+    int32_t version;
+    int32_t sensor_id;
+    int32_t type;
+    int32_t reserved0;
+    int32_t timestamp;
+    sensors_vec_t acceleration;
+    sensors_vec_t gyro;
+    float temperature;
+} sensors_event_t;
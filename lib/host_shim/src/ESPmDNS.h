@@ -0,0 +1,18 @@
+/**
+ * Host Arduino Shim - mDNS responder (no network, nothing announced)
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+class MDNSResponder {
+public:
+    bool begin(const char* hostName) { (void)hostName; return true; }
+    void end() {}
+    void addService(const char* service, const char* proto, uint16_t port) {
+        (void)service; (void)proto; (void)port;
+    }
+};
+
+extern MDNSResponder MDNS;
@@ -0,0 +1,17 @@
+/**
+ * Host Arduino Shim - ESP class
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+class EspClass {
+public:
+    uint32_t getFreeHeap() { return 256 * 1024; }
+    uint32_t getMinFreeHeap() { return 256 * 1024; }
+    uint32_t getHeapSize() { return 320 * 1024; }
+    void restart();
+};
+
+extern EspClass ESP;
@@ -0,0 +1,42 @@
+/**
+ * Host Arduino Shim - HardwareSerial
+ *
+ * UART0 (Serial) writes to stdout. Other UARTs read from a per-port
+ * receive buffer that host code fills with hostSerialInject().
+ */
+
+#pragma once
+
+#include "Print.h"
+
+#define SERIAL_8N1 0x800001c
+
+class HardwareSerial : public Stream {
+public:
+    explicit HardwareSerial(int uartNum) : uartNum(uartNum) {}
+
+    void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1, int8_t txPin = -1);
+    void end();
+
+    int available() override;
+    int read() override;
+    int peek() override;
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    void flush() override;
+
+    operator bool() const { return true; }
+
+private:
+    int uartNum;
+};
+
+// Append bytes to the receive buffer of a UART (e.g. a recorded NMEA stream)
+void hostSerialInject(int uartNum, const uint8_t* data, size_t length);
+void hostSerialInject(int uartNum, const char* text);
+// Drop everything pending in a UART receive buffer
+void hostSerialClear(int uartNum);
+
+extern HardwareSerial Serial;
@@ -0,0 +1,34 @@
+/**
+ * Host Arduino Shim - IPAddress
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "WString.h"
+
+class IPAddress {
+public:
+    IPAddress() : octets{0, 0, 0, 0} {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : octets{a, b, c, d} {}
+
+    bool fromString(const char* address) {
+        unsigned int a, b, c, d;
+        if (sscanf(address, "%u.%u.%u.%u", &a, &b, &c, &d) != 4) return false;
+        octets[0] = a; octets[1] = b; octets[2] = c; octets[3] = d;
+        return true;
+    }
+
+    String toString() const {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+        return String(buf);
+    }
+
+    uint8_t operator[](int index) const { return octets[index]; }
+
+private:
+    uint8_t octets[4];
+};
@@ -0,0 +1,93 @@
+/**
+ * Host Arduino Shim - Print/Stream
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+
+class Print {
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t n = 0;
+        while (size--) n += write(*buffer++);
+        return n;
+    }
+    size_t write(const char* str) {
+        return str ? write((const uint8_t*)str, strlen(str)) : 0;
+    }
+    virtual void flush() {}
+
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int n, int base = DEC) { return printNumber((long)n, base); }
+    size_t print(unsigned int n, int base = DEC) { return printNumber((unsigned long)n, base); }
+    size_t print(long n, int base = DEC) { return printNumber(n, base); }
+    size_t print(unsigned long n, int base = DEC) { return printNumber(n, base); }
+    size_t print(double n, int digits = 2) { return printf("%.*f", digits, n); }
+
+    size_t println() { return write("\r\n"); }
+    template<typename T>
+    size_t println(const T& value) { size_t n = print(value); return n + println(); }
+    template<typename T>
+    size_t println(const T& value, int format) { size_t n = print(value, format); return n + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        char stackBuf[256];
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(stackBuf, sizeof(stackBuf), format, args);
+        va_end(args);
+        if (len < 0) return 0;
+        if ((size_t)len < sizeof(stackBuf)) {
+            return write((const uint8_t*)stackBuf, len);
+        }
+        char* heapBuf = new char[len + 1];
+        va_start(args, format);
+        vsnprintf(heapBuf, len + 1, format, args);
+        va_end(args);
+        size_t n = write((const uint8_t*)heapBuf, len);
+        delete[] heapBuf;
+        return n;
+    }
+
+private:
+    size_t printNumber(long n, int base) {
+        if (base == HEX) return printf("%lX", n);
+        return printf("%ld", n);
+    }
+    size_t printNumber(unsigned long n, int base) {
+        if (base == HEX) return printf("%lX", n);
+        return printf("%lu", n);
+    }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    size_t readBytes(uint8_t* buffer, size_t length) {
+        size_t count = 0;
+        while (count < length) {
+            int c = read();
+            if (c < 0) break;
+            buffer[count++] = (uint8_t)c;
+        }
+        return count;
+    }
+};
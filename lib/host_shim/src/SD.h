@@ -0,0 +1,50 @@
+/**
+ * Host Arduino Shim - SD
+ *
+ * The mount point passed to begin() is used as a host directory, so
+ * paths like "/rally_000.bin" land in <mountpoint>/rally_000.bin.
+ */
+
+#pragma once
+
+#include "FS.h"
+#include "SPI.h"
+
+typedef enum {
+    CARD_NONE,
+    CARD_MMC,
+    CARD_SD,
+    CARD_SDHC,
+    CARD_UNKNOWN
+} sdcard_type_t;
+
+namespace fs {
+
+class SDFS : public FS {
+public:
+    SDFS() : FS("/sd") {}
+
+    bool begin(uint8_t ssPin = SS, SPIClass& spi = SPI, uint32_t frequency = 4000000,
+               const char* mountpoint = "/sd", uint8_t maxFiles = 5, bool formatIfEmpty = false);
+    void end();
+    sdcard_type_t cardType();
+    uint64_t cardSize();
+    uint64_t totalBytes();
+    uint64_t usedBytes();
+
+    // Host only: act as a card of this size, with the files in the mount
+    // point as its only contents (0 = report the host disk)
+    void setCardSize(uint64_t bytes) { simulatedSize = bytes; }
+
+    // Host only: make every file write take at least this long, like a
+    // slow card (0 = as fast as the host disk)
+    void setWriteDelay(uint32_t us);
+
+private:
+    uint64_t simulatedSize = 0;
+};
+
+} // namespace fs
+
+extern fs::SDFS SD;
+using namespace fs;
@@ -0,0 +1,19 @@
+/**
+ * Host Arduino Shim - SPI
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define SS 5
+
+class SPIClass {
+public:
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {
+        (void)sck; (void)miso; (void)mosi; (void)ss;
+    }
+    void end() {}
+};
+
+extern SPIClass SPI;
@@ -0,0 +1,29 @@
+/**
+ * Host Arduino Shim - SPIFFS
+ *
+ * Backed by a host directory like SD (SPIFFS_MOUNT_POINT, default
+ * ".pio/native_spiffs"). It starts empty, so the web UI falls back to
+ * its built-in page.
+ */
+
+#pragma once
+
+#include "FS.h"
+
+#ifndef SPIFFS_MOUNT_POINT
+#define SPIFFS_MOUNT_POINT ".pio/native_spiffs"
+#endif
+
+namespace fs {
+    
+class SPIFFSFS : public FS {
+public:
+    SPIFFSFS() : FS(SPIFFS_MOUNT_POINT) {}
+        
+    bool begin(bool formatOnFail = false);
+    void end();
+};
+    
+} // namespace fs
+
+extern fs::SPIFFSFS SPIFFS;
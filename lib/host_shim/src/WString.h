@@ -0,0 +1,76 @@
+/**
+ * Host Arduino Shim - String
+ *
+ * Arduino String backed by std::string. Covers the constructors and
+ * operators this project uses.
+ */
+
+#pragma once
+
+#include <string>
+#include <stdio.h>
+
+class String {
+public:
+    String() {}
+    String(const char* s) : str(s ? s : "") {}
+    String(const std::string& s) : str(s) {}
+    String(char c) : str(1, c) {}
+    String(int n) : str(std::to_string(n)) {}
+    String(unsigned int n) : str(std::to_string(n)) {}
+    String(long n) : str(std::to_string(n)) {}
+    String(unsigned long n) : str(std::to_string(n)) {}
+    String(long long n) : str(std::to_string(n)) {}
+    String(unsigned long long n) : str(std::to_string(n)) {}
+    String(float n, unsigned int decimals = 2) : str(formatFloat(n, decimals)) {}
+    String(double n, unsigned int decimals = 2) : str(formatFloat(n, decimals)) {}
+
+    const char* c_str() const { return str.c_str(); }
+    unsigned int length() const { return (unsigned int)str.length(); }
+    bool isEmpty() const { return str.empty(); }
+
+    String& operator+=(const String& rhs) { str += rhs.str; return *this; }
+    String& operator+=(const char* rhs) { str += rhs; return *this; }
+    String& operator+=(char c) { str += c; return *this; }
+    bool concat(const String& rhs) { str += rhs.str; return true; }
+    void reserve(unsigned int size) { str.reserve(size); }
+
+    friend String operator+(const String& lhs, const String& rhs) { return String(lhs.str + rhs.str); }
+    friend String operator+(const String& lhs, const char* rhs) { return String(lhs.str + rhs); }
+    friend String operator+(const char* lhs, const String& rhs) { return String(lhs + rhs.str); }
+
+    bool operator==(const String& rhs) const { return str == rhs.str; }
+    bool operator==(const char* rhs) const { return str == rhs; }
+    bool operator!=(const String& rhs) const { return str != rhs.str; }
+    char operator[](unsigned int index) const { return index < str.length() ? str[index] : 0; }
+
+    bool startsWith(const String& prefix) const { return str.compare(0, prefix.str.length(), prefix.str) == 0; }
+    bool endsWith(const String& suffix) const {
+        return str.length() >= suffix.str.length() &&
+               str.compare(str.length() - suffix.str.length(), suffix.str.length(), suffix.str) == 0;
+    }
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t pos = str.find(c, from);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    int lastIndexOf(char c) const {
+        size_t pos = str.rfind(c);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    String substring(unsigned int begin) const { return begin < str.length() ? String(str.substr(begin)) : String(); }
+    String substring(unsigned int begin, unsigned int end) const {
+        if (begin >= str.length() || end <= begin) return String();
+        return String(str.substr(begin, end - begin));
+    }
+    long toInt() const { return atol(str.c_str()); }
+    float toFloat() const { return (float)atof(str.c_str()); }
+
+private:
+    std::string str;
+
+    static std::string formatFloat(double n, unsigned int decimals) {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%.*f", (int)decimals, n);
+        return std::string(buf);
+    }
+};
@@ -0,0 +1,60 @@
+/**
+ * Host Arduino Shim - WebServer
+ *
+ * Routes can be registered, but no request ever arrives on a host, so
+ * the handlers never run.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include "FS.h"
+#include <functional>
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+
+typedef enum {
+    HTTP_ANY,
+    HTTP_GET,
+    HTTP_HEAD,
+    HTTP_POST,
+    HTTP_PUT,
+    HTTP_PATCH,
+    HTTP_DELETE,
+    HTTP_OPTIONS
+} HTTPMethod;
+
+class WebServer {
+public:
+    typedef std::function<void(void)> THandlerFunction;
+    
+    explicit WebServer(int port = 80) { (void)port; }
+    
+    void begin() {}
+    void stop() {}
+    void handleClient() {}
+    
+    void on(const String& uri, HTTPMethod method, THandlerFunction handler) {
+        (void)uri; (void)method; (void)handler;
+    }
+    void onNotFound(THandlerFunction handler) { (void)handler; }
+    
+    String uri() { return String(); }
+    String arg(const String& name) { (void)name; return String(); }
+    bool hasArg(const String& name) { (void)name; return false; }
+    
+    void send(int code, const char* contentType, const String& content) {
+        (void)code; (void)contentType; (void)content;
+    }
+    void sendHeader(const String& name, const String& value, bool first = false) {
+        (void)name; (void)value; (void)first;
+    }
+    void setContentLength(size_t length) { (void)length; }
+    void sendContent(const String& content) { (void)content; }
+    void sendContent(const char* content, size_t size) { (void)content; (void)size; }
+    
+    size_t streamFile(File& file, const String& contentType) {
+        (void)contentType;
+        return file.size();
+    }
+};
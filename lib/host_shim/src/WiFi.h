@@ -0,0 +1,70 @@
+/**
+ * Host Arduino Shim - WiFi
+ *
+ * There is no radio on a host: the soft AP comes up with nobody to join
+ * it, station mode never connects and no TCP client ever arrives.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include "IPAddress.h"
+#include <time.h>
+
+// glibc's <time.h> defines STA_MODE (an adjtimex flag); the ESP32 core
+// leaves the name free and firmware code uses it
+#undef STA_MODE
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} wifi_mode_t;
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+class WiFiClient {
+public:
+    uint8_t connected() { return 0; }
+    size_t write(const uint8_t* buffer, size_t size) { (void)buffer; return size; }
+    void stop() {}
+    operator bool() { return false; }
+};
+
+class WiFiClass {
+public:
+    bool mode(wifi_mode_t m) { currentMode = m; return true; }
+    wifi_mode_t getMode() { return currentMode; }
+    
+    bool softAPConfig(IPAddress local, IPAddress gateway, IPAddress subnet) {
+        (void)gateway; (void)subnet;
+        apIP = local;
+        return true;
+    }
+    bool softAP(const char* ssid, const char* passphrase = nullptr) {
+        (void)ssid; (void)passphrase;
+        return true;
+    }
+    IPAddress softAPIP() { return apIP; }
+    
+    wl_status_t begin(const char* ssid, const char* passphrase = nullptr) {
+        (void)ssid; (void)passphrase;
+        return WL_DISCONNECTED;
+    }
+    bool disconnect(bool wifiOff = false) { (void)wifiOff; return true; }
+    wl_status_t status() { return WL_DISCONNECTED; }
+    IPAddress localIP() { return IPAddress(); }
+    int8_t RSSI() { return 0; }
+    
+private:
+    wifi_mode_t currentMode = WIFI_OFF;
+    IPAddress apIP;
+};
+
+extern WiFiClass WiFi;
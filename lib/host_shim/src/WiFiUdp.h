@@ -0,0 +1,34 @@
+/**
+ * Host Arduino Shim - WiFiUDP
+ *
+ * Datagrams are accepted and dropped; the counters show what would have
+ * gone out.
+ */
+
+#pragma once
+
+#include "WiFi.h"
+
+class WiFiUDP {
+public:
+    uint8_t begin(uint16_t port) { (void)port; return 1; }
+    void stop() {}
+    
+    int beginPacket(IPAddress address, uint16_t port) { (void)address; (void)port; return 1; }
+    size_t write(const uint8_t* buffer, size_t size) { (void)buffer; pending += size; return size; }
+    int endPacket() {
+        packetsSent++;
+        bytesSent += pending;
+        pending = 0;
+        return 1;
+    }
+    
+    // Host only
+    uint32_t getPacketsSent() const { return packetsSent; }
+    uint64_t getBytesSent() const { return bytesSent; }
+    
+private:
+    size_t pending = 0;
+    uint32_t packetsSent = 0;
+    uint64_t bytesSent = 0;
+};
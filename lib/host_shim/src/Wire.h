@@ -0,0 +1,31 @@
+/**
+ * Host Arduino Shim - Wire (I2C)
+ *
+ * There is no I2C bus on a host; transactions report no device present.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+class TwoWire {
+public:
+    bool setPins(int sda, int scl) { (void)sda; (void)scl; return true; }
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) {
+        (void)sda; (void)scl; (void)frequency;
+        return true;
+    }
+    bool setClock(uint32_t frequency) { (void)frequency; return true; }
+    void beginTransmission(uint8_t address) { (void)address; }
+    uint8_t endTransmission(bool sendStop = true) { (void)sendStop; return 2; }  // NACK on address
+    size_t requestFrom(uint8_t address, size_t length, bool sendStop = true) {
+        (void)address; (void)length; (void)sendStop;
+        return 0;
+    }
+    size_t write(uint8_t data) { (void)data; return 0; }
+    int available() { return 0; }
+    int read() { return -1; }
+};
+
+extern TwoWire Wire;
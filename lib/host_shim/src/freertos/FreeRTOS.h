@@ -0,0 +1,53 @@
+/**
+ * Host FreeRTOS Shim
+ *
+ * Minimal FreeRTOS API on top of pthreads/std::thread so the firmware's
+ * queue, semaphore and task code can run on a Linux or macOS host.
+ * Only the subset used by this project is provided.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef void (*TaskFunction_t)(void*);
+
+struct HostTask;
+struct HostQueue;
+typedef HostTask* TaskHandle_t;
+typedef HostQueue* QueueHandle_t;
+typedef HostQueue* SemaphoreHandle_t;
+
+#define pdTRUE  ((BaseType_t)1)
+#define pdFALSE ((BaseType_t)0)
+#define pdPASS  pdTRUE
+#define pdFAIL  pdFALSE
+#define errQUEUE_FULL  ((BaseType_t)0)
+#define errQUEUE_EMPTY ((BaseType_t)0)
+
+#define configTICK_RATE_HZ    1000
+#define configMAX_PRIORITIES  25
+#define portMAX_DELAY         ((TickType_t)0xFFFFFFFFUL)
+#define portTICK_PERIOD_MS    ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)     ((TickType_t)(((TickType_t)(ms) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000U))
+#define tskNO_AFFINITY        0x7FFFFFFF
+
+// Critical sections map onto a single process-wide recursive lock
+typedef struct { int owner; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED { 0 }
+void hostEnterCritical(portMUX_TYPE* mux);
+void hostExitCritical(portMUX_TYPE* mux);
+#define portENTER_CRITICAL(mux)        hostEnterCritical(mux)
+#define portEXIT_CRITICAL(mux)         hostExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux)    hostEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux)     hostExitCritical(mux)
+#define taskENTER_CRITICAL(mux)        hostEnterCritical(mux)
+#define taskEXIT_CRITICAL(mux)         hostExitCritical(mux)
+
+#define portYIELD_FROM_ISR(...)        do { } while (0)
+
+BaseType_t xPortGetCoreID();
@@ -0,0 +1,32 @@
+/**
+ * Host FreeRTOS Shim - Tasks
+ *
+ * Tasks run on detached std::threads. Priorities and core affinity are
+ * recorded but not enforced by the host scheduler.
+ */
+
+#pragma once
+
+#include "FreeRTOS.h"
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                                   void* params, UBaseType_t priority,
+                                   TaskHandle_t* handle, BaseType_t coreId);
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                       void* params, UBaseType_t priority, TaskHandle_t* handle);
+void vTaskDelete(TaskHandle_t task);
+
+TickType_t xTaskGetTickCount();
+TickType_t xTaskGetTickCountFromISR();
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* previousWakeTime, TickType_t increment);
+BaseType_t xTaskDelayUntil(TickType_t* previousWakeTime, TickType_t increment);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+const char* pcTaskGetName(TaskHandle_t task);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+void taskYIELD();
+
+// Direct-to-task notifications (single notification value per task)
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken);
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
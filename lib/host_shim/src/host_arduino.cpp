@@ -0,0 +1,205 @@
+#include "Arduino.h"
+#include "Wire.h"
+#include "esp_timer.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+EspClass ESP;
+TwoWire Wire;
+HardwareSerial Serial(0);
+
+// =============================================================================
+// TIME
+// =============================================================================
+
+static const std::chrono::steady_clock::time_point s_startTime = std::chrono::steady_clock::now();
+
+uint32_t millis() {
+    auto elapsed = std::chrono::steady_clock::now() - s_startTime;
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+}
+
+uint32_t micros() {
+    auto elapsed = std::chrono::steady_clock::now() - s_startTime;
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+void delay(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+// =============================================================================
+// GPIO (no-ops on host)
+// =============================================================================
+
+void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+void digitalWrite(uint8_t pin, uint8_t value) { (void)pin; (void)value; }
+int digitalRead(uint8_t pin) { (void)pin; return LOW; }
+int digitalPinToInterrupt(uint8_t pin) { return pin; }
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode) { (void)interrupt; (void)handler; (void)mode; }
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode) { (void)pin; (void)handler; (void)arg; (void)mode; }
+void detachInterrupt(uint8_t interrupt) { (void)interrupt; }
+
+// =============================================================================
+// ESP TIMER
+// =============================================================================
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void* arg;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool running = false;
+    std::thread thread;
+};
+
+int64_t esp_timer_get_time() {
+    auto elapsed = std::chrono::steady_clock::now() - s_startTime;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* outHandle) {
+    if (!args || !args->callback || !outHandle) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_timer* timer = new esp_timer();
+    timer->callback = args->callback;
+    timer->arg = args->arg;
+    *outHandle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs) {
+    if (!timer || periodUs == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard<std::mutex> lock(timer->mutex);
+    if (timer->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->running = true;
+    
+    timer->thread = std::thread([timer, periodUs]() {
+        const std::chrono::microseconds period(periodUs);
+        std::chrono::steady_clock::time_point due = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(timer->mutex);
+        while (true) {
+            due += period;
+            if (timer->wake.wait_until(lock, due, [timer]() { return !timer->running; })) {
+                return;
+            }
+            lock.unlock();
+            timer->callback(timer->arg);
+            lock.lock();
+        }
+    });
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (!timer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    {
+        std::lock_guard<std::mutex> lock(timer->mutex);
+        if (!timer->running) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        timer->running = false;
+    }
+    timer->wake.notify_all();
+    if (timer->thread.get_id() == std::this_thread::get_id()) {
+        timer->thread.detach();     // Stopped from its own callback
+    } else {
+        timer->thread.join();
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    if (!timer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    delete timer;
+    return ESP_OK;
+}
+
+void EspClass::restart() {
+    exit(0);
+}
+
+// =============================================================================
+// SERIAL
+// =============================================================================
+
+static const int HOST_UART_COUNT = 3;
+static std::mutex s_uartMutex;
+static std::deque<uint8_t> s_uartRx[HOST_UART_COUNT];
+
+void hostSerialInject(int uartNum, const uint8_t* data, size_t length) {
+    if (uartNum < 0 || uartNum >= HOST_UART_COUNT) return;
+    std::lock_guard<std::mutex> lock(s_uartMutex);
+    s_uartRx[uartNum].insert(s_uartRx[uartNum].end(), data, data + length);
+}
+
+void hostSerialInject(int uartNum, const char* text) {
+    hostSerialInject(uartNum, (const uint8_t*)text, strlen(text));
+}
+
+void hostSerialClear(int uartNum) {
+    if (uartNum < 0 || uartNum >= HOST_UART_COUNT) return;
+    std::lock_guard<std::mutex> lock(s_uartMutex);
+    s_uartRx[uartNum].clear();
+}
+
+void HardwareSerial::begin(unsigned long baud, uint32_t config, int8_t rxPin, int8_t txPin) {
+    (void)baud; (void)config; (void)rxPin; (void)txPin;
+}
+
+void HardwareSerial::end() {
+}
+
+int HardwareSerial::available() {
+    std::lock_guard<std::mutex> lock(s_uartMutex);
+    return (int)s_uartRx[uartNum].size();
+}
+
+int HardwareSerial::read() {
+    std::lock_guard<std::mutex> lock(s_uartMutex);
+    if (s_uartRx[uartNum].empty()) return -1;
+    uint8_t c = s_uartRx[uartNum].front();
+    s_uartRx[uartNum].pop_front();
+    return c;
+}
+
+int HardwareSerial::peek() {
+    std::lock_guard<std::mutex> lock(s_uartMutex);
+    if (s_uartRx[uartNum].empty()) return -1;
+    return s_uartRx[uartNum].front();
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    // Only the console UART is visible on the host; sensor UARTs swallow
+    // configuration commands.
+    if (uartNum != 0) return size;
+    return fwrite(buffer, 1, size, stdout);
+}
+
+void HardwareSerial::flush() {
+    if (uartNum == 0) fflush(stdout);
+}
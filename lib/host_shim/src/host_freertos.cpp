@@ -0,0 +1,378 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// =============================================================================
+// TIME BASE
+// =============================================================================
+
+static const std::chrono::steady_clock::time_point s_bootTime = std::chrono::steady_clock::now();
+
+static std::chrono::steady_clock::time_point deadlineFor(TickType_t ticks) {
+    return std::chrono::steady_clock::now() + std::chrono::milliseconds(ticks);
+}
+
+TickType_t xTaskGetTickCount() {
+    auto elapsed = std::chrono::steady_clock::now() - s_bootTime;
+    return (TickType_t)std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+}
+
+TickType_t xTaskGetTickCountFromISR() {
+    return xTaskGetTickCount();
+}
+
+// =============================================================================
+// CRITICAL SECTIONS
+// =============================================================================
+
+static std::recursive_mutex s_criticalMutex;
+
+void hostEnterCritical(portMUX_TYPE* mux) {
+    (void)mux;
+    s_criticalMutex.lock();
+}
+
+void hostExitCritical(portMUX_TYPE* mux) {
+    (void)mux;
+    s_criticalMutex.unlock();
+}
+
+BaseType_t xPortGetCoreID() {
+    return 0;
+}
+
+// =============================================================================
+// TASKS
+// =============================================================================
+
+struct HostTask {
+    std::string name;
+    TaskFunction_t fn = nullptr;
+    void* params = nullptr;
+    UBaseType_t priority = 0;
+
+    std::mutex notifyMutex;
+    std::condition_variable notifyCond;
+    uint32_t notifyValue = 0;
+};
+
+static thread_local HostTask* t_currentTask = nullptr;
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    if (!t_currentTask) {
+        // Threads not created through the shim (e.g. main) get a lazily
+        // allocated control block so they can receive notifications.
+        t_currentTask = new HostTask();
+        t_currentTask->name = "main";
+    }
+    return t_currentTask;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                                   void* params, UBaseType_t priority,
+                                   TaskHandle_t* handle, BaseType_t coreId) {
+    (void)stackDepth;
+    (void)coreId;
+
+    HostTask* task = new HostTask();
+    task->name = name ? name : "";
+    task->fn = fn;
+    task->params = params;
+    task->priority = priority;
+    if (handle) *handle = task;
+
+    std::thread([task]() {
+        t_currentTask = task;
+        task->fn(task->params);
+    }).detach();
+
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                       void* params, UBaseType_t priority, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(fn, name, stackDepth, params, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    // Threads cannot be killed from outside; a task deleting itself simply
+    // parks forever. The control block is leaked deliberately because other
+    // tasks may still hold its handle.
+    if (task == nullptr || task == t_currentTask) {
+        while (true) {
+            std::this_thread::sleep_for(std::chrono::hours(1));
+        }
+    }
+}
+
+void vTaskDelay(TickType_t ticks) {
+    if (ticks == 0) {
+        std::this_thread::yield();
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+BaseType_t xTaskDelayUntil(TickType_t* previousWakeTime, TickType_t increment) {
+    TickType_t wakeTime = *previousWakeTime + increment;
+    TickType_t now = xTaskGetTickCount();
+    *previousWakeTime = wakeTime;
+    if ((int32_t)(wakeTime - now) > 0) {
+        vTaskDelay(wakeTime - now);
+        return pdTRUE;
+    }
+    return pdFALSE;
+}
+
+void vTaskDelayUntil(TickType_t* previousWakeTime, TickType_t increment) {
+    xTaskDelayUntil(previousWakeTime, increment);
+}
+
+const char* pcTaskGetName(TaskHandle_t task) {
+    if (!task) task = xTaskGetCurrentTaskHandle();
+    return task->name.c_str();
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    (void)task;
+    return 0;
+}
+
+void taskYIELD() {
+    std::this_thread::yield();
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    if (!task) return pdFAIL;
+    {
+        std::lock_guard<std::mutex> lock(task->notifyMutex);
+        task->notifyValue++;
+    }
+    task->notifyCond.notify_one();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken) {
+    xTaskNotifyGive(task);
+    if (higherPriorityTaskWoken) *higherPriorityTaskWoken = pdTRUE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+    HostTask* task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(task->notifyMutex);
+
+    auto ready = [task]() { return task->notifyValue > 0; };
+    if (ticksToWait == portMAX_DELAY) {
+        task->notifyCond.wait(lock, ready);
+    } else if (ticksToWait > 0) {
+        task->notifyCond.wait_until(lock, deadlineFor(ticksToWait), ready);
+    }
+
+    uint32_t value = task->notifyValue;
+    if (value > 0) {
+        task->notifyValue = clearCountOnExit ? 0 : value - 1;
+    }
+    return value;
+}
+
+// =============================================================================
+// QUEUES AND SEMAPHORES
+// =============================================================================
+
+struct HostQueue {
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::deque<std::vector<uint8_t>> items;
+    UBaseType_t length = 0;
+    UBaseType_t itemSize = 0;
+};
+
+static bool waitOn(std::condition_variable& cond, std::unique_lock<std::mutex>& lock,
+                   TickType_t ticksToWait, const std::function<bool()>& ready) {
+    if (ready()) return true;
+    if (ticksToWait == 0) return false;
+    if (ticksToWait == portMAX_DELAY) {
+        cond.wait(lock, ready);
+        return true;
+    }
+    return cond.wait_until(lock, deadlineFor(ticksToWait), ready);
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    if (length == 0) return nullptr;
+    HostQueue* queue = new HostQueue();
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
+
+static BaseType_t queueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait, bool front) {
+    if (!queue) return errQUEUE_FULL;
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!waitOn(queue->notFull, lock, ticksToWait,
+                [queue]() { return queue->items.size() < queue->length; })) {
+        return errQUEUE_FULL;
+    }
+
+    std::vector<uint8_t> data(queue->itemSize);
+    if (queue->itemSize > 0 && item) {
+        memcpy(data.data(), item, queue->itemSize);
+    }
+    if (front) {
+        queue->items.push_front(std::move(data));
+    } else {
+        queue->items.push_back(std::move(data));
+    }
+    lock.unlock();
+    queue->notEmpty.notify_one();
+    return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    return queueSend(queue, item, ticksToWait, false);
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    return queueSend(queue, item, ticksToWait, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    return queueSend(queue, item, ticksToWait, true);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higherPriorityTaskWoken) {
+    if (higherPriorityTaskWoken) *higherPriorityTaskWoken = pdFALSE;
+    return queueSend(queue, item, 0, false);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item) {
+    if (!queue) return pdFAIL;
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->items.clear();
+    }
+    return queueSend(queue, item, 0, false);
+}
+
+static BaseType_t queueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait, bool remove) {
+    if (!queue) return errQUEUE_EMPTY;
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!waitOn(queue->notEmpty, lock, ticksToWait,
+                [queue]() { return !queue->items.empty(); })) {
+        return errQUEUE_EMPTY;
+    }
+
+    if (queue->itemSize > 0 && item) {
+        memcpy(item, queue->items.front().data(), queue->itemSize);
+    }
+    if (remove) {
+        queue->items.pop_front();
+        lock.unlock();
+        queue->notFull.notify_one();
+    }
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+    return queueReceive(queue, item, ticksToWait, true);
+}
+
+BaseType_t xQueueReceiveFromISR(QueueHandle_t queue, void* item, BaseType_t* higherPriorityTaskWoken) {
+    if (higherPriorityTaskWoken) *higherPriorityTaskWoken = pdFALSE;
+    return queueReceive(queue, item, 0, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+    return queueReceive(queue, item, ticksToWait, false);
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    if (!queue) return pdFAIL;
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->items.clear();
+    }
+    queue->notFull.notify_all();
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    if (!queue) return 0;
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return (UBaseType_t)queue->items.size();
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+    if (!queue) return 0;
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return queue->length - (UBaseType_t)queue->items.size();
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount) {
+    SemaphoreHandle_t sem = xQueueCreate(maxCount, 0);
+    for (UBaseType_t i = 0; i < initialCount; i++) {
+        xQueueSend(sem, nullptr, 0);
+    }
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return xSemaphoreCreateCounting(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return xSemaphoreCreateCounting(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+    // Recursion depth is not tracked; callers in this project never re-enter
+    return xSemaphoreCreateMutex();
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticksToWait) {
+    return xQueueReceive(sem, nullptr, ticksToWait);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    return xQueueSend(sem, nullptr, 0);
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticksToWait) {
+    return xSemaphoreTake(sem, ticksToWait);
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem) {
+    return xSemaphoreGive(sem);
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t* higherPriorityTaskWoken) {
+    return xQueueSendFromISR(sem, nullptr, higherPriorityTaskWoken);
+}
+
+BaseType_t xSemaphoreTakeFromISR(SemaphoreHandle_t sem, BaseType_t* higherPriorityTaskWoken) {
+    return xQueueReceiveFromISR(sem, nullptr, higherPriorityTaskWoken);
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t sem) {
+    return uxQueueMessagesWaiting(sem);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+    vQueueDelete(sem);
+}
@@ -0,0 +1,283 @@
+#include "SD.h"
+#include "SPIFFS.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <dirent.h>
+#include <unistd.h>
+
+fs::SDFS SD;
+fs::SPIFFSFS SPIFFS;
+SPIClass SPI;
+
+namespace fs {
+    
+// Set by SD.setWriteDelay()
+static uint32_t writeDelayUs = 0;
+    
+class FileImpl {
+public:
+    FILE* fp = nullptr;
+    std::string hostPath;
+    std::string path;
+    std::string name;
+    DIR* dir = nullptr;
+        
+    ~FileImpl() {
+        if (fp) fclose(fp);
+        if (dir) closedir(dir);
+    }
+};
+    
+// =============================================================================
+// FILE
+// =============================================================================
+    
+size_t File::write(uint8_t c) {
+    return write(&c, 1);
+}
+    
+size_t File::write(const uint8_t* buffer, size_t size) {
+    if (!impl || !impl->fp) return 0;
+    if (writeDelayUs > 0) usleep(writeDelayUs);
+    return fwrite(buffer, 1, size, impl->fp);
+}
+    
+void File::flush() {
+    if (impl && impl->fp) fflush(impl->fp);
+}
+    
+int File::available() {
+    if (!impl || !impl->fp) return 0;
+    return (int)(size() - position());
+}
+    
+int File::read() {
+    if (!impl || !impl->fp) return -1;
+    int c = fgetc(impl->fp);
+    return c == EOF ? -1 : c;
+}
+    
+int File::peek() {
+    if (!impl || !impl->fp) return -1;
+    int c = fgetc(impl->fp);
+    if (c == EOF) return -1;
+    ungetc(c, impl->fp);
+    return c;
+}
+    
+size_t File::read(uint8_t* buffer, size_t size) {
+    if (!impl || !impl->fp) return 0;
+    return fread(buffer, 1, size, impl->fp);
+}
+    
+bool File::seek(uint32_t pos, SeekMode mode) {
+    if (!impl || !impl->fp) return false;
+    int whence = mode == SeekCur ? SEEK_CUR : (mode == SeekEnd ? SEEK_END : SEEK_SET);
+    return fseek(impl->fp, (long)pos, whence) == 0;
+}
+    
+size_t File::position() const {
+    if (!impl || !impl->fp) return 0;
+    long pos = ftell(impl->fp);
+    return pos < 0 ? 0 : (size_t)pos;
+}
+    
+size_t File::size() const {
+    if (!impl) return 0;
+    if (impl->fp) fflush(impl->fp);
+    struct stat st;
+    if (stat(impl->hostPath.c_str(), &st) != 0) return 0;
+    return (size_t)st.st_size;
+}
+    
+void File::close() {
+    impl.reset();
+}
+    
+const char* File::name() const {
+    return impl ? impl->name.c_str() : "";
+}
+    
+const char* File::path() const {
+    return impl ? impl->path.c_str() : "";
+}
+    
+bool File::isDirectory() const {
+    return impl && impl->dir;
+}
+    
+File File::openNextFile(const char* mode) {
+    if (!impl || !impl->dir) return File();
+    struct dirent* entry;
+    while ((entry = readdir(impl->dir)) != nullptr) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        std::string childPath = impl->path;
+        if (childPath.empty() || childPath.back() != '/') childPath += "/";
+        childPath += entry->d_name;
+            
+        std::shared_ptr<FileImpl> child = std::make_shared<FileImpl>();
+        child->path = childPath;
+        child->name = entry->d_name;
+        child->hostPath = impl->hostPath + "/" + entry->d_name;
+        struct stat st;
+        if (stat(child->hostPath.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+            child->dir = opendir(child->hostPath.c_str());
+        } else {
+            child->fp = fopen(child->hostPath.c_str(), strcmp(mode, FILE_READ) == 0 ? "rb" : mode);
+        }
+        return File(child);
+    }
+    return File();
+}
+    
+File::operator bool() const {
+    return impl && (impl->fp || impl->dir);
+}
+    
+// =============================================================================
+// FS
+// =============================================================================
+    
+std::string FS::hostPath(const char* path) const {
+    std::string full = root;
+    if (path[0] != '/') full += "/";
+    full += path;
+    return full;
+}
+    
+File FS::open(const char* path, const char* mode, bool create) {
+    (void)create;
+    if (!mounted) return File();
+        
+    std::shared_ptr<FileImpl> impl = std::make_shared<FileImpl>();
+    impl->path = path;
+    const char* slash = strrchr(path, '/');
+    impl->name = slash ? slash + 1 : path;
+    impl->hostPath = hostPath(path);
+        
+    struct stat st;
+    if (stat(impl->hostPath.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        impl->dir = opendir(impl->hostPath.c_str());
+        return File(impl);
+    }
+        
+    // Binary mode everywhere; "r+" style modes are passed through
+    std::string hostMode = mode;
+    if (hostMode.find('b') == std::string::npos) hostMode += "b";
+    impl->fp = fopen(impl->hostPath.c_str(), hostMode.c_str());
+    if (!impl->fp) return File();
+    return File(impl);
+}
+    
+bool FS::exists(const char* path) {
+    if (!mounted) return false;
+    struct stat st;
+    return stat(hostPath(path).c_str(), &st) == 0;
+}
+    
+bool FS::remove(const char* path) {
+    if (!mounted) return false;
+    return ::remove(hostPath(path).c_str()) == 0;
+}
+    
+bool FS::rename(const char* pathFrom, const char* pathTo) {
+    if (!mounted) return false;
+    return ::rename(hostPath(pathFrom).c_str(), hostPath(pathTo).c_str()) == 0;
+}
+    
+bool FS::mkdir(const char* path) {
+    if (!mounted) return false;
+    return ::mkdir(hostPath(path).c_str(), 0755) == 0 || errno == EEXIST;
+}
+    
+bool FS::rmdir(const char* path) {
+    if (!mounted) return false;
+    return ::rmdir(hostPath(path).c_str()) == 0;
+}
+    
+// Create the backing directory (and parents) on first use
+static bool mountDirectory(const std::string& root) {
+    std::string partial;
+    for (const char* p = root.c_str(); *p; p++) {
+        partial += *p;
+        if (*p == '/' && partial.size() > 1) ::mkdir(partial.c_str(), 0755);
+    }
+    ::mkdir(root.c_str(), 0755);
+        
+    struct stat st;
+    return stat(root.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+    
+// =============================================================================
+// SD
+// =============================================================================
+    
+bool SDFS::begin(uint8_t ssPin, SPIClass& spi, uint32_t frequency,
+                 const char* mountpoint, uint8_t maxFiles, bool formatIfEmpty) {
+    (void)ssPin; (void)spi; (void)frequency; (void)maxFiles; (void)formatIfEmpty;
+    root = mountpoint;
+    mounted = mountDirectory(root);
+    return mounted;
+}
+    
+void SDFS::end() {
+    mounted = false;
+}
+    
+void SDFS::setWriteDelay(uint32_t us) {
+    writeDelayUs = us;
+}
+    
+sdcard_type_t SDFS::cardType() {
+    return mounted ? CARD_SDHC : CARD_NONE;
+}
+    
+uint64_t SDFS::cardSize() {
+    return totalBytes();
+}
+    
+uint64_t SDFS::totalBytes() {
+    if (mounted && simulatedSize > 0) return simulatedSize;
+    struct statvfs vfs;
+    if (!mounted || statvfs(root.c_str(), &vfs) != 0) return 0;
+    return (uint64_t)vfs.f_blocks * vfs.f_frsize;
+}
+    
+uint64_t SDFS::usedBytes() {
+    if (mounted && simulatedSize > 0) {
+        // Apparent sizes, so preallocated (sparse) files count in full
+        uint64_t used = 0;
+        DIR* dir = opendir(root.c_str());
+        if (!dir) return 0;
+        while (struct dirent* ent = readdir(dir)) {
+            struct stat st;
+            std::string path = root + "/" + ent->d_name;
+            if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) used += st.st_size;
+        }
+        closedir(dir);
+        return used;
+    }
+    struct statvfs vfs;
+    if (!mounted || statvfs(root.c_str(), &vfs) != 0) return 0;
+    return (uint64_t)(vfs.f_blocks - vfs.f_bfree) * vfs.f_frsize;
+}
+    
+// =============================================================================
+// SPIFFS
+// =============================================================================
+    
+bool SPIFFSFS::begin(bool formatOnFail) {
+    (void)formatOnFail;
+    mounted = mountDirectory(root);
+    return mounted;
+}
+    
+void SPIFFSFS::end() {
+    mounted = false;
+}
+    
+} // namespace fs
@@ -0,0 +1,18 @@
+#include "Arduino.h"
+
+// Host builds run setup() once and exit. Unit tests and benchmarks do all
+// of their work in setup(), matching how they run on the device. A build of
+// the whole firmware (HOST_RUN_LOOP) goes on calling loop() like the
+// Arduino core does, until the firmware exits.
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    setup();
+    fflush(stdout);
+#if defined(HOST_RUN_LOOP)
+    while (true) {
+        loop();
+    }
+#endif
+    return 0;
+}
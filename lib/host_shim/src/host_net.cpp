@@ -0,0 +1,5 @@
+#include "WiFi.h"
+#include "ESPmDNS.h"
+
+WiFiClass WiFi;
+MDNSResponder MDNS;
@@ -95,7 +95,8 @@ bool AlertManager::checkThreshold(float value, const ThresholdConfig& config,
     
     // Check critical first
     if (value >= config.critical) {
-        if (!state.active || state.consecutiveCount == 0) {
+        if (!state.pending) {
+            state.pending = true;
             state.triggerTime = now;
             state.maxValue = value;
         } else {
@@ -119,7 +120,8 @@ bool AlertManager::checkThreshold(float value, const ThresholdConfig& config,
     }
     // Then check warning
     else if (value >= config.warning) {
-        if (!state.active || state.consecutiveCount == 0) {
+        if (!state.pending) {
+            state.pending = true;
             state.triggerTime = now;
             state.maxValue = value;
         } else {
@@ -149,6 +151,7 @@ bool AlertManager::checkThreshold(float value, const ThresholdConfig& config,
         
         if (value < clearThreshold) {
             state.active = false;
+            state.pending = false;
             state.consecutiveCount = 0;
             state.maxValue = 0;
         }
@@ -158,7 +161,10 @@ bool AlertManager::checkThreshold(float value, const ThresholdConfig& config,
 }
 
 void AlertManager::process(const IMUData& imu, const GPSData& gps) {
-    uint32_t now = millis();
+    process(imu, gps, millis());
+}
+
+void AlertManager::process(const IMUData& imu, const GPSData& gps, uint32_t now) {
     AlertEvent event;
     
     // Calculate G-force from accelerometer
@@ -223,9 +229,10 @@ void AlertManager::process(const IMUData& imu, const GPSData& gps) {
 }
 
 void AlertManager::recordAlert(const AlertEvent& event) {
-    // Rate limiting - max 1 alert per type per second
-    uint32_t now = millis();
-    if (now - gForceState.lastAlertTime < 1000 && 
+    // Rate limiting - max 1 alert per type per second, in the time the
+    // samples were taken
+    uint32_t now = event.timestamp_ms;
+    if (gForceState.lastAlertTime != 0 && now - gForceState.lastAlertTime < 1000 && 
         (event.type == AlertType::GFORCE_WARNING || event.type == AlertType::GFORCE_CRITICAL)) {
         return;
     }
@@ -47,6 +47,7 @@ private:
     // State tracking for hysteresis
     struct AlertState {
         bool active;
+        bool pending;             // Over a threshold since triggerTime
         uint32_t triggerTime;
         uint32_t lastAlertTime;
         uint8_t consecutiveCount;
@@ -100,9 +101,12 @@ public:
     // Register callback for immediate alert notification
     void setCallback(AlertCallback cb);
     
-    // Main monitoring function - call from compute task
+    // Main monitoring function - call with each new sample
     void process(const IMUData& imu, const GPSData& gps);
     
+    // Same, with an explicit sample time for consumers that process in batches
+    void process(const IMUData& imu, const GPSData& gps, uint32_t now);
+    
     // Queue access (for task communication)
     bool getAlert(AlertEvent& event, TickType_t timeout = 0);
     
@@ -0,0 +1,125 @@
+/**
+ * Task Timing Statistics
+ *
+ * Per-task record of how long each pass runs and, for periodic tasks, how
+ * far each pass starts from one period after the last (jitter), both as
+ * log-scale histograms. A pass misses its deadline when it finishes more
+ * than the deadline after it was due: one period after the previous pass
+ * for periodic tasks, its own start for event-driven ones.
+ *
+ * Only the owning task calls record() / idle(). snapshot() and reset() may
+ * run in any task; both are lock-free.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdint.h>
+#include "../utils/LatencyHistogram.h"
+
+/**
+ * @brief A task's timing since the last reset (all times in microseconds)
+ */
+struct TaskStatsSnapshot {
+    const char* name;
+    uint32_t periodUs;        // 0 for event-driven tasks
+    uint32_t deadlineUs;      // 0 for none
+    uint32_t iterations;
+    uint32_t deadlineMisses;
+    uint32_t lastRunTime;     // millis() at the end of the last pass
+    LatencySummary runTime;   // Start to end of each pass
+    LatencySummary jitter;    // |start - (previous start + period)|
+};
+
+class TaskStats {
+private:
+    const char* name;
+    std::atomic<uint32_t> periodUs;
+    const uint32_t deadlineUs;
+    
+    LatencyHistogram runTime;
+    LatencyHistogram jitter;
+    std::atomic<uint32_t> deadlineMisses{0};
+    std::atomic<uint32_t> lastRunTime{0};
+    
+    // Owning task only
+    uint32_t lastStartUs = 0;
+    bool chained = false;     // lastStartUs belongs to the previous pass
+    
+public:
+    TaskStats(const char* name, uint32_t periodUs, uint32_t deadlineUs)
+        : name(name), periodUs(periodUs), deadlineUs(deadlineUs) {}
+    
+    TaskStats(const TaskStats&) = delete;
+    TaskStats& operator=(const TaskStats&) = delete;
+    
+    /**
+     * @brief Change the period (e.g. to the sensor source's rate)
+     * @param us Time between passes, 0 for event-driven
+     */
+    void setPeriod(uint32_t us) {
+        periodUs.store(us, std::memory_order_relaxed);
+    }
+    
+    /**
+     * @brief Time one pass (owning task only)
+     * @param startUs micros() when the pass started
+     * @param endUs micros() when it ended
+     */
+    void record(uint32_t startUs, uint32_t endUs) {
+        const uint32_t duration = endUs - startUs;
+        const uint32_t period = periodUs.load(std::memory_order_relaxed);
+        const uint32_t deadline = deadlineUs;
+        
+        runTime.record(duration);
+        
+        // How late the pass started; early starts are jitter but not late
+        uint32_t lateUs = 0;
+        if (period > 0 && chained) {
+            const int32_t offset = (int32_t)(startUs - lastStartUs - period);
+            jitter.record(offset < 0 ? (uint32_t)-offset : (uint32_t)offset);
+            if (offset > 0) lateUs = offset;
+        }
+        lastStartUs = startUs;
+        chained = true;
+        
+        if (deadline > 0 && lateUs + duration > deadline) {
+            deadlineMisses.fetch_add(1, std::memory_order_relaxed);
+        }
+        lastRunTime.store(millis(), std::memory_order_relaxed);
+    }
+    
+    /**
+     * @brief The task had nothing to do; the next pass starts a new period
+     * rather than counting the gap as jitter (owning task only)
+     */
+    void idle() {
+        chained = false;
+    }
+    
+    /**
+     * @brief Copy of the current figures (any task)
+     */
+    TaskStatsSnapshot snapshot() const {
+        TaskStatsSnapshot s;
+        s.name = name;
+        s.periodUs = periodUs.load(std::memory_order_relaxed);
+        s.deadlineUs = deadlineUs;
+        s.runTime = runTime.summarize();
+        s.jitter = jitter.summarize();
+        s.iterations = s.runTime.count;
+        s.deadlineMisses = deadlineMisses.load(std::memory_order_relaxed);
+        s.lastRunTime = lastRunTime.load(std::memory_order_relaxed);
+        return s;
+    }
+    
+    /**
+     * @brief Start a new measurement window (any task)
+     */
+    void reset() {
+        runTime.reset();
+        jitter.reset();
+        deadlineMisses.store(0, std::memory_order_relaxed);
+    }
+};
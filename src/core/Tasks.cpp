@@ -8,146 +8,340 @@ TaskHandle_t hTelemetryTask = nullptr;
 TaskHandle_t hAlertTask = nullptr;
 TaskHandle_t hStatusTask = nullptr;
 
-// Task statistics
-TaskStats g_sensorStats = {0};
-TaskStats g_computeStats = {0};
-TaskStats g_loggingStats = {0};
+// Task statistics. Sensor and compute periods follow the IMU source once
+// the tasks start.
+TaskStats g_sensorStats("sensor", IMU_INTERVAL_MS * portTICK_PERIOD_MS * 1000, DEADLINE_SENSOR_US);
+TaskStats g_computeStats("compute", LOG_INTERVAL_MS * portTICK_PERIOD_MS * 1000, DEADLINE_COMPUTE_US);
+TaskStats g_loggingStats("logging", 0, DEADLINE_LOGGING_US);
+TaskStats g_telemetryStats("telemetry", TELEMETRY_INTERVAL_MS * portTICK_PERIOD_MS * 1000,
+                           DEADLINE_TELEMETRY_US);
+TaskStats g_alertStats("alerts", 0, DEADLINE_ALERT_US);
+
+static TaskStats* const TASK_STATS[] = {
+    &g_sensorStats, &g_computeStats, &g_loggingStats, &g_telemetryStats, &g_alertStats
+};
+static constexpr size_t TASK_STATS_COUNT = sizeof(TASK_STATS) / sizeof(TASK_STATS[0]);
+
+// Stage latency histograms
+LatencyHistogram g_stageLatency[LATENCY_STAGE_COUNT];
+const char* const LATENCY_STAGE_NAMES[LATENCY_STAGE_COUNT] = {
+    "enqueue", "compute", "log_write", "durable", "udp_send", "alert"
+};
 
 // Utility functions
-void updateTaskStats(TaskStats& stats, uint32_t duration) {
-    stats.iterations++;
-    stats.lastRunTime = millis();
+void printTaskStats() {
+    for (size_t i = 0; i < TASK_STATS_COUNT; i++) {
+        TaskStatsSnapshot s = TASK_STATS[i]->snapshot();
+        DEBUG_PRINTF(4, "Task %s: iter=%lu, run p50=%lu p99=%lu max=%lu us, misses=%lu (deadline %lu us)\n",
+                     s.name, (unsigned long)s.iterations, (unsigned long)s.runTime.p50,
+                     (unsigned long)s.runTime.p99, (unsigned long)s.runTime.max,
+                     (unsigned long)s.deadlineMisses, (unsigned long)s.deadlineUs);
+        if (s.periodUs > 0) {
+            DEBUG_PRINTF(4, "  jitter vs %lu us: p50=%lu, p99=%lu, p999=%lu, max=%lu us\n",
+                         (unsigned long)s.periodUs, (unsigned long)s.jitter.p50,
+                         (unsigned long)s.jitter.p99, (unsigned long)s.jitter.p999,
+                         (unsigned long)s.jitter.max);
+        }
+    }
+}
+
+void resetTaskStats() {
+    for (size_t i = 0; i < TASK_STATS_COUNT; i++) {
+        TASK_STATS[i]->reset();
+    }
+    for (size_t i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        g_stageLatency[i].reset();
+    }
+}
+
+void recordLatency(LatencyStage stage, uint32_t acquiredUs, uint32_t nowUs) {
+    g_stageLatency[static_cast<size_t>(stage)].record(nowUs - acquiredUs);
+}
+
+void printLatencyStats() {
+    for (size_t i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        LatencySummary s = g_stageLatency[i].summarize();
+        DEBUG_PRINTF(4, "Latency %s: n=%lu, p50=%lu, p99=%lu, p999=%lu, max=%lu us\n",
+                     LATENCY_STAGE_NAMES[i], (unsigned long)s.count, (unsigned long)s.p50,
+                     (unsigned long)s.p99, (unsigned long)s.p999, (unsigned long)s.max);
+    }
+}
+
+void printPacketRingStats(const PacketRing& ring, const PacketPool& pool) {
+    for (size_t i = 0; i < ring.getConsumerCount(); i++) {
+        BroadcastConsumerStats s = ring.getConsumerStats(i);
+        DEBUG_PRINTF(4, "Ring %s: read=%lu, lag=%lu, maxLag=%lu, overruns=%lu, skipped=%lu\n",
+                     s.name ? s.name : "?", s.consumed, s.lag, s.maxLag,
+                     s.overruns, s.skipped);
+    }
+    
+    BlockPoolStats p = pool.getStats();
+    DEBUG_PRINTF(4, "Packet pool: free=%lu/%lu, low=%lu, allocFail=%lu, stale=%lu\n",
+                 p.available, p.capacity, p.lowWater, p.allocFailures, p.staleRetains);
+}
+
+void printSourceReport(TaskParameters* params) {
+    params->imuSource->printStatus();
+    params->gpsSource->printStatus();
+    
+    // Rates over the time spent recording, which is when stand-ins run
+    SystemStateManager* state = params->state;
+    uint32_t recordingMs = state->getTotalTimeInState(SystemState::RECORDING);
+    if (state->isRecording()) {
+        recordingMs += state->getTimeInCurrentState();
+    }
+    LogStats log = params->logger->getStats();
+    const float seconds = max(recordingMs, (uint32_t)1) / 1000.0f;
+    const uint32_t packets = params->packetRing->getPublishedCount();
+    
+    DEBUG_PRINTF(3, "  Out: packets=%lu (%.0f/s), logged=%lu (%.0f/s), samples logged=%lu (%.0f/s)\n",
+                 packets, packets / seconds, log.packetsWritten,
+                 log.packetsWritten / seconds, log.samplesWritten, log.samplesWritten / seconds);
     
-    if (stats.minDuration == 0 || duration < stats.minDuration) {
-        stats.minDuration = duration;
+    // Time per pass of each pipeline stage (sensor, compute, logging);
+    // queueing shows up as ring lag below
+    for (size_t i = 0; i < 3; i++) {
+        TaskStatsSnapshot stage = TASK_STATS[i]->snapshot();
+        DEBUG_PRINTF(3, "  Stage %-8s us: p50=%lu p99=%lu max=%lu, jitter max=%lu, misses=%lu (%lu passes)\n",
+                     stage.name, (unsigned long)stage.runTime.p50, (unsigned long)stage.runTime.p99,
+                     (unsigned long)stage.runTime.max, (unsigned long)stage.jitter.max,
+                     (unsigned long)stage.deadlineMisses, (unsigned long)stage.iterations);
+    }
+    // Age of the data on reaching each stage
+    for (size_t i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        LatencySummary s = g_stageLatency[i].summarize();
+        DEBUG_PRINTF(3, "  Age %-9s us: p50=%lu p99=%lu p999=%lu max=%lu (%lu)\n",
+                     LATENCY_STAGE_NAMES[i], (unsigned long)s.p50, (unsigned long)s.p99,
+                     (unsigned long)s.p999, (unsigned long)s.max, (unsigned long)s.count);
     }
-    if (duration > stats.maxDuration) {
-        stats.maxDuration = duration;
+    for (size_t i = 0; i < params->packetRing->getConsumerCount(); i++) {
+        BroadcastConsumerStats s = params->packetRing->getConsumerStats(i);
+        DEBUG_PRINTF(3, "  Ring %-9s maxLag=%lu overruns=%lu skipped=%lu\n",
+                     s.name ? s.name : "?", s.maxLag, s.overruns, s.skipped);
     }
     
-    // Running average
-    stats.avgDuration = (stats.avgDuration * (stats.iterations - 1) + duration) / stats.iterations;
+    RingBufferStats imuStats = params->imuBuffer->getStats();
+    RingBufferStats gpsStats = params->gpsBuffer->getStats();
+    BlockPoolStats pool = params->packetPool->getStats();
+    DEBUG_PRINTF(3, "  Drops: IMU ring=%lu, GPS ring=%lu, pool=%lu, logger=%lu packets/%lu samples\n",
+                 imuStats.overwrites, gpsStats.overwrites, pool.allocFailures,
+                 log.drops, log.sampleDrops);
 }
 
-void printTaskStats(const char* name, const TaskStats& stats) {
-    DEBUG_PRINTF(4, "Task %s: iter=%lu, min=%lu, max=%lu, avg=%lu, misses=%lu\n",
-                 name, stats.iterations, stats.minDuration, 
-                 stats.maxDuration, stats.avgDuration, stats.deadlineMisses);
+// Claim a packet ring cursor for the calling task; tasks without one cannot run
+static int registerPacketConsumer(PacketRing* ring, const char* name) {
+    int id = ring->registerConsumer(name);
+    if (id < 0) {
+        DEBUG_PRINTF(1, "No packet ring cursor left for %s task\n", name);
+        vTaskDelete(nullptr);
+    }
+    return id;
+}
+
+// Take the next batch of packets for one consumer, holding a reference to
+// each. Handles recycled since they were read from the ring are dropped.
+static size_t pollPackets(PacketRing* ring, PacketPool* pool, int id,
+                          PacketHandle* handles, size_t maxHandles) {
+    size_t count;
+    while ((count = ring->pollN(id, handles, maxHandles)) > 0) {
+        size_t kept = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (pool->tryRetain(handles[i])) {
+                handles[kept++] = handles[i];
+            }
+        }
+        if (kept > 0) return kept;
+    }
+    return 0;
+}
+
+static void releasePackets(PacketPool* pool, const PacketHandle* handles, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        pool->release(handles[i]);
+    }
 }
 
 // =============================================================================
 // SENSOR TASK - Highest Priority
-// Runs on Core 0, reads IMU at 100Hz and GPS at 10Hz
+// Runs on Core 0, reads IMU at 100Hz and GPS at 10Hz (or their stand-ins),
+// woken by the IMU's sample clock or else every tick
 // =============================================================================
 void sensorTask(void* pvParameters) {
     TaskParameters* params = (TaskParameters*)pvParameters;
-    IMU* imu = params->imu;
-    GPS* gps = params->gps;
-    RingBuffer<IMUData, IMU_BUFFER_SIZE>* imuBuffer = params->imuBuffer;
-    RingBuffer<GPSData, GPS_BUFFER_SIZE>* gpsBuffer = params->gpsBuffer;
+    IIMUSource* imuSource = params->imuSource;
+    IGPSSource* gpsSource = params->gpsSource;
+    SPSCRingBuffer<StampedIMU, IMU_BUFFER_SIZE>* imuBuffer = params->imuBuffer;
+    SPSCRingBuffer<StampedGPS, GPS_BUFFER_SIZE>* gpsBuffer = params->gpsBuffer;
     
-    IMUData imuData;
-    GPSData gpsData;
+    StampedIMU samples[16];
+    StampedGPS gpsData;
     
-    TickType_t lastIMUTime = xTaskGetTickCount();
-    TickType_t lastGPSTime = xTaskGetTickCount();
+    // Deadlines and jitter are against the source's sampling period
+    g_sensorStats.setPeriod(imuSource->getPeriodUs());
     
     DEBUG_PRINTLN(3, "Sensor task started on Core " + String(xPortGetCoreID()));
     
     while (true) {
         uint32_t startTime = micros();
         
-        // IMU sampling at 100Hz
-        if (xTaskGetTickCount() - lastIMUTime >= IMU_INTERVAL_MS) {
-            if (imu->read()) {
-                imu->fillData(imuData, millis());
-                if (!imuBuffer->push(imuData, 0)) {  // Non-blocking
-                    // Buffer full - sensor data dropped
-                    DEBUG_PRINTLN(4, "IMU buffer full!");
+        // Stand-ins for the sensors only run while recording
+        const bool recording = params->state->isRecording();
+        const bool pollIMU = imuSource->isLive() || recording;
+        const bool pollGPS = gpsSource->isLive() || recording;
+        
+        // Pushes never block; overflow is counted by the buffers. Unpaced
+        // sources only refill an empty ring, so nothing is lost at this end
+        // and the drops downstream show where the pipeline saturates.
+        size_t count = 0;
+        if (pollIMU) {
+            const size_t capacity = sizeof(samples) / sizeof(samples[0]);
+            size_t maxSamples = imuSource->isPaced() ? capacity
+                              : imuBuffer->isEmpty() ? min(imuSource->samplesPerPacket(), capacity) : 0;
+            count = imuSource->poll(samples, maxSamples);
+            for (size_t i = 0; i < count; i++) {
+                imuBuffer->push(samples[i]);
+            }
+            if (recording && count > 0) {
+                const uint32_t now = micros();
+                for (size_t i = 0; i < count; i++) {
+                    recordLatency(LatencyStage::ENQUEUE, samples[i].acquired_us, now);
                 }
             }
-            lastIMUTime = xTaskGetTickCount();
         }
         
-        // GPS update at 10Hz (process all available data)
-        gps->update();
-        
-        if (xTaskGetTickCount() - lastGPSTime >= GPS_INTERVAL_MS) {
-            gps->fillData(gpsData, millis());
-            if (!gpsBuffer->push(gpsData, 0)) {
-                DEBUG_PRINTLN(4, "GPS buffer full!");
+        if (pollGPS) {
+            while ((gpsSource->isPaced() || gpsBuffer->isEmpty()) && gpsSource->poll(gpsData)) {
+                gpsBuffer->push(gpsData);
+                if (recording) {
+                    recordLatency(LatencyStage::ENQUEUE, gpsData.acquired_us, micros());
+                }
+                if (!gpsSource->isPaced()) break;
             }
-            lastGPSTime = xTaskGetTickCount();
         }
         
-        // Stats
-        updateTaskStats(g_sensorStats, micros() - startTime);
+        // Stats, per pass that took IMU samples: the sampling loop, not
+        // the polling one
+        if (count > 0) {
+            g_sensorStats.record(startTime, micros());
+        } else if (!pollIMU) {
+            g_sensorStats.idle();
+        }
         
-        // Yield to let other tasks run (but keep high priority)
-        vTaskDelay(pdMS_TO_TICKS(1));
+        // Yield to let other tasks run (but keep high priority). Unpaced
+        // sources only yield, to refill as soon as the rings drain; clocked
+        // ones sleep until their next tick (GPS is polled on the same beat).
+        if (pollIMU && !imuSource->isPaced() && !imuSource->isFinished()) {
+            taskYIELD();
+        } else if (pollIMU && imuSource->isClocked()) {
+            imuSource->waitForSample(pdMS_TO_TICKS(100));
+        } else {
+            vTaskDelay(pdMS_TO_TICKS(1));
+        }
     }
 }
 
 // =============================================================================
 // COMPUTE TASK - Data Processing
-// Runs on Core 0, processes sensor fusion and alert detection
+// Runs on Core 0, merges sensor data into packets for the packet ring
 // =============================================================================
 void computeTask(void* pvParameters) {
     TaskParameters* params = (TaskParameters*)pvParameters;
-    AlertManager* alerts = params->alertManager;
-    RingBuffer<IMUData, IMU_BUFFER_SIZE>* imuBuffer = params->imuBuffer;
-    RingBuffer<GPSData, GPS_BUFFER_SIZE>* gpsBuffer = params->gpsBuffer;
-    RingBuffer<TelemetryPacket, LOG_BUFFER_SIZE>* logBuffer = params->logBuffer;
-    SystemStateManager* state = params->state;
+    SPSCRingBuffer<StampedIMU, IMU_BUFFER_SIZE>* imuBuffer = params->imuBuffer;
+    SPSCRingBuffer<StampedGPS, GPS_BUFFER_SIZE>* gpsBuffer = params->gpsBuffer;
+    PacketRing* packetRing = params->packetRing;
+    PacketPool* packetPool = params->packetPool;
     
-    IMUData imuData;
-    GPSData gpsData;
-    TelemetryPacket packet;
-    
-    IMUData latestIMU = {0};
-    GPSData latestGPS = {0};
+    // Local copies for packet building; the shared registers are write-only here
+    StampedIMU latestIMU = {};
+    StampedGPS latestGPS = {};
+    bool haveIMU = false;
     
     uint16_t sequence = 0;
     
+    // One pass per packet's worth of samples, at the source's rate
+    const size_t samplesPerPacket = params->imuSource->samplesPerPacket();
+    g_computeStats.setPeriod(params->imuSource->getPeriodUs() * samplesPerPacket);
+    
     DEBUG_PRINTLN(3, "Compute task started on Core " + String(xPortGetCoreID()));
     
     while (true) {
         uint32_t startTime = micros();
         
-        // Process all available IMU data
-        while (imuBuffer->pop(imuData, 0)) {
-            latestIMU = imuData;
+        // Process all available IMU data in one pass over the ring storage.
+        // Packets only carry the latest sample; every sample goes to the
+        // raw IMU log stream while recording.
+        const bool recording = params->state->isRecording();
+        const bool logSamples = LOG_RAW_IMU && recording;
+        RingSpanPair<const StampedIMU> imuSpans = imuBuffer->peekContiguous();
+        const bool freshIMU = imuSpans.total() > 0;
+        if (freshIMU) {
+            haveIMU = true;
+            const RingSpan<const StampedIMU>& last = imuSpans.second.count > 0 ? imuSpans.second : imuSpans.first;
+            latestIMU = last.data[last.count - 1];
+            if (logSamples) {
+                params->logger->write(imuSpans.first.data, imuSpans.first.count);
+                params->logger->write(imuSpans.second.data, imuSpans.second.count);
+            }
+            if (!imuBuffer->consume(imuSpans.total())) {
+                // Producer lapped us mid-read; the newer items are still queued
+                while (imuBuffer->pop(latestIMU)) {
+                    if (logSamples) params->logger->write(&latestIMU, 1);
+                }
+            }
+            params->latestIMU->write(latestIMU.data);
         }
         
         // Process all available GPS data
-        while (gpsBuffer->pop(gpsData, 0)) {
-            latestGPS = gpsData;
+        RingSpanPair<const StampedGPS> gpsSpans = gpsBuffer->peekContiguous();
+        if (gpsSpans.total() > 0) {
+            const RingSpan<const StampedGPS>& last = gpsSpans.second.count > 0 ? gpsSpans.second : gpsSpans.first;
+            latestGPS = last.data[last.count - 1];
+            if (!gpsBuffer->consume(gpsSpans.total())) {
+                while (gpsBuffer->pop(latestGPS)) {}
+            }
+            params->latestGPS->write(latestGPS.data);
         }
         
-        // Run alert detection
-        alerts->process(latestIMU, latestGPS);
-        
-        // Build telemetry packet if system is recording
-        if (state->isRecording()) {
+        // Build the telemetry packet in place and publish its handle once to
+        // every consumer. Consumers decide for themselves whether recording
+        // is active. An empty pool means consumers are hoarding packets;
+        // the miss is counted by the pool.
+        PacketHandle handle = packetPool->allocate();
+        if (handle != PacketPool::INVALID_HANDLE) {
+            StampedPacket& slot = packetPool->get(handle);
+            TelemetryPacket& packet = slot.data;
             packet.magic = PACKET_MAGIC;
             packet.version = PACKET_VERSION;
             packet.sequence = sequence++;
             packet.timestamp_ms = millis();
-            packet.imu = latestIMU;
-            packet.gps = latestGPS;
-            packet.crc16 = 0;  // TODO: Calculate CRC
+            packet.imu = latestIMU.data;
+            packet.gps = latestGPS.data;
+            packet.crc16 = calculatePacketCRC(packet);
+            // Until there is a sample, the packet is as old as itself
+            slot.acquired_us = haveIMU ? latestIMU.acquired_us : startTime;
+            
+            // The ring now owns our reference; reclaim the one it displaced
+            PacketHandle evicted;
+            if (packetRing->publish(handle, evicted)) {
+                packetPool->release(evicted);
+            }
             
-            // Push to logging buffer
-            if (!logBuffer->push(packet, 0)) {
-                DEBUG_PRINTLN(4, "Log buffer full!");
+            // Packets repeating an old sample (IMU stalled) are not timed here
+            if (recording && freshIMU) {
+                recordLatency(LatencyStage::COMPUTE, slot.acquired_us, micros());
             }
         }
         
-        // Stats
-        updateTaskStats(g_computeStats, micros() - startTime);
+        // Stats; passes woken by the timeout (no samples) are not timed
+        if (freshIMU) {
+            g_computeStats.record(startTime, micros());
+        } else {
+            g_computeStats.idle();
+        }
         
-        // Run at 50Hz
-        vTaskDelay(LOG_INTERVAL_MS);
+        // Sleep until sensorTask has pushed enough samples for the next
+        // packet (50Hz). The timeout keeps packets flowing if the IMU stalls.
+        imuBuffer->waitForItems(samplesPerPacket, 2 * LOG_INTERVAL_MS);
     }
 }
 
@@ -158,35 +352,72 @@ void computeTask(void* pvParameters) {
 void loggingTask(void* pvParameters) {
     TaskParameters* params = (TaskParameters*)pvParameters;
     BinaryLogger* logger = params->logger;
-    RingBuffer<TelemetryPacket, LOG_BUFFER_SIZE>* logBuffer = params->logBuffer;
+    PacketRing* packetRing = params->packetRing;
+    PacketPool* packetPool = params->packetPool;
     SystemStateManager* state = params->state;
     
-    TelemetryPacket packet;
+    const int consumerId = registerPacketConsumer(packetRing, "logging");
+    PacketHandle batch[PACKET_READ_BATCH];
+    const TelemetryPacket* packets[PACKET_READ_BATCH];
+    
     TickType_t lastFlushTime = xTaskGetTickCount();
     int writeCount = 0;
     
+    // Durable latency: the oldest packet written since the last flush, and
+    // the oldest one behind the flush still in progress
+    uint32_t unflushedSinceUs = 0;
+    uint32_t flushTicket = 0;
+    uint32_t flushOldestUs = 0;
+    
     DEBUG_PRINTLN(3, "Logging task started on Core " + String(xPortGetCoreID()));
     
     while (true) {
         uint32_t startTime = micros();
         
-        // Process all available packets
+        // Timed against when the writer finished, not when we noticed
+        uint32_t syncedUs;
+        if (flushTicket != 0 && logger->isFlushed(flushTicket, syncedUs)) {
+            recordLatency(LatencyStage::DURABLE, flushOldestUs, syncedUs);
+            flushTicket = 0;
+        }
+        
+        // Hand all available packets to the logger in batches
         bool hadData = false;
-        while (logBuffer->pop(packet, 0)) {
+        size_t count;
+        while ((count = pollPackets(packetRing, packetPool, consumerId, batch, PACKET_READ_BATCH)) > 0) {
             if (state->isRecording()) {
-                if (logger->write(packet)) {
+                for (size_t i = 0; i < count; i++) {
+                    packets[i] = &packetPool->get(batch[i]).data;
+                }
+                size_t written = logger->write(packets, count);
+                if (written > 0) {
+                    const uint32_t now = micros();
+                    for (size_t i = 0; i < written; i++) {
+                        recordLatency(LatencyStage::LOG_WRITE, packetPool->get(batch[i]).acquired_us, now);
+                    }
+                    if (writeCount == 0) {
+                        unflushedSinceUs = packetPool->get(batch[0]).acquired_us;
+                    }
                     hadData = true;
-                    writeCount++;
+                    writeCount += written;
                 }
             }
+            releasePackets(packetPool, batch, count);
         }
         
-        // Periodic flush (every 5 seconds or 100 writes)
-        if (writeCount >= FLUSH_INTERVAL_WRITES ||
-            xTaskGetTickCount() - lastFlushTime >= pdMS_TO_TICKS(FLUSH_INTERVAL_MS)) {
+        // Periodic flush (every 5 seconds). Full blocks reach the card on
+        // their own; each flush pads out a partial block, so keep them rare.
+        if (xTaskGetTickCount() - lastFlushTime >= pdMS_TO_TICKS(FLUSH_INTERVAL_MS)) {
             
             if (writeCount > 0) {
-                logger->flush();
+                // A later flush covers an unfinished earlier one
+                const uint32_t ticket = logger->flush();
+                if (ticket != 0) {
+                    if (flushTicket == 0) {
+                        flushOldestUs = unflushedSinceUs;
+                    }
+                    flushTicket = ticket;
+                }
                 writeCount = 0;
                 lastFlushTime = xTaskGetTickCount();
             }
@@ -194,11 +425,12 @@ void loggingTask(void* pvParameters) {
         
         // Stats
         if (hadData) {
-            updateTaskStats(g_loggingStats, micros() - startTime);
+            g_loggingStats.record(startTime, micros());
         }
         
-        // Lower priority task - run less frequently
-        vTaskDelay(pdMS_TO_TICKS(10));
+        // Sleep until a full batch is waiting; the timeout still lets the
+        // periodic flush run when packets stop
+        packetRing->waitForItems(consumerId, PACKET_READ_BATCH, pdMS_TO_TICKS(FLUSH_INTERVAL_MS));
     }
 }
 
@@ -209,32 +441,40 @@ void loggingTask(void* pvParameters) {
 void telemetryTask(void* pvParameters) {
     TaskParameters* params = (TaskParameters*)pvParameters;
     WiFiTelemetry* telemetry = params->telemetry;
-    // Note: params->logBuffer uses LOG_BUFFER_SIZE (128)
+    PacketRing* packetRing = params->packetRing;
+    PacketPool* packetPool = params->packetPool;
     SystemStateManager* state = params->state;
     
-    TelemetryPacket packet;
-    TelemetryPacket lastPacket = {0};
+    const int consumerId = registerPacketConsumer(packetRing, "telemetry");
+    PacketHandle lastPacket;
     
     DEBUG_PRINTLN(3, "Telemetry task started on Core " + String(xPortGetCoreID()));
     
     while (true) {
+        uint32_t startTime = micros();
+        
         // Process web clients
         telemetry->handleWebClient();
         
+        // For streaming we don't need every packet - just the latest one.
+        // Always advance the cursor so the backlog never counts as lag.
+        bool fresh = packetRing->latest(consumerId, lastPacket) &&
+                     packetPool->tryRetain(lastPacket);
+        
         // Stream data if connected and recording
-        if (telemetry->isConnected() && state->isRecording()) {
-            // Get latest packet (peek at buffer without removing)
-            // For streaming, we don't need every packet - just latest
-            
-            // Simple approach: sample directly at telemetry rate
-            lastPacket.magic = PACKET_MAGIC;
-            lastPacket.version = PACKET_VERSION;
-            lastPacket.timestamp_ms = millis();
-            // TODO: Fill with actual data from shared state
-            
-            telemetry->stream(lastPacket);
+        if (fresh) {
+            if (telemetry->isConnected() && state->isRecording()) {
+                const StampedPacket& slot = packetPool->get(lastPacket);
+                if (telemetry->stream(slot.data)) {
+                    recordLatency(LatencyStage::UDP_SEND, slot.acquired_us, micros());
+                }
+            }
+            packetPool->release(lastPacket);
         }
         
+        // Stats
+        g_telemetryStats.record(startTime, micros());
+        
         // Run at telemetry rate
         vTaskDelay(TELEMETRY_INTERVAL_MS);
     }
@@ -242,18 +482,40 @@ void telemetryTask(void* pvParameters) {
 
 // =============================================================================
 // ALERT TASK - Alert Handling
-// Processes alert queue and triggers notifications
+// Runs alert detection on the packet stream and handles the alert queue
 // =============================================================================
 void alertTask(void* pvParameters) {
     TaskParameters* params = (TaskParameters*)pvParameters;
     AlertManager* alerts = params->alertManager;
+    PacketRing* packetRing = params->packetRing;
+    PacketPool* packetPool = params->packetPool;
     SystemStateManager* state = params->state;
     
+    const int consumerId = registerPacketConsumer(packetRing, "alerts");
+    PacketHandle batch[PACKET_READ_BATCH];
     AlertEvent alert;
     
     DEBUG_PRINTLN(3, "Alert task started on Core " + String(xPortGetCoreID()));
     
     while (true) {
+        uint32_t startTime = micros();
+        
+        // Run alert detection on every published packet
+        bool hadData = false;
+        size_t count;
+        while ((count = pollPackets(packetRing, packetPool, consumerId, batch, PACKET_READ_BATCH)) > 0) {
+            const bool recording = state->isRecording();
+            for (size_t i = 0; i < count; i++) {
+                const StampedPacket& slot = packetPool->get(batch[i]);
+                alerts->process(slot.data.imu, slot.data.gps, slot.data.timestamp_ms);
+                if (recording) {
+                    recordLatency(LatencyStage::ALERT, slot.acquired_us, micros());
+                }
+            }
+            releasePackets(packetPool, batch, count);
+            hadData = true;
+        }
+        
         // Process alerts from queue
         while (alerts->getAlert(alert, 0)) {
             // Handle alert based on severity
@@ -263,12 +525,12 @@ void alertTask(void* pvParameters) {
                     DEBUG_PRINTF(1, "CRITICAL ALERT: %d, value=%.2f\n",
                                  static_cast<int>(alert.type), alert.value);
                     break;
-                    
+                
                 case AlertSeverity::WARNING:
                     DEBUG_PRINTF(2, "WARNING: %d, value=%.2f\n",
                                  static_cast<int>(alert.type), alert.value);
                     break;
-                    
+                
                 case AlertSeverity::INFO:
                 default:
                     DEBUG_PRINTF(4, "INFO: %d, value=%.2f\n",
@@ -277,7 +539,13 @@ void alertTask(void* pvParameters) {
             }
         }
         
-        vTaskDelay(pdMS_TO_TICKS(50));
+        // Stats
+        if (hadData) {
+            g_alertStats.record(startTime, micros());
+        }
+        
+        // Wake as soon as computeTask publishes the next packet
+        packetRing->waitForItems(consumerId, 1);
     }
 }
 
@@ -289,6 +557,7 @@ void statusTask(void* pvParameters) {
     TaskParameters* params = (TaskParameters*)pvParameters;
     SystemStateManager* state = params->state;
     BinaryLogger* logger = params->logger;
+    WiFiTelemetry* telemetry = params->telemetry;
     
     // LED patterns
     const int PATTERN_READY[] = {100, 900, -1};      // Slow blink
@@ -320,25 +589,25 @@ void statusTask(void* pvParameters) {
                 digitalWrite(LED_PIN_RED, HIGH);
                 digitalWrite(LED_PIN_GREEN, LOW);
                 break;
-                
+            
             case SystemState::READY:
                 pattern = PATTERN_READY;
                 digitalWrite(LED_PIN_RED, LOW);
                 digitalWrite(LED_PIN_GREEN, HIGH);
                 break;
-                
+            
             case SystemState::RECORDING:
                 pattern = PATTERN_RECORDING;
                 digitalWrite(LED_PIN_RED, LOW);
                 digitalWrite(LED_PIN_GREEN, HIGH);
                 break;
-                
+            
             case SystemState::ERROR:
                 pattern = PATTERN_ERROR;
                 digitalWrite(LED_PIN_RED, HIGH);
                 digitalWrite(LED_PIN_GREEN, LOW);
                 break;
-                
+            
             default:
                 break;
         }
@@ -357,13 +626,28 @@ void statusTask(void* pvParameters) {
             lastToggle = xTaskGetTickCount();
         }
         
+        // Publish sensor buffer health for the web status page
+        static TickType_t lastBufferStatsTime = 0;
+        if (xTaskGetTickCount() - lastBufferStatsTime >= pdMS_TO_TICKS(1000)) {
+            telemetry->updateBufferStats(params->imuBuffer->getStats(),
+                                         params->gpsBuffer->getStats());
+            lastBufferStatsTime = xTaskGetTickCount();
+        }
+        
         // Print stats every 10 seconds
         static TickType_t lastStatsTime = 0;
         if (xTaskGetTickCount() - lastStatsTime >= pdMS_TO_TICKS(10000)) {
             LogStats logStats = logger->getStats();
-            DEBUG_PRINTF(3, "Stats: LOG=%lu pkts, drops=%lu, SD=%luKB\n",
+            DEBUG_PRINTF(3, "Stats: LOG=%lu pkts, drops=%lu, SD=%luKB, free=%luMB\n",
                          logStats.packetsWritten, logStats.drops,
-                         logStats.bytesWritten / 1024);
+                         logStats.bytesWritten / 1024,
+                         (unsigned long)logger->getFreeSpaceMB());
+            
+            RingBufferStats imuStats = params->imuBuffer->getStats();
+            RingBufferStats gpsStats = params->gpsBuffer->getStats();
+            DEBUG_PRINTF(3, "Buffers: IMU overwrites=%lu hw=%lu/%lu, GPS overwrites=%lu hw=%lu/%lu\n",
+                         imuStats.overwrites, imuStats.highWater, imuStats.capacity,
+                         gpsStats.overwrites, gpsStats.highWater, gpsStats.capacity);
             
             lastStatsTime = xTaskGetTickCount();
         }
@@ -9,12 +9,18 @@
 
 #include "config.h"
 #include "SystemState.h"
+#include "TaskStats.h"
 #include "../sensors/imu.h"
 #include "../sensors/gps.h"
+#include "../sensors/source.h"
 #include "../alerts/AlertManager.h"
 #include "../storage/BinaryLogger.h"
 #include "../telemetry/WiFiTelemetry.h"
 #include "../utils/RingBuffer.h"
+#include "../utils/BroadcastRing.h"
+#include "../utils/SeqLock.h"
+#include "../utils/BlockPool.h"
+#include "../utils/LatencyHistogram.h"
 
 // Task function prototypes
 void sensorTask(void* pvParameters);
@@ -24,6 +30,15 @@ void telemetryTask(void* pvParameters);
 void alertTask(void* pvParameters);
 void statusTask(void* pvParameters);
 
+// Packets are built once in a pool slot and passed around by handle. Slots
+// carry the acquisition time of the packet's IMU sample.
+typedef BlockPool<StampedPacket, PACKET_POOL_SIZE> PacketPool;
+typedef PacketPool::Handle PacketHandle;
+
+// Packet stream: published once by computeTask, read by each consumer task.
+// Every ring entry holds one pool reference, dropped when it is overwritten.
+typedef BroadcastRing<PacketHandle, LOG_BUFFER_SIZE, PACKET_RING_CONSUMERS> PacketRing;
+
 // Task parameter structure
 typedef struct {
     IMU* imu;
@@ -34,9 +49,18 @@ typedef struct {
     SystemStateManager* state;
     
     // Data flow buffers
-    RingBuffer<IMUData, IMU_BUFFER_SIZE>* imuBuffer;
-    RingBuffer<GPSData, GPS_BUFFER_SIZE>* gpsBuffer;
-    RingBuffer<TelemetryPacket, LOG_BUFFER_SIZE>* logBuffer;
+    SPSCRingBuffer<StampedIMU, IMU_BUFFER_SIZE>* imuBuffer;
+    SPSCRingBuffer<StampedGPS, GPS_BUFFER_SIZE>* gpsBuffer;
+    PacketRing* packetRing;
+    PacketPool* packetPool;
+    
+    // Newest samples seen by computeTask, readable from any task
+    SeqLock<IMUData>* latestIMU;
+    SeqLock<GPSData>* latestGPS;
+    
+    // Where sensorTask reads from: the sensors, a replay or generators
+    IIMUSource* imuSource;
+    IGPSSource* gpsSource;
 } TaskParameters;
 
 // Task handles (for external control)
@@ -48,19 +72,33 @@ extern TaskHandle_t hAlertTask;
 extern TaskHandle_t hStatusTask;
 
 // Task statistics
-struct TaskStats {
-    uint32_t iterations;
-    uint32_t minDuration;
-    uint32_t maxDuration;
-    uint32_t avgDuration;
-    uint32_t lastRunTime;
-    uint32_t deadlineMisses;
-};
-
 extern TaskStats g_sensorStats;
 extern TaskStats g_computeStats;
 extern TaskStats g_loggingStats;
+extern TaskStats g_telemetryStats;
+extern TaskStats g_alertStats;
+
+// Pipeline stages at which the age of a record (time since its sensor
+// reading was acquired) is measured, while recording
+enum class LatencyStage : uint8_t {
+    ENQUEUE = 0,    // Sample pushed onto its sensor ring
+    COMPUTE,        // Packet published, by the age of its IMU sample
+    LOG_WRITE,      // Packet copied into the logger's buffers
+    DURABLE,        // Oldest packet of a flush, once the flush is done
+    UDP_SEND,       // Packet streamed to clients
+    ALERT,          // Packet checked for alerts
+    COUNT
+};
+
+constexpr size_t LATENCY_STAGE_COUNT = static_cast<size_t>(LatencyStage::COUNT);
+
+extern LatencyHistogram g_stageLatency[LATENCY_STAGE_COUNT];
+extern const char* const LATENCY_STAGE_NAMES[LATENCY_STAGE_COUNT];
 
 // Utility functions
-void updateTaskStats(TaskStats& stats, uint32_t duration);
-void printTaskStats(const char* name, const TaskStats& stats);
+void printTaskStats();
+void recordLatency(LatencyStage stage, uint32_t acquiredUs, uint32_t nowUs);
+void printLatencyStats();
+void resetTaskStats();  // Task timing and stage latency alike
+void printPacketRingStats(const PacketRing& ring, const PacketPool& pool);
+void printSourceReport(TaskParameters* params);
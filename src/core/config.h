@@ -29,11 +29,13 @@
 #define TASK_PRIORITY_ALERT     configMAX_PRIORITIES - 2  // High - safety critical
 #define TASK_PRIORITY_LOGGING   configMAX_PRIORITIES - 3  // Medium - data persistence
 #define TASK_PRIORITY_TELEMETRY configMAX_PRIORITIES - 4  // Low - network streaming
+#define TASK_PRIORITY_SD_WRITER configMAX_PRIORITIES - 4  // Low - drains log buffers to SD
 #define TASK_PRIORITY_STATUS    configMAX_PRIORITIES - 5  // Lowest - UI updates
 
 // Task stack sizes (words)
 #define STACK_SIZE_SENSOR     4096
-#define STACK_SIZE_LOGGING    8192
+#define STACK_SIZE_LOGGING    4096
+#define STACK_SIZE_SD_WRITER  8192  // FAT updates run here
 #define STACK_SIZE_TELEMETRY  4096
 #define STACK_SIZE_ALERT      4096
 #define STACK_SIZE_STATUS     2048
@@ -42,7 +44,8 @@
 // Task core assignments (ESP32 has Core 0 and Core 1)
 #define CORE_SENSOR    0  // Core 0: Real-time sensor reading
 #define CORE_COMPUTE   0  // Core 0: Data processing
-#define CORE_LOGGING   1  // Core 1: SD card (blocking I/O)
+#define CORE_LOGGING   1  // Core 1: Packet batching into log buffers
+#define CORE_SD_WRITER 1  // Core 1: SD card (blocking I/O)
 #define CORE_TELEMETRY 1  // Core 1: Network (blocking I/O)
 #define CORE_STATUS    1  // Core 1: LED/status
 
@@ -62,6 +65,35 @@ constexpr TickType_t GPS_INTERVAL_MS = pdMS_TO_TICKS(1000 / GPS_SAMPLE_RATE_HZ);
 constexpr TickType_t LOG_INTERVAL_MS = pdMS_TO_TICKS(1000 / LOG_RATE_HZ);
 constexpr TickType_t TELEMETRY_INTERVAL_MS = pdMS_TO_TICKS(1000 / TELEMETRY_RATE_HZ);
 
+// Exact IMU sampling period, for the hardware-clocked modes below
+constexpr uint32_t IMU_PERIOD_US = 1000000 / IMU_SAMPLE_RATE_HZ;
+
+// What paces IMU sampling (see sensors/SampleClock.h):
+//   SENSOR_CLOCK_TICK       - sensorTask checks every RTOS tick (1ms grain)
+//   SENSOR_CLOCK_TIMER      - an esp_timer at IMU_PERIOD_US wakes it per sample
+//   SENSOR_CLOCK_DATA_READY - the MPU6050's data-ready line (MPU6050_INT_PIN)
+// The hardware clocks stamp each sample at its tick, so spacing is uniform.
+#define SENSOR_CLOCK_TICK       0
+#define SENSOR_CLOCK_TIMER      1
+#define SENSOR_CLOCK_DATA_READY 2
+#ifndef SENSOR_CLOCK
+#define SENSOR_CLOCK SENSOR_CLOCK_TIMER
+#endif
+
+// IMU samples per packet at the MPU6050's rate. The compute task wakes
+// once a packet's worth is buffered, counted at the rate of the source in
+// use (IIMUSource::samplesPerPacket), so packets stay at LOG_RATE_HZ.
+constexpr size_t IMU_SAMPLES_PER_PACKET = IMU_SAMPLE_RATE_HZ / LOG_RATE_HZ;
+
+// Task deadlines (microseconds): how long after it was due a pass of a
+// periodic task may finish, or how long an event-driven pass may run.
+// Misses are counted per task (see core/TaskStats.h).
+constexpr uint32_t DEADLINE_SENSOR_US = 2000;      // Sample within two ticks of its slot
+constexpr uint32_t DEADLINE_COMPUTE_US = 5000;
+constexpr uint32_t DEADLINE_LOGGING_US = 10000;    // One batch into the log buffers
+constexpr uint32_t DEADLINE_TELEMETRY_US = 25000;  // Web clients are served in the same pass
+constexpr uint32_t DEADLINE_ALERT_US = 5000;
+
 // =============================================================================
 // BUFFER CONFIGURATION
 // =============================================================================
@@ -70,6 +102,10 @@ constexpr TickType_t TELEMETRY_INTERVAL_MS = pdMS_TO_TICKS(1000 / TELEMETRY_RATE
 constexpr size_t IMU_BUFFER_SIZE = 256;       // ~2.5 seconds at 100Hz
 constexpr size_t GPS_BUFFER_SIZE = 32;        // ~3 seconds at 10Hz
 constexpr size_t LOG_BUFFER_SIZE = 128;       // ~2.5 seconds at 50Hz
+constexpr size_t PACKET_RING_CONSUMERS = 3;   // Logging, telemetry, alerts
+constexpr size_t PACKET_READ_BATCH = 8;       // Packet handles taken per ring read
+// Packet slots: one per ring entry, plus each consumer's batch and the one being built
+constexpr size_t PACKET_POOL_SIZE = LOG_BUFFER_SIZE + PACKET_RING_CONSUMERS * PACKET_READ_BATCH + 1;
 constexpr size_t ALERT_QUEUE_SIZE = 16;       // Alert queue depth
 constexpr size_t TELEMETRY_BUFFER_SIZE = 64;  // Network queue
 
@@ -108,6 +144,7 @@ constexpr int SD_CS_PIN   = 5;
 // I2C (MPU6050)
 constexpr int I2C_SDA_PIN = 21;
 constexpr int I2C_SCL_PIN = 22;
+constexpr int MPU6050_INT_PIN = 34;     // Data ready (input only, no pull-up needed)
 
 // CAN Bus (optional - for OBD-II integration)
 constexpr int CAN_RX_PIN = 4;
@@ -133,14 +170,47 @@ constexpr float GYRO_SCALE = 131.0f;
 // Binary log format (more efficient than CSV)
 #define USE_BINARY_FORMAT true
 
+// SD card VFS mount point. Native builds override this with a host
+// directory that stands in for the card.
+#ifndef SD_MOUNT_POINT
+#define SD_MOUNT_POINT "/sd"
+#endif
+constexpr uint32_t SD_SPI_FREQUENCY = 4000000;
+
+// Log writes: whole sector-aligned blocks, so the card never does a
+// read-modify-write and FAT updates stay out of the write path
+constexpr size_t LOG_SECTOR_SIZE = 512;
+constexpr size_t LOG_BLOCK_SIZE = 16 * 1024;  // ~199 packets, ~4s at 50Hz
+constexpr uint32_t LOG_INDEX_INTERVAL_BLOCKS = 8;  // Time index entry every N blocks
+
 // Log rotation
 constexpr uint32_t MAX_LOG_SIZE_BYTES = 50 * 1024 * 1024;  // 50MB per file
-constexpr uint32_t MAX_LOG_FILES = 10;
+constexpr uint32_t MAX_LOG_FILES = 256;  // Catalog slots; free space usually runs out first
 constexpr char LOG_FILE_BASE[] = "/rally";
 constexpr char LOG_EXT[] = ".bin";
+constexpr char LOG_CATALOG_FILE[] = "/rally.cat";  // Index of all log slots
+
+// The next file is created and preallocated in the background once the
+// current one is this close to rotation, a step at a time
+constexpr uint32_t LOG_PREPARE_AHEAD_BYTES = 4 * 1024 * 1024;
+constexpr uint32_t LOG_PREALLOCATE_STEP_BYTES = 1024 * 1024;
+
+// Retention by free space: before a new file is created, the oldest logs
+// are deleted while it would leave less than the low watermark free, and
+// from then on up to the high watermark, a file per writer pass. If that
+// is still not enough room, the new file is made smaller, down to
+// LOG_MIN_FILE_BYTES; below that, logging stops.
+constexpr uint32_t LOG_FREE_LOW_WATERMARK_MB = 256;
+constexpr uint32_t LOG_FREE_HIGH_WATERMARK_MB = 1024;
+constexpr uint32_t LOG_MIN_FILE_BYTES = 8 * 1024 * 1024;
+
+// After a reset, keep appending to a log that was never closed
+#define LOG_RESUME_ON_BOOT true
+
+// Log every raw IMU sample as a second stream next to the fused packets
+#define LOG_RAW_IMU true
 
 // SD flush settings
-constexpr int FLUSH_INTERVAL_WRITES = 100;
 constexpr uint32_t FLUSH_INTERVAL_MS = 5000;
 
 // =============================================================================
@@ -179,6 +249,52 @@ constexpr char TELEMETRY_UDP_HOST[] = "192.168.4.255";  // Broadcast
 // Web server
 constexpr uint16_t WEB_SERVER_PORT = 80;
 
+// =============================================================================
+// REPLAY
+// =============================================================================
+
+// Play a recording through the pipeline instead of reading the sensors
+// (see sensors/replay.h). Build with e.g. -DREPLAY_FILE=\"/replay.bin\";
+// empty means live sensors.
+#ifndef REPLAY_FILE
+#define REPLAY_FILE ""
+#endif
+
+// Playback speed: 1 = real time, 10 = ten times faster, 0 = as fast as
+// the pipeline takes the samples
+#ifndef REPLAY_SPEED
+#define REPLAY_SPEED 1.0f
+#endif
+
+// =============================================================================
+// SYNTHETIC SENSORS
+// =============================================================================
+
+// Generators instead of the sensors, for load testing the pipeline (see
+// sensors/synthetic.h). Build with -DSYNTHETIC_SENSORS=1.
+#ifndef SYNTHETIC_SENSORS
+#define SYNTHETIC_SENSORS 0
+#endif
+
+#ifndef SYNTHETIC_IMU_RATE_HZ
+#define SYNTHETIC_IMU_RATE_HZ 1000
+#endif
+
+#ifndef SYNTHETIC_GPS_RATE_HZ
+#define SYNTHETIC_GPS_RATE_HZ 25
+#endif
+
+// IMU motion: 0 = still, 1 = vibration, 2 = impacts, 3 = both (a rough stage)
+#ifndef SYNTHETIC_IMU_PROFILE
+#define SYNTHETIC_IMU_PROFILE 3
+#endif
+
+// Length of a run in seconds, counted from the start of recording; the
+// firmware then reports and stops recording. 0 = endless.
+#ifndef SYNTHETIC_RUN_S
+#define SYNTHETIC_RUN_S 0
+#endif
+
 // =============================================================================
 // DATA STRUCTURES
 // =============================================================================
@@ -189,7 +305,7 @@ struct __attribute__((packed)) IMUData {
     float accel_x;            // 4 bytes (m/s^2)
     float accel_y;            // 4 bytes
     float accel_z;            // 4 bytes
-    float gyro_x;             // 4 bytes (deg/s)
+    float gyro_x;             // 4 bytes (rad/s)
     float gyro_y;             // 4 bytes
     float gyro_z;             // 4 bytes
     float temperature;        // 4 bytes (Celsius)
@@ -220,6 +336,19 @@ struct __attribute__((packed)) TelemetryPacket {
     uint16_t crc16;           // 2 bytes - checksum
 };
 
+// A record on its way through the tasks, stamped with micros() when its
+// sensor reading was taken. Only the record is logged or sent; the stamp
+// lets each stage measure how old the record is by the time it gets there.
+template<typename T>
+struct Stamped {
+    T data;
+    uint32_t acquired_us;
+};
+
+typedef Stamped<IMUData> StampedIMU;
+typedef Stamped<GPSData> StampedGPS;
+typedef Stamped<TelemetryPacket> StampedPacket;
+
 // Alert types
 enum class AlertType : uint8_t {
     NONE = 0,
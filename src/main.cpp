@@ -28,6 +28,9 @@
 #include "core/Tasks.h"
 #include "sensors/imu.h"
 #include "sensors/gps.h"
+#include "sensors/SampleClock.h"
+#include "sensors/replay.h"
+#include "sensors/synthetic.h"
 #include "alerts/AlertManager.h"
 #include "storage/BinaryLogger.h"
 #include "telemetry/WiFiTelemetry.h"
@@ -44,15 +47,33 @@ SystemStateManager g_systemState;
 IMU g_imu;
 GPS g_gps;
 
+// Where sensorTask reads from: the sensors, a recording played instead
+// (REPLAY_FILE) or generators (SYNTHETIC_SENSORS)
+LiveIMUSource g_liveIMU(g_imu);
+SampleClock g_imuClock;
+LiveGPSSource g_liveGPS(g_gps);
+SensorReplay g_replay;
+ReplayIMUSource g_replayIMU(g_replay, g_imu);
+ReplayGPSSource g_replayGPS(g_replay, g_gps);
+SyntheticIMU g_syntheticIMU(g_imu);
+SyntheticGPS g_syntheticGPS(g_gps);
+bool g_runReported = false;
+
 // Subsystems
 AlertManager g_alertManager;
 BinaryLogger g_logger;
 WiFiTelemetry g_telemetry;
 
 // Data flow ring buffers
-RingBuffer<IMUData, IMU_BUFFER_SIZE> g_imuBuffer;
-RingBuffer<GPSData, GPS_BUFFER_SIZE> g_gpsBuffer;
-RingBuffer<TelemetryPacket, LOG_BUFFER_SIZE> g_logBuffer;
+// Sensor rings keep the freshest samples; losses show up in getStats()
+SPSCRingBuffer<StampedIMU, IMU_BUFFER_SIZE> g_imuBuffer(OverflowPolicy::OVERWRITE_OLDEST);
+SPSCRingBuffer<StampedGPS, GPS_BUFFER_SIZE> g_gpsBuffer(OverflowPolicy::OVERWRITE_OLDEST);
+PacketRing g_packetRing;
+PacketPool g_packetPool;
+
+// Latest sensor snapshots (written by computeTask)
+SeqLock<IMUData> g_latestIMU;
+SeqLock<GPSData> g_latestGPS;
 
 // Task parameters
 TaskParameters g_taskParams;
@@ -75,29 +96,62 @@ void setup() {
     // Initialize system state
     g_systemState.begin();
     
-    // Initialize sensors
-    Serial.println("[1/6] Initializing IMU...");
-    if (!g_imu.begin()) {
-        Serial.println("ERROR: IMU initialization failed!");
-        g_systemState.postEvent(SystemEvent::ERROR_SENSOR);
-    } else {
-        Serial.println("  IMU OK");
-    }
-    
-    Serial.println("[2/6] Initializing GPS...");
-    if (!g_gps.begin()) {
-        Serial.println("ERROR: GPS initialization failed!");
-        g_systemState.postEvent(SystemEvent::ERROR_GPS);
-    } else {
-        Serial.println("  GPS OK");
-    }
-    
-    // Calibrate IMU
-    Serial.println("[3/6] Calibrating IMU (keep still)...");
-    if (g_imu.performCalibration(200)) {  // 200 samples
-        Serial.println("  Calibration OK");
+    // Initialize sensors (a replay or the generators stand in for them)
+    const bool replaying = strlen(REPLAY_FILE) > 0;
+    const bool synthetic = !replaying && SYNTHETIC_SENSORS;
+    g_taskParams.imuSource = &g_liveIMU;
+    g_taskParams.gpsSource = &g_liveGPS;
+    if (replaying) {
+        Serial.println("[1-3/6] Sensors replaced by a replay of " REPLAY_FILE);
+    } else if (synthetic) {
+        Serial.println("[1-3/6] Sensors replaced by generators");
+        SyntheticIMUConfig imuConfig =
+            SyntheticIMUConfig::forProfile(static_cast<SyntheticProfile>(SYNTHETIC_IMU_PROFILE));
+        SyntheticGPSConfig gpsConfig;
+        imuConfig.runMs = gpsConfig.runMs = SYNTHETIC_RUN_S * 1000UL;
+        g_syntheticIMU.configure(imuConfig);
+        g_syntheticGPS.configure(gpsConfig);
+        g_taskParams.imuSource = &g_syntheticIMU;
+        g_taskParams.gpsSource = &g_syntheticGPS;
     } else {
-        Serial.println("  Calibration failed, using defaults");
+        Serial.println("[1/6] Initializing IMU...");
+        if (!g_imu.begin()) {
+            Serial.println("ERROR: IMU initialization failed!");
+            g_systemState.postEvent(SystemEvent::ERROR_SENSOR);
+        } else {
+            Serial.println("  IMU OK");
+        }
+        
+        Serial.println("[2/6] Initializing GPS...");
+        if (!g_gps.begin()) {
+            Serial.println("ERROR: GPS initialization failed!");
+            g_systemState.postEvent(SystemEvent::ERROR_GPS);
+        } else {
+            Serial.println("  GPS OK");
+        }
+        
+        // Calibrate IMU
+        Serial.println("[3/6] Calibrating IMU (keep still)...");
+        if (g_imu.performCalibration(200)) {  // 200 samples
+            Serial.println("  Calibration OK");
+        } else {
+            Serial.println("  Calibration failed, using defaults");
+        }
+        
+        // Pace sampling from hardware rather than the RTOS tick
+#if SENSOR_CLOCK == SENSOR_CLOCK_TIMER
+        const bool clocked = g_imuClock.beginTimer(IMU_PERIOD_US);
+#elif SENSOR_CLOCK == SENSOR_CLOCK_DATA_READY
+        const bool clocked = g_imu.enableDataReady(IMU_PERIOD_US) &&
+                             g_imuClock.beginDataReady(MPU6050_INT_PIN, IMU_PERIOD_US);
+#else
+        const bool clocked = false;
+#endif
+        if (clocked) {
+            g_liveIMU.setClock(&g_imuClock);
+        } else {
+            Serial.println("  IMU sampled on the RTOS tick");
+        }
     }
     
     // Initialize storage
@@ -109,6 +163,16 @@ void setup() {
         Serial.println("  SD OK");
     }
     
+    if (replaying) {
+        if (g_replay.begin(REPLAY_FILE, REPLAY_SPEED)) {
+            g_taskParams.imuSource = &g_replayIMU;
+            g_taskParams.gpsSource = &g_replayGPS;
+        } else {
+            Serial.println("ERROR: Replay file could not be opened!");
+            g_systemState.postEvent(SystemEvent::ERROR_SENSOR);
+        }
+    }
+    
     // Initialize alert system
     Serial.println("[5/6] Initializing alert system...");
     g_alertManager.begin();
@@ -122,6 +186,8 @@ void setup() {
     // Initialize WiFi telemetry
     Serial.println("[6/6] Initializing WiFi...");
     g_telemetry.begin(WiFiMode::AP_MODE);
+    g_telemetry.setLogCatalog(&g_logger.getCatalog());
+    g_telemetry.setLatencyStages(g_stageLatency, LATENCY_STAGE_NAMES, LATENCY_STAGE_COUNT);
     Serial.println("  WiFi OK");
     
     // Setup task parameters
@@ -133,15 +199,20 @@ void setup() {
     g_taskParams.state = &g_systemState;
     g_taskParams.imuBuffer = &g_imuBuffer;
     g_taskParams.gpsBuffer = &g_gpsBuffer;
-    g_taskParams.logBuffer = &g_logBuffer;
+    g_taskParams.packetRing = &g_packetRing;
+    g_taskParams.packetPool = &g_packetPool;
+    g_taskParams.latestIMU = &g_latestIMU;
+    g_taskParams.latestGPS = &g_latestGPS;
     
     // Wait for GPS fix before starting
-    Serial.println("\nWaiting for GPS fix...");
-    if (g_gps.waitForFix(10000)) {  // 10 second timeout
-        Serial.println("GPS fix acquired!");
-        g_systemState.postEvent(SystemEvent::GPS_FIX);
-    } else {
-        Serial.println("GPS fix timeout - continuing without fix");
+    if (!replaying && !synthetic) {
+        Serial.println("\nWaiting for GPS fix...");
+        if (g_gps.waitForFix(10000)) {  // 10 second timeout
+            Serial.println("GPS fix acquired!");
+            g_systemState.postEvent(SystemEvent::GPS_FIX);
+        } else {
+            Serial.println("GPS fix timeout - continuing without fix");
+        }
     }
     
     // Create RTOS tasks
@@ -219,7 +290,8 @@ void setup() {
     );
     Serial.println("  Status task created");
     
-    // Transition to ready state
+    // Transition to ready state (READY is only reachable from CALIBRATING)
+    g_systemState.transitionTo(SystemState::CALIBRATING, SystemEvent::INIT_COMPLETE);
     g_systemState.transitionTo(SystemState::READY, SystemEvent::SENSOR_READY);
     
     // Auto-start recording
@@ -242,6 +314,7 @@ void setup() {
 // =============================================================================
 
 void handleSerialCommand(char cmd);
+void finishRun();
 
 // =============================================================================
 // MAIN LOOP (minimal - everything runs in tasks)
@@ -257,10 +330,45 @@ void loop() {
         handleSerialCommand(cmd);
     }
     
+    if (!g_runReported && g_taskParams.imuSource->isFinished() &&
+        g_taskParams.gpsSource->isFinished()) {
+        finishRun();
+    }
+    
     // Idle - let tasks run
     vTaskDelay(pdMS_TO_TICKS(100));
 }
 
+// =============================================================================
+// REPLAY / LOAD TEST
+// =============================================================================
+
+// The replay or generators have run out: let the pipeline drain, stop
+// recording and report. A host build exits here.
+void finishRun() {
+    uint32_t start = millis();
+    while (millis() - start < 2 * FLUSH_INTERVAL_MS) {
+        bool drained = g_imuBuffer.isEmpty() && g_gpsBuffer.isEmpty();
+        for (size_t i = 0; i < g_packetRing.getConsumerCount(); i++) {
+            drained = drained && g_packetRing.getConsumerStats(i).lag == 0;
+        }
+        if (drained) break;
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    vTaskDelay(pdMS_TO_TICKS(50));
+    
+    g_systemState.transitionTo(SystemState::READY, SystemEvent::BUTTON_PRESS);
+    g_logger.sync(pdMS_TO_TICKS(2000));
+    printSourceReport(&g_taskParams);
+    g_runReported = true;
+    
+#if !defined(ESP_PLATFORM)
+    g_logger.end();
+    fflush(stdout);
+    _Exit(0);
+#endif
+}
+
 // =============================================================================
 // COMMAND HANDLER
 // =============================================================================
@@ -271,49 +379,75 @@ void handleSerialCommand(char cmd) {
             g_systemState.transitionTo(SystemState::RECORDING, SystemEvent::BUTTON_PRESS);
             Serial.println("Recording started");
             break;
-            
+        
         case 's':  // Stop recording
             g_systemState.transitionTo(SystemState::READY, SystemEvent::BUTTON_PRESS);
             Serial.println("Recording stopped");
             break;
-            
+        
         case 'f':  // Flush SD card
-            g_logger.flush();
-            Serial.println("SD card flushed");
+            if (g_logger.sync(pdMS_TO_TICKS(2000))) {
+                Serial.println("SD card flushed");
+            } else {
+                Serial.println("SD flush timed out");
+            }
             break;
-            
+        
         case 'c':  // Calibrate IMU
             Serial.println("Calibrating... keep still");
             g_imu.performCalibration(300);
             Serial.println("Calibration complete");
             break;
-            
+        
         case 't':  // Print task stats
-            printTaskStats("Sensor", g_sensorStats);
-            printTaskStats("Compute", g_computeStats);
-            printTaskStats("Logging", g_loggingStats);
+            printTaskStats();
+            printPacketRingStats(g_packetRing, g_packetPool);
+            printLatencyStats();
             break;
-            
+        
+        case 'z':  // Print, then start a new measurement window
+            printTaskStats();
+            printLatencyStats();
+            resetTaskStats();
+            Serial.println("Task and latency stats reset");
+            break;
+        
+        case 'p':  // Sensor source and pipeline report
+            printSourceReport(&g_taskParams);
+            break;
+        
         case 'g':  // GPS status
             g_gps.printStatus();
             break;
-            
+        
+        case 'i': {  // IMU status
+            IMUSnapshot s = g_imu.getSnapshot();
+            IMUData latest = g_latestIMU.read();
+            Serial.printf("IMU: roll=%.1f pitch=%.1f yaw=%.1f G=%.2f temp=%.1fC\n",
+                          s.roll, s.pitch, s.yaw, s.gForce, s.temperature);
+            Serial.printf("  Last packet sample: %lums ago\n", millis() - latest.timestamp_ms);
+            break;
+        }
+        
         case 'a':  // Alert status
             g_alertManager.printStatus();
             break;
-            
+        
         case 'h':  // Help
             Serial.println("Commands:");
             Serial.println("  r - Start recording");
             Serial.println("  s - Stop recording");
             Serial.println("  f - Flush SD card");
             Serial.println("  c - Calibrate IMU");
-            Serial.println("  t - Task statistics");
+            Serial.println("  t - Task statistics and latency");
+            Serial.println("  z - Print and reset task and latency stats");
+            Serial.println("  p - Source report (replay / load test)");
             Serial.println("  g - GPS status");
+            Serial.println("  i - IMU status");
             Serial.println("  a - Alert status");
             Serial.println("  h - Help");
             break;
-            
+        
         default:
             break;
     }
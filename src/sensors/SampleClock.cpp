@@ -0,0 +1,122 @@
+#include "SampleClock.h"
+
+bool SampleClock::prepare(uint32_t periodUs) {
+    if (isRunning() || periodUs == 0) {
+        return false;
+    }
+    if (!ready) {
+        ready = xSemaphoreCreateBinary();
+        if (!ready) return false;
+    }
+    xSemaphoreTake(ready, 0);   // Drop a tick left from an earlier run
+    
+    this->periodUs = periodUs;
+    tickCount = 0;
+    takenIndex = 0;
+    missed.store(0, std::memory_order_relaxed);
+    latest.write(SampleTick{0, 0, 0});
+    return true;
+}
+
+bool SampleClock::beginTimer(uint32_t periodUs) {
+    if (!prepare(periodUs)) {
+        return false;
+    }
+    
+    esp_timer_create_args_t args = {};
+    args.callback = onTimer;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "sample_clock";
+    if (esp_timer_create(&args, &timer) != ESP_OK) {
+        timer = nullptr;
+        return false;
+    }
+    if (esp_timer_start_periodic(timer, periodUs) != ESP_OK) {
+        esp_timer_delete(timer);
+        timer = nullptr;
+        return false;
+    }
+    source = Source::TIMER;
+    
+    DEBUG_PRINTF(3, "Sample clock: timer every %luus\n", (unsigned long)periodUs);
+    return true;
+}
+
+bool SampleClock::beginDataReady(int pin, uint32_t periodUs) {
+    if (!prepare(periodUs)) {
+        return false;
+    }
+    
+    this->pin = pin;
+    pinMode(pin, INPUT);
+    attachInterruptArg(digitalPinToInterrupt(pin), onDataReady, this, RISING);
+    source = Source::DATA_READY;
+    
+    DEBUG_PRINTF(3, "Sample clock: data ready on GPIO %d, every %luus\n", pin, (unsigned long)periodUs);
+    return true;
+}
+
+void SampleClock::end() {
+    if (source == Source::TIMER) {
+        esp_timer_stop(timer);
+        esp_timer_delete(timer);
+        timer = nullptr;
+    } else if (source == Source::DATA_READY) {
+        detachInterrupt(digitalPinToInterrupt(pin));
+        pin = -1;
+    }
+    source = Source::NONE;
+}
+
+void IRAM_ATTR SampleClock::tick() {
+    SampleTick t;
+    t.index = ++tickCount;
+    t.timeUs = micros();
+    t.timeMs = millis();
+    latest.write(t);
+}
+
+void SampleClock::onTimer(void* arg) {
+    // Runs in the esp_timer task
+    SampleClock* clock = static_cast<SampleClock*>(arg);
+    clock->tick();
+    xSemaphoreGive(clock->ready);
+}
+
+void IRAM_ATTR SampleClock::onDataReady(void* arg) {
+    SampleClock* clock = static_cast<SampleClock*>(arg);
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    clock->tick();
+    xSemaphoreGiveFromISR(clock->ready, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+bool SampleClock::wait(TickType_t timeout) {
+    if (!isRunning()) {
+        return false;
+    }
+    return xSemaphoreTake(ready, timeout) == pdTRUE;
+}
+
+bool SampleClock::take(SampleTick& tick) {
+    SampleTick t = latest.read();
+    if (t.index == takenIndex) {
+        return false;
+    }
+    
+    // Ticks before the first take are start-up, not misses
+    if (takenIndex != 0 && t.index - takenIndex > 1) {
+        missed.fetch_add(t.index - takenIndex - 1, std::memory_order_relaxed);
+    }
+    takenIndex = t.index;
+    tick = t;
+    return true;
+}
+
+void SampleClock::printStatus() const {
+    static const char* const SOURCE_NAMES[] = {"stopped", "timer", "data ready"};
+    DEBUG_PRINTF(3, "IMU clock: %s, %luus period, %lu ticks, %lu missed\n",
+                 SOURCE_NAMES[static_cast<uint8_t>(source)], (unsigned long)periodUs,
+                 (unsigned long)getTicks(), (unsigned long)getMissed());
+}
@@ -0,0 +1,105 @@
+/**
+ * Hardware Sample Clock
+ *
+ * Paces IMU sampling from hardware instead of the RTOS tick: an esp_timer
+ * firing every period, or the MPU6050's data-ready line. Each tick records
+ * when it happened and wakes the sampling task once, so samples are spaced
+ * by the clock rather than by when the task got to run. Neither clock
+ * drifts: esp_timer schedules each alarm one period after the last was
+ * due, not after it ran, and data-ready follows the sensor's own oscillator.
+ *
+ * Features:
+ * - One wakeup per sample, no polling
+ * - Tick time captured in the timer callback / ISR
+ * - Ticks the task was too late to take are counted, not queued
+ *
+ * The tick handler is wait-free and may run in an ISR. One task waits on
+ * and takes the ticks; status may be read anywhere. begin/end only while
+ * that task is not taking.
+ */
+
+#pragma once
+
+#include "../core/config.h"
+#include "../utils/SeqLock.h"
+#include <atomic>
+#include <esp_timer.h>
+
+// One tick of the clock
+struct SampleTick {
+    uint32_t index;           // Ticks since begin, from 1 (0 = none yet)
+    uint32_t timeUs;          // micros() at the tick
+    uint32_t timeMs;          // millis() at the tick
+};
+
+class SampleClock {
+public:
+    enum class Source : uint8_t {
+        NONE,
+        TIMER,
+        DATA_READY
+    };
+    
+private:
+    Source source = Source::NONE;
+    uint32_t periodUs = 0;
+    int pin = -1;
+    esp_timer_handle_t timer = nullptr;
+    SemaphoreHandle_t ready = nullptr;    // Given once per tick
+    
+    // Tick handler only
+    uint32_t tickCount = 0;
+    SeqLock<SampleTick> latest;
+    
+    // Taking task only, bar the counter
+    uint32_t takenIndex = 0;
+    std::atomic<uint32_t> missed{0};
+    
+    bool prepare(uint32_t periodUs);
+    void IRAM_ATTR tick();
+    static void onTimer(void* arg);
+    static void IRAM_ATTR onDataReady(void* arg);
+    
+public:
+    SampleClock() {}
+    ~SampleClock() { end(); }
+    
+    SampleClock(const SampleClock&) = delete;
+    SampleClock& operator=(const SampleClock&) = delete;
+    
+    /**
+     * @brief Tick from an esp_timer
+     * @param periodUs Time between ticks
+     */
+    bool beginTimer(uint32_t periodUs);
+    
+    /**
+     * @brief Tick on each rising edge of a sensor's data-ready line
+     * @param pin GPIO the line is wired to
+     * @param periodUs The sensor's output period (for reporting and stats)
+     */
+    bool beginDataReady(int pin, uint32_t periodUs);
+    
+    void end();
+    
+    /**
+     * @brief Block until the next tick (taking task only)
+     * @return true if a tick is pending, false on timeout or when stopped
+     */
+    bool wait(TickType_t timeout);
+    
+    /**
+     * @brief Take the latest tick (taking task only)
+     * @param tick Receives it
+     * @return false if there has been none since the last take
+     */
+    bool take(SampleTick& tick);
+    
+    bool isRunning() const { return source != Source::NONE; }
+    Source getSource() const { return source; }
+    uint32_t getPeriodUs() const { return periodUs; }
+    uint32_t getTicks() const { return latest.read().index; }
+    uint32_t getMissed() const { return missed.load(std::memory_order_relaxed); }
+    
+    void printStatus() const;
+};
@@ -42,24 +42,32 @@ void GPS::end() {
 
 void GPS::update() {
     while (gpsSerial.available()) {
-        char c = gpsSerial.read();
-        
-        if (c == '$') {
-            // Start of new sentence
-            bufferIndex = 0;
-            nmeaBuffer[bufferIndex++] = c;
-        } else if (c == '\r' || c == '\n') {
-            // End of sentence
-            if (bufferIndex > 0 && bufferIndex < sizeof(nmeaBuffer)) {
-                nmeaBuffer[bufferIndex] = '\0';
-                if (validateChecksum(nmeaBuffer)) {
-                    parseNMEA(nmeaBuffer);
-                }
+        processByte(gpsSerial.read());
+    }
+}
+
+void GPS::feed(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        processByte(data[i]);
+    }
+}
+
+void GPS::processByte(char c) {
+    if (c == '$') {
+        // Start of new sentence
+        bufferIndex = 0;
+        nmeaBuffer[bufferIndex++] = c;
+    } else if (c == '\r' || c == '\n') {
+        // End of sentence
+        if (bufferIndex > 0 && bufferIndex < sizeof(nmeaBuffer)) {
+            nmeaBuffer[bufferIndex] = '\0';
+            if (validateChecksum(nmeaBuffer)) {
+                parseNMEA(nmeaBuffer);
             }
-            bufferIndex = 0;
-        } else if (bufferIndex < sizeof(nmeaBuffer) - 1) {
-            nmeaBuffer[bufferIndex++] = c;
         }
+        bufferIndex = 0;
+    } else if (bufferIndex < sizeof(nmeaBuffer) - 1) {
+        nmeaBuffer[bufferIndex++] = c;
     }
 }
 
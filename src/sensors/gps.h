@@ -73,6 +73,7 @@ private:
     bool configured = false;
     
     // NMEA parsing
+    void processByte(char c);
     bool parseNMEA(const char* sentence);
     bool parseGGA(const char* data);
     bool parseRMC(const char* data);
@@ -92,6 +93,10 @@ public:
     // Process incoming data - call frequently or from task
     void update();
     
+    // Parse bytes from elsewhere (a recorded stream) as if they came in on
+    // the UART
+    void feed(const uint8_t* data, size_t length);
+    
     // Wait for valid fix with timeout
     bool waitForFix(uint32_t timeoutMs);
     
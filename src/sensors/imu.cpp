@@ -36,9 +36,11 @@ bool IMU::begin() {
     wire->setClock(400000);  // 400kHz fast mode
     
     // Try to initialize MPU6050
-    if (!mpu.begin(MPU6050_ADDR, wire)) {
+    address = MPU6050_ADDR;
+    if (!mpu.begin(address, wire)) {
         DEBUG_PRINTLN(1, "MPU6050 not found at address 0x68, trying 0x69");
-        if (!mpu.begin(0x69, wire)) {
+        address = 0x69;
+        if (!mpu.begin(address, wire)) {
             DEBUG_PRINTLN(1, "MPU6050 initialization failed!");
             return false;
         }
@@ -49,12 +51,6 @@ bool IMU::begin() {
     mpu.setGyroRange(MPU6050_RANGE_1000_DEG);          // High rotation rates
     mpu.setFilterBandwidth(MPU6050_BAND_44_HZ);        // Balance latency vs noise
     
-    // Enable data ready interrupt on pin (optional - GPIO 34)
-    // mpu.setInterruptPinLatch(true);
-    // mpu.setInterruptPinPolarity(true);
-    // mpu.setInterrupt(MPU6050_INT_DATA_READY, true);
-    // attachInterrupt(digitalPinToInterrupt(34), onDataReady, RISING);
-    
     DEBUG_PRINTLN(3, "MPU6050 initialized successfully");
     DEBUG_PRINTLN(3, "  Accel range: +/- 16G");
     DEBUG_PRINTLN(3, "  Gyro range: +/- 1000 deg/s");
@@ -63,6 +59,32 @@ bool IMU::begin() {
     return true;
 }
 
+bool IMU::enableDataReady(uint32_t periodUs) {
+    // With the low-pass filter on, the sensor samples at 1kHz; the divider
+    // brings the output (and the data-ready pulses) down to the period
+    const uint32_t divider = periodUs / 1000;
+    if (divider < 1 || divider > 256) {
+        return false;
+    }
+    
+    // INT pin: active high, push-pull, 50us pulse per sample
+    if (!writeRegister(MPU6050_REG_SMPLRT_DIV, (uint8_t)(divider - 1)) ||
+        !writeRegister(MPU6050_REG_INT_PIN_CFG, 0x00) ||
+        !writeRegister(MPU6050_REG_INT_ENABLE, MPU6050_DATA_RDY_EN)) {
+        DEBUG_PRINTLN(1, "MPU6050 data ready setup failed");
+        return false;
+    }
+    DEBUG_PRINTF(3, "MPU6050 data ready every %luus\n", (unsigned long)(divider * 1000));
+    return true;
+}
+
+bool IMU::writeRegister(uint8_t reg, uint8_t value) {
+    wire->beginTransmission(address);
+    wire->write(reg);
+    wire->write(value);
+    return wire->endTransmission() == 0;
+}
+
 void IMU::end() {
     // Cleanup
 }
@@ -108,11 +130,26 @@ bool IMU::read() {
     if (!calibrationMode) {
         computeOrientation();
     }
+    publishSnapshot();
     
     sampleCount++;
     return true;
 }
 
+void IMU::inject(const IMUData& sample) {
+    calAx = sample.accel_x;
+    calAy = sample.accel_y;
+    calAz = sample.accel_z;
+    calGx = sample.gyro_x;
+    calGy = sample.gyro_y;
+    calGz = sample.gyro_z;
+    temperature = sample.temperature;
+    
+    computeOrientation();
+    publishSnapshot();
+    sampleCount++;
+}
+
 bool IMU::isDataReady() {
     // Check interrupt flag or poll status
     if (dataReady) {
@@ -145,6 +182,22 @@ void IMU::computeOrientation() {
     gForce = sqrt(ax_g * ax_g + ay_g * ay_g + az_g * az_g);
 }
 
+void IMU::publishSnapshot() {
+    IMUSnapshot s;
+    s.accel[0] = calAx;
+    s.accel[1] = calAy;
+    s.accel[2] = calAz;
+    s.gyro[0] = calGx;
+    s.gyro[1] = calGy;
+    s.gyro[2] = calGz;
+    s.temperature = temperature;
+    s.roll = roll;
+    s.pitch = pitch;
+    s.yaw = yaw;
+    s.gForce = gForce;
+    snapshot.write(s);
+}
+
 void IMU::startCalibration() {
     calibrationMode = true;
     DEBUG_PRINTLN(3, "IMU calibration started - keep sensor still and level");
@@ -214,12 +267,14 @@ bool IMU::isHealthy() const {
     // Check for stuck values (sensor might be disconnected)
     if (sampleCount < 10) return true;  // Not enough samples yet
     
+    IMUSnapshot s = snapshot.read();
+    
     // Check temperature is reasonable (-40 to +85 for MPU6050)
-    if (temperature < -40.0f || temperature > 85.0f) return false;
+    if (s.temperature < -40.0f || s.temperature > 85.0f) return false;
     
     // Check accelerometer values are within range
     float maxAccel = 20.0f * GRAVITY_MS2;  // Slightly above 16G range
-    if (fabs(calAx) > maxAccel || fabs(calAy) > maxAccel || fabs(calAz) > maxAccel) {
+    if (fabs(s.accel[0]) > maxAccel || fabs(s.accel[1]) > maxAccel || fabs(s.accel[2]) > maxAccel) {
         return false;
     }
     
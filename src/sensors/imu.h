@@ -6,11 +6,13 @@
  * - Digital Motion Processor (DMP) for sensor fusion
  * - 6-axis quaternion output for orientation
  * - Calibration and bias compensation
+ * - Lock-free snapshot of the latest reading for other tasks/cores
  */
 
 #pragma once
 
 #include "../core/config.h"
+#include "../utils/SeqLock.h"
 #include <Wire.h>
 #include <Adafruit_MPU6050.h>
 #include <Adafruit_Sensor.h>
@@ -23,10 +25,26 @@ struct IMUCalibration {
     bool isValid = false;
 };
 
+// Latest calibrated reading and derived orientation, published after each read()
+struct IMUSnapshot {
+    float accel[3];           // m/s^2
+    float gyro[3];            // rad/s
+    float temperature;        // Celsius
+    float roll, pitch, yaw;   // degrees
+    float gForce;
+};
+
+// Registers set directly for the data-ready interrupt
+constexpr uint8_t MPU6050_REG_SMPLRT_DIV = 0x19;
+constexpr uint8_t MPU6050_REG_INT_PIN_CFG = 0x37;
+constexpr uint8_t MPU6050_REG_INT_ENABLE = 0x38;
+constexpr uint8_t MPU6050_DATA_RDY_EN = 0x01;
+
 class IMU {
 private:
     Adafruit_MPU6050 mpu;
     TwoWire* wire = nullptr;
+    uint8_t address = MPU6050_ADDR;
     
     // Raw data
     float rawAx, rawAy, rawAz;
@@ -41,6 +59,9 @@ private:
     float roll, pitch, yaw;
     float gForce;
     
+    // Copy of the above for readers outside the sampling task
+    SeqLock<IMUSnapshot> snapshot;
+    
     // Calibration
     IMUCalibration calibration;
     bool calibrationMode = false;
@@ -55,6 +76,8 @@ private:
     static SemaphoreHandle_t dataReadySemaphore;
     
     void computeOrientation();
+    void publishSnapshot();
+    bool writeRegister(uint8_t reg, uint8_t value);
     
 public:
     IMU(TwoWire* i2c = &Wire);
@@ -62,6 +85,10 @@ public:
     bool begin();
     void end();
     
+    // Pulse the INT pin each time a sample is ready, every periodUs
+    // (1ms multiples up to 256ms); after begin()
+    bool enableDataReady(uint32_t periodUs);
+    
     // Blocking read (for task-based operation)
     bool waitForData(TickType_t timeout = portMAX_DELAY);
     bool read();
@@ -69,6 +96,10 @@ public:
     // Non-blocking check
     bool isDataReady();
     
+    // Take a recorded (calibrated) sample as the current reading, in place
+    // of read(), for replay
+    void inject(const IMUData& sample);
+    
     // Calibration
     void startCalibration();
     void stopCalibration();
@@ -76,24 +107,34 @@ public:
     void saveCalibration(const IMUCalibration& cal);
     IMUCalibration getCalibration() const { return calibration; }
     
-    // Data accessors
-    float getAccelX() const { return calAx; }
-    float getAccelY() const { return calAy; }
-    float getAccelZ() const { return calAz; }
-    float getGyroX() const { return calGx; }
-    float getGyroY() const { return calGy; }
-    float getGyroZ() const { return calGz; }
-    float getTemperature() const { return temperature; }
+    // Data accessors (safe from any task; each call takes a fresh snapshot)
+    float getAccelX() const { return snapshot.read().accel[0]; }
+    float getAccelY() const { return snapshot.read().accel[1]; }
+    float getAccelZ() const { return snapshot.read().accel[2]; }
+    float getGyroX() const { return snapshot.read().gyro[0]; }
+    float getGyroY() const { return snapshot.read().gyro[1]; }
+    float getGyroZ() const { return snapshot.read().gyro[2]; }
+    float getTemperature() const { return snapshot.read().temperature; }
     
     // Derived values
-    float getRoll() const { return roll; }      // degrees
-    float getPitch() const { return pitch; }    // degrees
-    float getYaw() const { return yaw; }        // degrees (drifts without mag)
-    float getGForce() const { return gForce; }
+    float getRoll() const { return snapshot.read().roll; }      // degrees
+    float getPitch() const { return snapshot.read().pitch; }    // degrees
+    float getYaw() const { return snapshot.read().yaw; }        // degrees (drifts without mag)
+    float getGForce() const { return snapshot.read().gForce; }
+    
+    // Consistent view of all values from a single read()
+    IMUSnapshot getSnapshot() const { return snapshot.read(); }
+    uint32_t getSnapshotVersion() const { return snapshot.version(); }
     
     // Vector accessors
-    void getAccel(float& x, float& y, float& z) const { x = calAx; y = calAy; z = calAz; }
-    void getGyro(float& x, float& y, float& z) const { x = calGx; y = calGy; z = calGz; }
+    void getAccel(float& x, float& y, float& z) const {
+        IMUSnapshot s = snapshot.read();
+        x = s.accel[0]; y = s.accel[1]; z = s.accel[2];
+    }
+    void getGyro(float& x, float& y, float& z) const {
+        IMUSnapshot s = snapshot.read();
+        x = s.gyro[0]; y = s.gyro[1]; z = s.gyro[2];
+    }
     
     // Statistics
     uint32_t getSampleCount() const { return sampleCount; }
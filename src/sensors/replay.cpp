@@ -0,0 +1,303 @@
+#include "replay.h"
+#include <SD.h>
+
+SensorReplay::SensorReplay() {
+    memset(&stats, 0, sizeof(stats));
+    memset(&nextSample, 0, sizeof(nextSample));
+    memset(&nextFix, 0, sizeof(nextFix));
+}
+
+SensorReplay::~SensorReplay() {
+    end();
+}
+
+bool SensorReplay::begin(const char* filename, float speed) {
+    end();
+    memset(&stats, 0, sizeof(stats));
+    
+    File probe = SD.open(filename, FILE_READ);
+    if (!probe) {
+        DEBUG_PRINTF(1, "Replay: cannot open %s\n", filename);
+        return false;
+    }
+    uint32_t magic = 0;
+    size_t got = probe.read((uint8_t*)&magic, sizeof(magic));
+    probe.close();
+    
+    fromLog = got == sizeof(magic) && magic == LOG_FILE_MAGIC;
+    if (!(fromLog ? openLog(filename) : openNMEA(filename))) {
+        DEBUG_PRINTF(1, fromLog ? "Replay: %s is not a readable log (format %d..%d)\n"
+                                : "Replay: %s is neither a log nor an NMEA capture\n",
+                     filename, LOG_FORMAT_RAW, LOG_FORMAT_STREAMS);
+        end();
+        return false;
+    }
+    
+    speedMilli = speed > 0 ? (uint32_t)(speed * 1000.0f + 0.5f) : 0;
+    clockMs = firstTimestamp;
+    clockRunning = false;
+    active = true;
+    publish();
+    
+    DEBUG_PRINTF(3, "Replay: %s (%s) at %.1fx (0 = full speed)\n", filename,
+                 fromLog ? (samplesFromStream ? "log, raw IMU stream" : "log") : "NMEA",
+                 getSpeed());
+    return true;
+}
+
+bool SensorReplay::openLog(const char* filename) {
+    packetFile = SD.open(filename, FILE_READ);
+    if (!packetFile || !packetReader.begin(packetFile)) {
+        return false;
+    }
+    packetsLeft = true;
+    
+    if (packetReader.hasStream(LOG_STREAM_IMU)) {
+        sampleFile = SD.open(filename, FILE_READ);
+        samplesFromStream = sampleFile && sampleReader.begin(sampleFile, LOG_STREAM_IMU);
+        samplesLeft = samplesFromStream;
+    }
+    
+    // Playback starts at the earliest record of either kind
+    readAhead();
+    if (haveSample && haveFix) {
+        firstTimestamp = (int32_t)(nextFix.timestamp_ms - nextSample.timestamp_ms) < 0
+                       ? nextFix.timestamp_ms : nextSample.timestamp_ms;
+    } else if (haveSample || haveFix) {
+        firstTimestamp = haveSample ? nextSample.timestamp_ms : nextFix.timestamp_ms;
+    }
+    return true;
+}
+
+bool SensorReplay::openNMEA(const char* filename) {
+    nmeaFile = SD.open(filename, FILE_READ);
+    if (!nmeaFile) return false;
+    
+    readPos = readLength = 0;
+    epochs = 0;
+    firstTimestamp = 0;
+    haveLine = readLine();
+    return haveLine && line[0] == '$';
+}
+
+void SensorReplay::end() {
+    if (packetFile) packetFile.close();
+    if (sampleFile) sampleFile.close();
+    if (nmeaFile) nmeaFile.close();
+    samplesFromStream = packetsLeft = samplesLeft = false;
+    haveSample = haveFix = haveLine = false;
+    lastSampleTimestamp = lastFixTimestamp = 0;
+    active = false;
+}
+
+void SensorReplay::startClock() {
+    if (!clockRunning) {
+        startMs = millis();
+        clockRunning = true;
+    }
+}
+
+void SensorReplay::readAhead() {
+    if (samplesLeft && !haveSample) {
+        samplesLeft = haveSample = sampleReader.next(nextSample);
+    }
+    
+    // Packets hold the fixes, and the samples when there is no IMU stream.
+    // The next packet is only read once what the last one gave is taken.
+    uint16_t budget = MAX_PACKETS_PER_POLL;
+    while (packetsLeft && !haveFix && (samplesFromStream || !haveSample) && budget-- > 0) {
+        TelemetryPacket packet;
+        if (!packetReader.next(packet)) {
+            packetsLeft = false;
+            break;
+        }
+        if (!samplesFromStream && packet.imu.timestamp_ms != lastSampleTimestamp) {
+            nextSample = packet.imu;
+            lastSampleTimestamp = packet.imu.timestamp_ms;
+            haveSample = true;
+        }
+        if (packet.gps.timestamp_ms != 0 && packet.gps.timestamp_ms != lastFixTimestamp) {
+            nextFix = packet.gps;
+            lastFixTimestamp = packet.gps.timestamp_ms;
+            haveFix = true;
+        }
+    }
+    
+    if (!stats.finished && !haveSample && !haveFix && !packetsLeft && !samplesLeft) {
+        stats.finished = true;
+        publish();
+    }
+}
+
+bool SensorReplay::due(uint32_t timestamp) const {
+    if (speedMilli == 0) {
+        return (int32_t)(timestamp - clockMs) <= 0;
+    }
+    const uint64_t playedMs = (uint64_t)(millis() - startMs) * speedMilli / 1000;
+    return (int32_t)(timestamp - firstTimestamp) <= 0 ||
+           (uint64_t)(timestamp - firstTimestamp) <= playedMs;
+}
+
+void SensorReplay::played(uint32_t timestamp) {
+    if ((int32_t)(timestamp - clockMs) > 0) {
+        clockMs = timestamp;
+    }
+    stats.recordedMs = clockMs - firstTimestamp;
+}
+
+void SensorReplay::publish() {
+    stats.elapsedMs = clockRunning ? millis() - startMs : 0;
+    stats.corruptBlocks = packetReader.getCorruptBlocks() + sampleReader.getCorruptBlocks();
+    published.write(stats);
+}
+
+size_t SensorReplay::pollIMU(IMUData* samples, size_t maxSamples) {
+    if (!active || !fromLog) return 0;
+    startClock();
+    
+    size_t count = 0;
+    while (count < maxSamples) {
+        readAhead();
+        
+        // At full speed the samples set the clock
+        if (!haveSample || (speedMilli > 0 && !due(nextSample.timestamp_ms))) break;
+        samples[count++] = nextSample;
+        haveSample = false;
+        played(nextSample.timestamp_ms);
+        stats.imuSamples++;
+    }
+    
+    if (count > 0) publish();
+    return count;
+}
+
+bool SensorReplay::pollGPS(GPSData& fix) {
+    if (!active || !fromLog) return false;
+    startClock();
+    
+    readAhead();
+    
+    // A fix with no samples left to pace it is due at once
+    if (!haveFix || (haveSample && !due(nextFix.timestamp_ms))) {
+        return false;
+    }
+    fix = nextFix;
+    haveFix = false;
+    played(nextFix.timestamp_ms);
+    stats.gpsFixes++;
+    
+    readAhead();
+    publish();
+    return true;
+}
+
+bool SensorReplay::readLine() {
+    lineLength = 0;
+    while (true) {
+        if (readPos == readLength) {
+            readLength = nmeaFile.read(readBuffer, sizeof(readBuffer));
+            readPos = 0;
+            if (readLength == 0 || readLength > sizeof(readBuffer)) {
+                readLength = 0;
+                line[lineLength] = '\0';
+                return lineLength > 0;
+            }
+        }
+        
+        const char c = readBuffer[readPos++];
+        if (c == '\r' || c == '\n') {
+            if (lineLength > 0) break;
+            continue;
+        }
+        // Overlong lines are cut; the checksum then rejects them
+        if (lineLength < sizeof(line) - 1) {
+            line[lineLength++] = c;
+        }
+    }
+    line[lineLength] = '\0';
+    return true;
+}
+
+bool SensorReplay::isEpochStart() const {
+    return line[0] == '$' && lineLength > 6 && strncmp(line + 3, "GGA", 3) == 0;
+}
+
+size_t SensorReplay::pollNMEA(uint8_t* buffer, size_t size, uint32_t& timestamp) {
+    if (!active || fromLog || !haveLine) return 0;
+    startClock();
+    
+    const uint32_t epochTime = firstTimestamp + epochs * (1000 / GPS_SAMPLE_RATE_HZ);
+    if (speedMilli > 0 && !due(epochTime)) return 0;
+    
+    // Everything up to the next GGA, with line endings put back
+    size_t length = 0;
+    do {
+        if (length + lineLength + 2 <= size) {
+            memcpy(buffer + length, line, lineLength);
+            buffer[length + lineLength] = '\r';
+            buffer[length + lineLength + 1] = '\n';
+            length += lineLength + 2;
+        }
+        haveLine = readLine();
+    } while (haveLine && !isEpochStart());
+    
+    epochs++;
+    timestamp = epochTime;
+    played(epochTime);
+    stats.gpsFixes++;
+    stats.nmeaBytes += length;
+    stats.finished = !haveLine;
+    publish();
+    return length;
+}
+
+size_t ReplayIMUSource::poll(StampedIMU* samples, size_t maxSamples) {
+    // Read in chunks, then stamp each sample with the time it is handed on
+    IMUData chunk[16];
+    size_t count = 0;
+    while (count < maxSamples) {
+        const size_t wanted = min(maxSamples - count, sizeof(chunk) / sizeof(chunk[0]));
+        const size_t read = replay.pollIMU(chunk, wanted);
+        const uint32_t now = micros();
+        for (size_t i = 0; i < read; i++) {
+            IMUData& sample = samples[count].data;
+            sample = chunk[i];
+            imu.inject(sample);
+            imu.fillData(sample, sample.timestamp_ms);
+            samples[count++].acquired_us = now;
+        }
+        if (read < wanted) break;
+    }
+    return count;
+}
+
+void ReplayIMUSource::printStatus() const {
+    ReplayStats stats = replay.getStats();
+    const float seconds = max(stats.elapsedMs, (uint32_t)1) / 1000.0f;
+    DEBUG_PRINTF(3, "Replay %s: %.1fs of recording in %.1fs (%.1fx)\n",
+                 stats.finished ? "finished" : "running", stats.recordedMs / 1000.0f,
+                 seconds, stats.recordedMs / 1000.0f / seconds);
+    DEBUG_PRINTF(3, "  In:  IMU=%lu (%.0f/s), GPS=%lu, NMEA=%luB, badBlocks=%lu\n",
+                 stats.imuSamples, stats.imuSamples / seconds, stats.gpsFixes,
+                 stats.nmeaBytes, stats.corruptBlocks);
+}
+
+bool ReplayGPSSource::poll(StampedGPS& fix) {
+    if (replay.isLog()) {
+        if (!replay.pollGPS(fix.data)) {
+            return false;
+        }
+        fix.acquired_us = micros();
+        return true;
+    }
+    
+    uint32_t timestamp;
+    size_t length = replay.pollNMEA(nmea, sizeof(nmea), timestamp);
+    if (length == 0) {
+        return false;
+    }
+    fix.acquired_us = micros();
+    gps.feed(nmea, length);
+    gps.fillData(fix.data, timestamp);
+    return true;
+}
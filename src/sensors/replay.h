@@ -0,0 +1,173 @@
+/**
+ * Sensor Replay
+ *
+ * Plays a recording into sensorTask in place of the IMU and GPS, so the
+ * rest of the pipeline (compute, alerts, logging, telemetry) runs exactly
+ * as it does in the car. At real time it reproduces a field problem;
+ * played faster it shows where the pipeline starts to drop data.
+ *
+ * Sources, told apart by their first bytes:
+ * - A rally log (any format). IMU samples come from the raw IMU stream
+ *   when the file has one, otherwise from the packets; GPS fixes come from
+ *   the packets, once per new fix.
+ * - A captured NMEA stream, fed to GPS::feed() one epoch at a time. The
+ *   capture holds no receive times, so each GGA sentence starts an epoch
+ *   GPS_INTERVAL_MS after the previous one.
+ *
+ * Records fall due on their recorded schedule divided by the speed factor.
+ * At speed 0 nothing waits for the clock: sensorTask hands samples on as
+ * fast as computeTask takes them, and GPS fixes follow the IMU samples
+ * recorded around them.
+ *
+ * ReplayIMUSource and ReplayGPSSource present the replay to sensorTask
+ * as its sources (source.h), through the same driver calls as live
+ * readings. One task polls; getStats() may be called from any task.
+ */
+
+#pragma once
+
+#include "../core/config.h"
+#include "../storage/LogReader.h"
+#include "../utils/SeqLock.h"
+#include "source.h"
+#include <FS.h>
+
+struct ReplayStats {
+    uint32_t imuSamples;      // Handed to sensorTask
+    uint32_t gpsFixes;        // Fixes from a log, or NMEA epochs
+    uint32_t nmeaBytes;
+    uint32_t recordedMs;      // Recording time played so far
+    uint32_t elapsedMs;       // Wall time since begin()
+    uint32_t corruptBlocks;   // Log blocks the reader had to skip
+    bool finished;
+};
+
+class SensorReplay {
+public:
+    static constexpr size_t MAX_NMEA_LINE = 128;
+    
+    // Packets read per poll while looking for the next fix, so a log
+    // without GPS cannot stall sensorTask
+    static constexpr uint16_t MAX_PACKETS_PER_POLL = 64;
+    
+private:
+    // Rally log
+    File packetFile;
+    File sampleFile;
+    LogReader packetReader;
+    LogReader sampleReader;
+    bool samplesFromStream = false;
+    bool packetsLeft = false;
+    bool samplesLeft = false;
+    
+    // Next record of each kind, read ahead
+    IMUData nextSample;
+    GPSData nextFix;
+    bool haveSample = false;
+    bool haveFix = false;
+    uint32_t lastSampleTimestamp = 0;
+    uint32_t lastFixTimestamp = 0;
+    
+    // NMEA capture; `line` holds the first sentence of the next epoch
+    File nmeaFile;
+    uint8_t readBuffer[512];
+    size_t readPos = 0;
+    size_t readLength = 0;
+    char line[MAX_NMEA_LINE];
+    size_t lineLength = 0;
+    bool haveLine = false;
+    uint32_t epochs = 0;
+    
+    bool active = false;
+    bool fromLog = false;
+    bool clockRunning = false;    // From the first poll on
+    uint32_t speedMilli = 1000;   // Speed factor x1000 (0 = as fast as possible)
+    uint32_t startMs = 0;
+    uint32_t firstTimestamp = 0;  // Recorded time playback starts from
+    uint32_t clockMs = 0;         // Recorded time of the last IMU sample handed on
+    ReplayStats stats;
+    SeqLock<ReplayStats> published;
+    
+    bool openLog(const char* filename);
+    bool openNMEA(const char* filename);
+    void startClock();
+    void readAhead();
+    bool readLine();
+    bool isEpochStart() const;
+    bool due(uint32_t timestamp) const;
+    void played(uint32_t timestamp);
+    void publish();
+    
+public:
+    SensorReplay();
+    ~SensorReplay();
+    
+    /**
+     * @brief Open a recording; its clock starts with the first poll
+     * @param speed Playback speed factor; 0 = as fast as possible
+     * @return false if the file is missing or neither a log nor NMEA
+     */
+    bool begin(const char* filename, float speed = 1.0f);
+    void end();
+    
+    /**
+     * @brief IMU samples due now, oldest first
+     * @return Number written to samples
+     */
+    size_t pollIMU(IMUData* samples, size_t maxSamples);
+    
+    /**
+     * @brief Next GPS fix from a log, if due now
+     */
+    bool pollGPS(GPSData& fix);
+    
+    /**
+     * @brief Sentences of the next NMEA epoch, if due now
+     * @param timestamp Set to the epoch's recorded time
+     * @return Bytes written to buffer (0 if nothing is due)
+     */
+    size_t pollNMEA(uint8_t* buffer, size_t size, uint32_t& timestamp);
+    
+    // Between begin() and the end of the recording (polling task only)
+    bool isActive() const { return active && !stats.finished; }
+    
+    // Every record has been handed on (any task)
+    bool isFinished() const { return active && published.read().finished; }
+    bool isLog() const { return fromLog; }
+    float getSpeed() const { return speedMilli / 1000.0f; }
+    
+    ReplayStats getStats() const { return published.read(); }
+};
+
+// The replay's IMU samples, set as the IMU's current reading one by one
+// and stamped as acquired when they are handed on. Also reports the
+// replay as a whole.
+class ReplayIMUSource : public IIMUSource {
+private:
+    SensorReplay& replay;
+    IMU& imu;
+    
+public:
+    ReplayIMUSource(SensorReplay& replay, IMU& imu) : replay(replay), imu(imu) {}
+    
+    size_t poll(StampedIMU* samples, size_t maxSamples) override;
+    bool isPaced() const override { return replay.getSpeed() > 0; }
+    bool isFinished() const override { return replay.isFinished(); }
+    void printStatus() const override;
+};
+
+// The replay's fixes; an NMEA capture goes through the GPS parser one
+// epoch at a time
+class ReplayGPSSource : public IGPSSource {
+private:
+    SensorReplay& replay;
+    GPS& gps;
+    uint8_t nmea[1024];
+    
+public:
+    ReplayGPSSource(SensorReplay& replay, GPS& gps) : replay(replay), gps(gps) {}
+    
+    bool poll(StampedGPS& fix) override;
+    bool isPaced() const override { return replay.getSpeed() > 0; }
+    bool isFinished() const override { return replay.isFinished(); }
+};
@@ -0,0 +1,55 @@
+#include "source.h"
+
+size_t LiveIMUSource::poll(StampedIMU* samples, size_t maxSamples) {
+    if (maxSamples == 0) {
+        return 0;
+    }
+    
+    if (isClocked()) {
+        // One read per tick, stamped with the tick rather than the read so
+        // the spacing is the clock's
+        SampleTick tick;
+        if (!clock->take(tick) || !imu.read()) {
+            return 0;
+        }
+        imu.fillData(samples[0].data, tick.timeMs);
+        samples[0].acquired_us = tick.timeUs;
+        return 1;
+    }
+    
+    const TickType_t now = xTaskGetTickCount();
+    if (now - lastTime < IMU_INTERVAL_MS) {
+        return 0;
+    }
+    // The next slot is a period after this one was due, not after it was
+    // read, so lateness does not accumulate; after a stall, start afresh
+    lastTime = (now - lastTime < 2 * IMU_INTERVAL_MS) ? lastTime + IMU_INTERVAL_MS : now;
+    
+    // Stamped before the I2C read, so its time counts towards the age
+    const uint32_t acquiredUs = micros();
+    if (!imu.read()) {
+        return 0;
+    }
+    imu.fillData(samples[0].data, millis());
+    samples[0].acquired_us = acquiredUs;
+    return 1;
+}
+
+void LiveIMUSource::printStatus() const {
+    if (clock) {
+        clock->printStatus();
+    }
+}
+
+bool LiveGPSSource::poll(StampedGPS& fix) {
+    // Process all available data
+    gps.update();
+    
+    if (xTaskGetTickCount() - lastTime < GPS_INTERVAL_MS) {
+        return false;
+    }
+    fix.acquired_us = micros();
+    gps.fillData(fix.data, millis());
+    lastTime = xTaskGetTickCount();
+    return true;
+}
@@ -0,0 +1,115 @@
+/**
+ * Sensor Sources
+ *
+ * Where sensorTask gets its readings from. The live drivers, a replayed
+ * recording (replay.h) and the load-test generators (synthetic.h) all hand
+ * over finished IMUData / GPSData records, timestamped when they were
+ * taken, so the rings and every task after them cannot tell them apart.
+ * Each also carries acquired_us, the micros() time it was read (or, for
+ * stand-ins, due), from which the tasks measure how old it gets.
+ *
+ * Paced sources produce readings on their own clock and are polled every
+ * sensorTask pass. Clocked ones are paced by a hardware clock (see
+ * SampleClock.h) and wake sensorTask once per reading instead. Unpaced
+ * ones (a replay at speed 0) produce as fast as they are asked; sensorTask
+ * only asks again once the last batch has been taken off the ring.
+ *
+ * Sources are polled from sensorTask only; printStatus() may run anywhere.
+ */
+
+#pragma once
+
+#include "../core/config.h"
+#include "imu.h"
+#include "gps.h"
+#include "SampleClock.h"
+
+class IIMUSource {
+public:
+    virtual ~IIMUSource() {}
+    
+    /**
+     * @brief Samples due now, oldest first
+     * @return Number written to samples
+     */
+    virtual size_t poll(StampedIMU* samples, size_t maxSamples) = 0;
+    
+    // Real sensors run all the time; stand-ins only while recording, so
+    // nothing they produce is gone before the logger can take it
+    virtual bool isLive() const { return false; }
+    virtual bool isPaced() const { return true; }
+    
+    // Nothing more will come (end of a recording or of a test run)
+    virtual bool isFinished() const { return false; }
+    
+    // Time between readings (us), 0 if there is no fixed rate
+    virtual uint32_t getPeriodUs() const { return 0; }
+    
+    // Readings that go into one packet, so packets stay at LOG_RATE_HZ
+    // whatever the source's rate; IMU_SAMPLES_PER_PACKET without one
+    size_t samplesPerPacket() const {
+        const uint32_t periodUs = getPeriodUs();
+        if (periodUs == 0) return IMU_SAMPLES_PER_PACKET;
+        const size_t samples = 1000000 / LOG_RATE_HZ / periodUs;
+        return samples > 0 ? samples : 1;
+    }
+    
+    // Block until a reading is due (clocked sources only)
+    virtual bool isClocked() const { return false; }
+    virtual bool waitForSample(TickType_t timeout) { (void)timeout; return false; }
+    
+    virtual void printStatus() const {}
+};
+
+class IGPSSource {
+public:
+    virtual ~IGPSSource() {}
+    
+    /**
+     * @brief Next fix, if one is due now
+     */
+    virtual bool poll(StampedGPS& fix) = 0;
+    
+    virtual bool isLive() const { return false; }
+    virtual bool isPaced() const { return true; }
+    virtual bool isFinished() const { return false; }
+    virtual void printStatus() const {}
+};
+
+// The MPU6050, read at each tick of a running SampleClock and stamped with
+// the tick's time; without one, every IMU_INTERVAL_MS of RTOS ticks
+class LiveIMUSource : public IIMUSource {
+private:
+    IMU& imu;
+    SampleClock* clock = nullptr;
+    TickType_t lastTime = 0;
+    
+public:
+    explicit LiveIMUSource(IMU& imu) : imu(imu) {}
+    
+    // Before sensorTask starts
+    void setClock(SampleClock* clock) { this->clock = clock; }
+    
+    size_t poll(StampedIMU* samples, size_t maxSamples) override;
+    bool isLive() const override { return true; }
+    uint32_t getPeriodUs() const override {
+        return isClocked() ? clock->getPeriodUs() : IMU_INTERVAL_MS * portTICK_PERIOD_MS * 1000;
+    }
+    bool isClocked() const override { return clock && clock->isRunning(); }
+    bool waitForSample(TickType_t timeout) override { return clock && clock->wait(timeout); }
+    void printStatus() const override;
+};
+
+// The receiver's UART, parsed as it arrives; the current fix is taken
+// every GPS_INTERVAL_MS
+class LiveGPSSource : public IGPSSource {
+private:
+    GPS& gps;
+    TickType_t lastTime = 0;
+    
+public:
+    explicit LiveGPSSource(GPS& gps) : gps(gps) {}
+    
+    bool poll(StampedGPS& fix) override;
+    bool isLive() const override { return true; }
+};
@@ -0,0 +1,310 @@
+#include "synthetic.h"
+
+static constexpr float TWO_PI_F = 6.2831853f;
+static constexpr double METRES_PER_DEGREE = 111320.0;
+
+// Advance a generator clock that started at the first poll; micros()
+// wraps every 71 minutes, so it is accumulated rather than subtracted
+static uint64_t advanceClock(bool& started, uint32_t& startMs, uint32_t& lastUs,
+                             uint64_t& elapsedUs) {
+    const uint32_t now = micros();
+    if (!started) {
+        started = true;
+        startMs = millis();
+        lastUs = now;
+    }
+    elapsedUs += (uint32_t)(now - lastUs);
+    lastUs = now;
+    return elapsedUs;
+}
+
+// Records due by now (the first one at time 0), capped at the run length
+static uint64_t dueCount(uint64_t elapsedUs, uint32_t rateHz, uint32_t runMs) {
+    uint64_t due = elapsedUs * rateHz / 1000000 + 1;
+    if (runMs > 0) {
+        const uint64_t total = (uint64_t)runMs * rateHz / 1000;
+        if (due > total) due = total;
+    }
+    return due;
+}
+
+// =============================================================================
+// IMU
+// =============================================================================
+
+SyntheticIMUConfig SyntheticIMUConfig::forProfile(SyntheticProfile profile) {
+    SyntheticIMUConfig config;
+    if (profile == SyntheticProfile::VIBRATION || profile == SyntheticProfile::STAGE) {
+        config.vibrationHz = 35.0f;   // Engine at ~4200rpm
+        config.vibrationG = 0.4f;
+        config.noiseG = 0.08f;        // Road surface
+    }
+    if (profile == SyntheticProfile::IMPACTS || profile == SyntheticProfile::STAGE) {
+        config.impactG = 4.0f;        // Above ALERT_G_FORCE_CRIT
+    }
+    return config;
+}
+
+SyntheticIMU::SyntheticIMU(IMU& imu, const SyntheticIMUConfig& config)
+    : imu(imu), config(config), random(config.seed) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+void SyntheticIMU::configure(const SyntheticIMUConfig& newConfig) {
+    config = newConfig;
+    random = SyntheticRandom(config.seed);
+    memset(&stats, 0, sizeof(stats));
+    started = false;
+    elapsedUs = 0;
+    next = 0;
+    vibrationPhase = 0.0f;
+}
+
+void SyntheticIMU::generate(uint64_t index, IMUData& sample) {
+    const float g = GRAVITY_MS2;
+    
+    vibrationPhase += TWO_PI_F * config.vibrationHz / config.rateHz;
+    if (vibrationPhase >= TWO_PI_F) vibrationPhase -= TWO_PI_F;
+    const float vibration = config.vibrationG * sinf(vibrationPhase);
+    
+    // Half-sine pulse at the start of each impact period
+    float impact = 0.0f;
+    if (config.impactG > 0.0f && config.impactEveryMs > 0) {
+        const uint64_t period = max((uint64_t)config.impactEveryMs * config.rateHz / 1000, (uint64_t)1);
+        const uint64_t length = max((uint64_t)config.impactMs * config.rateHz / 1000, (uint64_t)1);
+        const uint64_t position = index % period;
+        if (position < length) {
+            impact = config.impactG * sinf(PI * position / length);
+            if (position == 0) stats.impacts++;
+        }
+    }
+    
+    sample.timestamp_ms = startMs + (uint32_t)(index * 1000 / config.rateHz);
+    sample.accel_x = (0.3f * vibration + config.noiseG * random.gaussian()) * g;
+    sample.accel_y = (0.5f * vibration + config.noiseG * random.gaussian()) * g;
+    sample.accel_z = (1.0f + vibration + impact + config.noiseG * random.gaussian()) * g;
+    sample.gyro_x = 0.2f * impact + 0.01f * random.gaussian();    // Roll kick, rad/s
+    sample.gyro_y = 0.01f * random.gaussian();
+    sample.gyro_z = 0.01f * random.gaussian();
+    sample.temperature = 35.0f;
+}
+
+size_t SyntheticIMU::poll(StampedIMU* samples, size_t maxSamples) {
+    if (config.rateHz == 0) return 0;
+    advanceClock(started, startMs, lastUs, elapsedUs);
+    
+    const uint64_t due = dueCount(elapsedUs, config.rateHz, config.runMs);
+    const uint64_t backlog = max((uint64_t)MAX_BACKLOG_MS * config.rateHz / 1000, (uint64_t)1);
+    if (due > next + backlog) {
+        const uint64_t skipped = due - backlog - next;
+        vibrationPhase = fmodf(vibrationPhase + TWO_PI_F * config.vibrationHz / config.rateHz * skipped,
+                               TWO_PI_F);
+        stats.skipped += skipped;
+        next += skipped;
+    }
+    
+    // Through the driver like a live reading, for orientation and g-force
+    size_t count = 0;
+    while (next < due && count < maxSamples) {
+        IMUData& sample = samples[count].data;
+        generate(next, sample);
+        imu.inject(sample);
+        imu.fillData(sample, sample.timestamp_ms);
+        
+        // Stamped when it was due, so a late poll shows up as age
+        samples[count].acquired_us = lastUs - (uint32_t)(elapsedUs - next * 1000000 / config.rateHz);
+        next++;
+        count++;
+    }
+    stats.samples += count;
+    return count;
+}
+
+bool SyntheticIMU::isFinished() const {
+    return config.runMs > 0 && next >= (uint64_t)config.runMs * config.rateHz / 1000;
+}
+
+void SyntheticIMU::printStatus() const {
+    DEBUG_PRINTF(3, "Synthetic IMU: %luHz, %lu samples, %lu skipped, %lu impacts\n",
+                 (unsigned long)config.rateHz, (unsigned long)stats.samples,
+                 (unsigned long)stats.skipped, (unsigned long)stats.impacts);
+}
+
+// =============================================================================
+// GPS
+// =============================================================================
+
+// NMEA (d)ddmm.mmmmm for a coordinate's magnitude, as "%0Nd%08.5f" of the
+// degrees and minutes would write it, but in integers so the width is
+// bounded (at most 21 characters)
+static void formatCoordinate(char* out, size_t size, double degrees, int degreeDigits) {
+    uint32_t whole = (uint32_t)degrees;
+    uint32_t minutesE5 = (uint32_t)lround((degrees - whole) * 60.0 * 100000.0);
+    if (minutesE5 >= 60 * 100000UL) {
+        whole++;
+        minutesE5 -= 60 * 100000UL;
+    }
+    snprintf(out, size, "%0*lu%02lu.%05lu", degreeDigits, (unsigned long)whole,
+             (unsigned long)(minutesE5 / 100000), (unsigned long)(minutesE5 % 100000));
+}
+
+SyntheticGPS::SyntheticGPS(GPS& gps, const SyntheticGPSConfig& config)
+    : gps(gps), config(config), random(config.seed) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+void SyntheticGPS::configure(const SyntheticGPSConfig& newConfig) {
+    config = newConfig;
+    random = SyntheticRandom(config.seed);
+    memset(&stats, 0, sizeof(stats));
+    started = false;
+    elapsedUs = 0;
+    next = 0;
+}
+
+size_t SyntheticGPS::writeNMEA(char* buffer, size_t size, const char* body) {
+    uint8_t checksum = 0;
+    for (const char* p = body; *p; p++) {
+        checksum ^= *p;
+    }
+    int length = snprintf(buffer, size, "$%s*%02X\r\n", body, checksum);
+    if (length < 0 || (size_t)length >= size) return 0;
+    
+    // Damage a byte after the checksum is taken. Flipping the low bit
+    // never turns a sentence character into '$', '*' or a line ending.
+    if (random.uniform() < config.corruptRate) {
+        buffer[1 + random.next() % strlen(body)] ^= 0x01;
+        stats.corrupted++;
+    }
+    return length;
+}
+
+size_t SyntheticGPS::writeUBX(uint8_t* buffer, uint32_t timeMs, double lat, double lon,
+                              float speedMs, float heading) {
+    const uint16_t payloadLength = 92;
+    uint8_t* payload = buffer + 6;
+    memset(payload, 0, payloadLength);
+    
+    const int32_t lonE7 = (int32_t)(lon * 1e7);
+    const int32_t latE7 = (int32_t)(lat * 1e7);
+    const int32_t heightMm = 545400;
+    const int32_t speedMmS = (int32_t)(speedMs * 1000.0f);
+    const int32_t headingE5 = (int32_t)(heading * 1e5f);
+    memcpy(payload + 0, &timeMs, 4);        // iTOW
+    payload[20] = 3;                        // fixType: 3D
+    payload[21] = 0x01;                     // gnssFixOK
+    payload[23] = 9;                        // numSV
+    memcpy(payload + 24, &lonE7, 4);
+    memcpy(payload + 28, &latE7, 4);
+    memcpy(payload + 32, &heightMm, 4);
+    memcpy(payload + 60, &speedMmS, 4);     // gSpeed
+    memcpy(payload + 64, &headingE5, 4);    // headMot
+    
+    buffer[0] = 0xB5;
+    buffer[1] = 0x62;
+    buffer[2] = 0x01;                       // NAV
+    buffer[3] = 0x07;                       // PVT
+    buffer[4] = payloadLength & 0xFF;
+    buffer[5] = payloadLength >> 8;
+    
+    // 8-bit Fletcher over class, id, length and payload
+    uint8_t a = 0, b = 0;
+    for (size_t i = 2; i < 6u + payloadLength; i++) {
+        a += buffer[i];
+        b += a;
+    }
+    buffer[6 + payloadLength] = a;
+    buffer[7 + payloadLength] = b;
+    return 8 + payloadLength;
+}
+
+size_t SyntheticGPS::generate(uint64_t index) {
+    const uint32_t timeMs = (uint32_t)(index * 1000 / config.rateHz);
+    
+    // Outages close each period, so a run starts with a fix
+    if (config.outageEveryMs > 0 && config.outageMs > 0 &&
+        timeMs % config.outageEveryMs >= config.outageEveryMs - min(config.outageMs, config.outageEveryMs)) {
+        stats.dropped++;
+        return 0;
+    }
+    if (random.uniform() < config.dropoutRate) {
+        stats.dropped++;
+        return 0;
+    }
+    
+    // Lapping a circle, anticlockwise from due east of the centre
+    const float speedMs = config.speedKmh / 3.6f;
+    const float angle = fmodf(speedMs / config.radiusM * (timeMs / 1000.0f), TWO_PI_F);
+    const double north = config.radiusM * sinf(angle) + config.noiseM * random.gaussian();
+    const double east = config.radiusM * cosf(angle) + config.noiseM * random.gaussian();
+    const double lat = config.latitude + north / METRES_PER_DEGREE;
+    const double lon = config.longitude + east / (METRES_PER_DEGREE * cos(config.latitude * DEG_TO_RAD));
+    float heading = 360.0f - angle * RAD_TO_DEG;
+    if (heading >= 360.0f) heading -= 360.0f;
+    
+    // Time of day from noon; NMEA coordinates are (d)ddmm.mmmmm
+    const uint32_t dayMs = 12 * 3600000UL + timeMs % (12 * 3600000UL);
+    char time[16];
+    snprintf(time, sizeof(time), "%02lu%02lu%05.2f", dayMs / 3600000UL, dayMs / 60000UL % 60,
+             (dayMs % 60000UL) / 1000.0f);
+    const double absLat = fabs(lat);
+    const double absLon = fabs(lon);
+    char latitude[24];
+    char longitude[24];
+    formatCoordinate(latitude, sizeof(latitude), absLat, 2);
+    formatCoordinate(longitude, sizeof(longitude), absLon, 3);
+    const char ns = lat < 0 ? 'S' : 'N';
+    const char ew = lon < 0 ? 'W' : 'E';
+    
+    size_t length = 0;
+    if (config.ubx) {
+        length += writeUBX(stream, timeMs, lat, lon, speedMs, heading);
+    }
+    
+    char body[112];
+    snprintf(body, sizeof(body), "GPGGA,%s,%s,%c,%s,%c,1,09,0.9,545.4,M,46.9,M,,",
+             time, latitude, ns, longitude, ew);
+    length += writeNMEA((char*)stream + length, sizeof(stream) - length, body);
+    snprintf(body, sizeof(body), "GPRMC,%s,A,%s,%c,%s,%c,%05.1f,%05.1f,160826,,,A",
+             time, latitude, ns, longitude, ew, config.speedKmh / 1.852f, heading);
+    length += writeNMEA((char*)stream + length, sizeof(stream) - length, body);
+    return length;
+}
+
+bool SyntheticGPS::poll(StampedGPS& fix) {
+    if (config.rateHz == 0) return false;
+    advanceClock(started, startMs, lastUs, elapsedUs);
+    
+    const uint64_t due = dueCount(elapsedUs, config.rateHz, config.runMs);
+    const uint64_t backlog = max((uint64_t)MAX_BACKLOG_MS * config.rateHz / 1000, (uint64_t)1);
+    if (due > next + backlog) {
+        stats.dropped += due - backlog - next;
+        next = due - backlog;
+    }
+    if (next >= due) {
+        return false;
+    }
+    
+    // A lost epoch leaves the parser's last fix, as a silent receiver would
+    const uint64_t index = next++;
+    const size_t length = generate(index);
+    gps.feed(stream, length);
+    gps.fillData(fix.data, startMs + (uint32_t)(index * 1000 / config.rateHz));
+    fix.acquired_us = lastUs - (uint32_t)(elapsedUs - index * 1000000 / config.rateHz);
+    stats.bytes += length;
+    stats.epochs++;
+    return true;
+}
+
+bool SyntheticGPS::isFinished() const {
+    return config.runMs > 0 && next >= (uint64_t)config.runMs * config.rateHz / 1000;
+}
+
+void SyntheticGPS::printStatus() const {
+    DEBUG_PRINTF(3, "Synthetic GPS: %luHz, %lu epochs, %lu dropped, %lu corrupted, %luB; "
+                 "parser %lu sentences (%.1f%% valid)\n",
+                 (unsigned long)config.rateHz, (unsigned long)stats.epochs,
+                 (unsigned long)stats.dropped, (unsigned long)stats.corrupted,
+                 (unsigned long)stats.bytes, (unsigned long)gps.getSentenceCount(),
+                 gps.getParseSuccessRate());
+}
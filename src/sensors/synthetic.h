@@ -0,0 +1,170 @@
+/**
+ * Synthetic Sensors
+ *
+ * Generators standing in for the IMU and GPS, to load the rings, the
+ * alert manager and the logger well past what the real sensors deliver,
+ * on a bench board or on the host.
+ *
+ * SyntheticIMU produces samples on an exact schedule at any rate (1kHz by
+ * default): gravity plus road vibration and noise, with periodic impacts
+ * (half-sine pulses on Z with a roll kick, like landing off a crest).
+ * Samples a slow sensorTask pass could not take are skipped, not bunched
+ * up, and counted.
+ *
+ * SyntheticGPS writes the byte stream a receiver would (GGA + RMC, and
+ * optionally a UBX NAV-PVT frame the NMEA parser has to step over) for a
+ * car lapping a circle, at 25Hz by default, and feeds it to GPS::feed().
+ * Positions carry noise; epochs are lost at random and in periodic
+ * outages, and sentences are corrupted so the checksum rejects them.
+ *
+ * Both use their own seeded generator, so a run can be repeated exactly.
+ * Their clocks start at the first poll.
+ */
+
+#pragma once
+
+#include "source.h"
+
+enum class SyntheticProfile : uint8_t {
+    STILL = 0,        // Gravity and sensor noise only
+    VIBRATION = 1,    // Plus engine and road vibration
+    IMPACTS = 2,      // Plus a hard landing every few seconds
+    STAGE = 3         // Vibration and impacts
+};
+
+struct SyntheticIMUConfig {
+    uint32_t rateHz = SYNTHETIC_IMU_RATE_HZ;
+    uint32_t runMs = 0;               // 0 = endless
+    float noiseG = 0.02f;             // Per-axis white noise (1 sigma)
+    float vibrationHz = 0.0f;
+    float vibrationG = 0.0f;          // Peak
+    float impactG = 0.0f;             // Peak on Z, 0 = none
+    uint32_t impactMs = 300;          // Landing and suspension compression
+    uint32_t impactEveryMs = 4000;
+    uint32_t seed = 1;
+    
+    static SyntheticIMUConfig forProfile(SyntheticProfile profile);
+};
+
+struct SyntheticGPSConfig {
+    uint32_t rateHz = SYNTHETIC_GPS_RATE_HZ;
+    uint32_t runMs = 0;               // 0 = endless
+    double latitude = 48.1173;        // Centre of the lap
+    double longitude = 11.5167;
+    float radiusM = 300.0f;
+    float speedKmh = 90.0f;
+    float noiseM = 1.5f;              // Position noise (1 sigma)
+    float dropoutRate = 0.02f;        // Epochs lost at random
+    float corruptRate = 0.01f;        // Sentences with a damaged byte
+    uint32_t outageMs = 3000;         // No output at all for this long...
+    uint32_t outageEveryMs = 60000;   // ...this often (0 = never)
+    bool ubx = true;                  // Interleave UBX NAV-PVT frames
+    uint32_t seed = 2;
+};
+
+struct SyntheticIMUStats {
+    uint32_t samples;         // Handed to sensorTask
+    uint32_t skipped;         // Fell due while sensorTask was busy
+    uint32_t impacts;
+};
+
+struct SyntheticGPSStats {
+    uint32_t epochs;          // Fixes handed to sensorTask
+    uint32_t dropped;         // Epochs with no output (dropouts, outages, late)
+    uint32_t corrupted;       // Sentences sent with a damaged byte
+    uint32_t bytes;           // Fed to the parser
+};
+
+// Small, fast and repeatable (xorshift32)
+class SyntheticRandom {
+private:
+    uint32_t state;
+    
+public:
+    explicit SyntheticRandom(uint32_t seed) : state(seed ? seed : 1) {}
+    
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    
+    // [0, 1)
+    float uniform() { return (next() >> 8) * (1.0f / 16777216.0f); }
+    
+    // Roughly normal, mean 0, sigma 1 (sum of four uniforms)
+    float gaussian() {
+        return (uniform() + uniform() + uniform() + uniform() - 2.0f) * 1.7320508f;
+    }
+};
+
+class SyntheticIMU : public IIMUSource {
+public:
+    // Samples further behind than this are skipped
+    static constexpr uint32_t MAX_BACKLOG_MS = 100;
+    
+private:
+    IMU& imu;
+    SyntheticIMUConfig config;
+    SyntheticRandom random;
+    SyntheticIMUStats stats;
+    
+    bool started = false;
+    uint32_t startMs = 0;
+    uint32_t lastUs = 0;
+    uint64_t elapsedUs = 0;
+    uint64_t next = 0;            // Index of the next sample
+    float vibrationPhase = 0.0f;
+    
+    void generate(uint64_t index, IMUData& sample);
+    
+public:
+    explicit SyntheticIMU(IMU& imu, const SyntheticIMUConfig& config = SyntheticIMUConfig());
+    
+    void configure(const SyntheticIMUConfig& newConfig);
+    const SyntheticIMUConfig& getConfig() const { return config; }
+    
+    size_t poll(StampedIMU* samples, size_t maxSamples) override;
+    bool isFinished() const override;
+    uint32_t getPeriodUs() const override { return config.rateHz > 0 ? 1000000 / config.rateHz : 0; }
+    void printStatus() const override;
+    
+    SyntheticIMUStats getStats() const { return stats; }
+};
+
+class SyntheticGPS : public IGPSSource {
+public:
+    static constexpr uint32_t MAX_BACKLOG_MS = 200;
+    
+private:
+    GPS& gps;
+    SyntheticGPSConfig config;
+    SyntheticRandom random;
+    SyntheticGPSStats stats;
+    
+    bool started = false;
+    uint32_t startMs = 0;
+    uint32_t lastUs = 0;
+    uint64_t elapsedUs = 0;
+    uint64_t next = 0;            // Index of the next epoch
+    
+    uint8_t stream[512];          // One epoch of receiver output
+    
+    size_t writeNMEA(char* buffer, size_t size, const char* body);
+    size_t writeUBX(uint8_t* buffer, uint32_t timeMs, double lat, double lon,
+                    float speedMs, float heading);
+    size_t generate(uint64_t index);
+    
+public:
+    explicit SyntheticGPS(GPS& gps, const SyntheticGPSConfig& config = SyntheticGPSConfig());
+    
+    void configure(const SyntheticGPSConfig& newConfig);
+    const SyntheticGPSConfig& getConfig() const { return config; }
+    
+    bool poll(StampedGPS& fix) override;
+    bool isFinished() const override;
+    void printStatus() const override;
+    
+    SyntheticGPSStats getStats() const { return stats; }
+};
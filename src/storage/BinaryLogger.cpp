@@ -1,224 +1,854 @@
 #include "BinaryLogger.h"
+#include "LogReader.h"
+#include "CsvExporter.h"
+#include "../utils/Crc.h"
+#include <unistd.h>
 
-// CRC32 lookup table
-const uint32_t BinaryLogger::crc32Table[256] = {
-    0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f,
-    0xe963a535, 0x9e6495a3, 0x0edb8832, 0x79dcb8a4, 0xe0d5e91e, 0x97d2d988,
-    0x09b64c2b, 0x7eb17cbd, 0xe7b82d07, 0x90bf1d91, 0x1db71064, 0x6ab020f2,
-    0xf3b97148, 0x84be41de, 0x1adad47d, 0x6ddde4eb, 0xf4d4b551, 0x83d385c7,
-    0x136c9856, 0x646ba8c0, 0xfd62f97a, 0x8a65c9ec, 0x14015c4f, 0x63066cd9,
-    0xfa0f3d63, 0x8d080df5, 0x3b6e20c8, 0x4c69105e, 0xd56041e4, 0xa2677172,
-    0x3c03e4d1, 0x4b04d447, 0xd20d85fd, 0xa50ab56b, 0x35b5a8fa, 0x42b2986c,
-    0xdbbbc9d6, 0xacbcf940, 0x32d86ce3, 0x45df5c75, 0xdcd60dcf, 0xabd13d59,
-    0x26d930ac, 0x51de003a, 0xc8d75180, 0xbfd06116, 0x21b4f4b5, 0x56b3c423,
-    0xcfba9599, 0xb8bda50f, 0x2802b89e, 0x5f058808, 0xc60cd9b2, 0xb10be924,
-    0x2f6f7c87, 0x58684c11, 0xc1611dab, 0xb6662d3d, 0x76dc4190, 0x01db7106,
-    0x98d220bc, 0xefd5102a, 0x71b18589, 0x06b6b51f, 0x9fbfe4a5, 0xe8b8d433,
-    0x7807c9a2, 0x0f00f934, 0x9609a88e, 0xe10e9818, 0x7f6a0dbb, 0x086d3d2d,
-    0x91646c97, 0xe6635c01, 0x6b6b51f4, 0x1c6c6162, 0x856530d8, 0xf262004e,
-    0x6c0695ed, 0x1b01a57b, 0x8208f4c1, 0xf50fc457, 0x65b0d9c6, 0x12b7e950,
-    0x8bbeb8ea, 0xfcb9887c, 0x62dd1ddf, 0x15da2d49, 0x8cd37cf3, 0xfbd44c65,
-    0x4db26158, 0x3ab551ce, 0xa3bc0074, 0xd4bb30e2, 0x4adfa541, 0x3dd895d7,
-    0xa4d1c46d, 0xd3d6f4fb, 0x4369e96a, 0x346ed9fc, 0xad678846, 0xda60b8d0,
-    0x44042d73, 0x33031de5, 0xaa0a4c5f, 0xdd0d7cc9, 0x5005713c, 0x270241aa,
-    0xbe0b1010, 0xc90c2086, 0x5768b525, 0x206f85b3, 0xb966d409, 0xce61e49f,
-    0x5edef90e, 0x29d9c998, 0xb0d09822, 0xc7d7a8b4, 0x59b33d17, 0x2eb40d81,
-    0xb7bd5c3b, 0xc0ba6cad, 0xedb88320, 0x9abfb3b6, 0x03b6e20c, 0x74b1d29a,
-    0xead54739, 0x9dd277af, 0x04db2615, 0x73dc1683, 0xe3630b12, 0x94643b84,
-    0x0d6d6a3e, 0x7a6a5aa8, 0xe40ecf0b, 0x9309ff9d, 0x0a00ae27, 0x7d079eb1,
-    0xf00f9344, 0x8708a3d2, 0x1e01f268, 0x6906c2fe, 0xf762575d, 0x806567cb,
-    0x196c3671, 0x6e6b06e7, 0xfed41b76, 0x89d32be0, 0x10da7a5a, 0x67dd4acc,
-    0xf9b9df6f, 0x8ebeeff9, 0x17b7be43, 0x60b08ed5, 0xd6d6a3e8, 0xa1d1937e,
-    0x38d8c2c4, 0x4fdff252, 0xd1bb67f1, 0xa6bc5767, 0x3fb506dd, 0x48b2364b,
-    0xd80d2bda, 0xaf0a1b4c, 0x36034af6, 0x41047a60, 0xdf60efc3, 0xa867df55,
-    0x316e8eef, 0x4669be79, 0xcb61b38c, 0xbc66831a, 0x256fd2a0, 0x5268e236,
-    0xcc0c7795, 0xbb0b4703, 0x220216b9, 0x5505262f, 0xc5ba3bbe, 0xb2bd0b28,
-    0x2bb45a92, 0x5cb36a04, 0xc2d7ffa7, 0xb5d0cf31, 0x2cd99e8b, 0x5bdeae1d,
-    0x9b64c2b0, 0xec63f226, 0x756aa39c, 0x026d930a, 0x9c0906a9, 0xeb0e363f,
-    0x72076785, 0x05005713, 0x95bf4a82, 0xe2b87a14, 0x7bb12bae, 0x0cb61b38,
-    0x92d28e9b, 0xe5d5be0d, 0x7cdcefb7, 0x0bdbdf21, 0x86d3d2d4, 0xf1d4e242,
-    0x68ddb3f8, 0x1fda836e, 0x81be16cd, 0xf6b9265b, 0x6fb077e1, 0x18b74777,
-    0x88085ae6, 0xff0f6a70, 0x66063bca, 0x11010b5c, 0x8f659eff, 0xf862ae69,
-    0x616bffd3, 0x166ccf45, 0xa00ae278, 0xd70dd2ee, 0x4e048354, 0x3903b3c2,
-    0xa7672661, 0xd06016f7, 0x4969474d, 0x3e6e77db, 0xaed16a4a, 0xd9d65adc,
-    0x40df0b66, 0x37d83bf0, 0xa9bcae53, 0xdebb9ec5, 0x47b2cf7f, 0x30b5ffe9,
-    0xbdbdf21c, 0xcabac28a, 0x53b39330, 0x24b4a3a6, 0xbad03605, 0xcdd70693,
-    0x54de5729, 0x23d967bf, 0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94,
-    0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
-};
+// Streams new files are written with
+static constexpr uint16_t FILE_STREAMS =
+    (1 << LOG_STREAM_PACKETS) | (LOG_RAW_IMU ? 1 << LOG_STREAM_IMU : 0);
 
 BinaryLogger::BinaryLogger() {
+    memset(&stats, 0, sizeof(stats));
+    for (StreamBuffers& s : streams) {
+        s.active = s.buffer[0];
+        s.flushPtr = nullptr;
+        s.count = s.bytes = 0;
+        s.flushCount = s.flushBytes = 0;
+        s.first = s.last = s.flushFirst = s.flushLast = 0;
+        s.handed = s.flushOrder = s.written = s.syncMark = 0;
+    }
+    streams[LOG_STREAM_PACKETS].maxRecord = LOG_MAX_RECORD_SIZE;
+    streams[LOG_STREAM_IMU].maxRecord = LOG_MAX_SAMPLE_SIZE;
     bufferMutex = xSemaphoreCreateMutex();
     statsMutex = xSemaphoreCreateMutex();
+    writerWake = xSemaphoreCreateBinary();
+    syncDone = xSemaphoreCreateBinary();
 }
 
 BinaryLogger::~BinaryLogger() {
     end();
     if (bufferMutex) vSemaphoreDelete(bufferMutex);
     if (statsMutex) vSemaphoreDelete(statsMutex);
+    if (writerWake) vSemaphoreDelete(writerWake);
+    if (syncDone) vSemaphoreDelete(syncDone);
 }
 
 bool BinaryLogger::begin() {
     SPI.begin(SD_SCK_PIN, SD_MISO_PIN, SD_MOSI_PIN, SD_CS_PIN);
     
-    if (!SD.begin(SD_CS_PIN)) {
+    if (!SD.begin(SD_CS_PIN, SPI, SD_SPI_FREQUENCY, SD_MOUNT_POINT)) {
         DEBUG_PRINTLN(1, "SD card initialization failed!");
         return false;
     }
     
     DEBUG_PRINTLN(3, "SD card initialized");
     
-    // Find next available file number
-    fileIndex = 0;
-    for (uint8_t i = 0; i < MAX_LOG_FILES; i++) {
-        char filename[32];
-        snprintf(filename, sizeof(filename), "%s_%03d%s", LOG_FILE_BASE, i, LOG_EXT);
-        if (!SD.exists(filename)) {
-            fileIndex = i;
-            break;
+    // Pick up where the last session stopped: resume its file if it was
+    // cut off by a reset, otherwise start a new one in the oldest slot. A
+    // newest file without blocks was only prepared; the one before it is
+    // the last session's.
+    scanLogFiles();
+    
+    // The only time the card's usage is read; from here on it is tracked
+    if (!storage.refresh()) {
+        DEBUG_PRINTLN(2, "Could not read SD card usage");
+    }
+    
+    uint16_t newest = catalog.newest();
+    if (newest < MAX_LOG_FILES && dropUnusedFile(newest)) {
+        newest = catalog.newest();
+    }
+    bool resumed = false;
+#if LOG_RESUME_ON_BOOT
+    if (newest < MAX_LOG_FILES) {
+        resumed = resumeFile(newest);
+    }
+#endif
+    if (!resumed && !openNewFile()) {
+        return false;
+    }
+    
+    // All SD writes from here on happen in the writer task
+    if (!writerRunning.load()) {
+        writerStop.store(false);
+        writerRunning.store(true);
+        if (xTaskCreatePinnedToCore(writerTaskEntry, "SDWriter", STACK_SIZE_SD_WRITER, this,
+                                    TASK_PRIORITY_SD_WRITER, &writerTask, CORE_SD_WRITER) != pdPASS) {
+            DEBUG_PRINTLN(1, "Failed to start SD writer task!");
+            writerRunning.store(false);
+            return false;
         }
     }
     
-    return openNewFile();
+    return true;
 }
 
 void BinaryLogger::end() {
-    flush();
-    if (fileOpen) {
-        currentFile.close();
-        fileOpen = false;
+    // Drain everything to the card, then stop the writer
+    if (writerRunning.load()) {
+        sync();
+        writerStop.store(true);
+        xSemaphoreGive(writerWake);
+        while (writerRunning.load()) {
+            vTaskDelay(1);
+        }
+        writerTask = nullptr;
     }
+    
+    closeFile();
+    discardNextFile();
+    catalog.close();
     SD.end();
 }
 
-bool BinaryLogger::openNewFile() {
-    if (fileOpen) {
-        currentFile.close();
+// Load the catalog, or rebuild it from the log files if it is missing or
+// damaged (a new card, or power lost mid-update)
+void BinaryLogger::scanLogFiles() {
+    if (!catalog.load()) {
+        DEBUG_PRINTLN(2, "Rebuilding log catalog");
+        for (uint16_t i = 0; i < MAX_LOG_FILES; i++) {
+            catalog.rescan(i);
+        }
+        if (!catalog.save()) {
+            DEBUG_PRINTLN(1, "Could not write log catalog!");
+        }
     }
     
-    snprintf(currentFilename, sizeof(currentFilename), "%s_%03d%s", 
-             LOG_FILE_BASE, fileIndex, LOG_EXT);
+    nextSequence = 1;
+    for (uint16_t i = 0; i < MAX_LOG_FILES; i++) {
+        const LogCatalogEntry entry = catalog.get(i);
+        if (entry.used) {
+            nextSequence = max(nextSequence, entry.sequence + 1);
+        }
+    }
+}
+
+// Slot for the next file: a free one, else the oldest (which is deleted)
+uint16_t BinaryLogger::claimSlot() {
+    for (uint16_t i = 0; i < MAX_LOG_FILES; i++) {
+        if (!catalog.get(i).used) {
+            return i;
+        }
+    }
     
-    currentFile = SD.open(currentFilename, FILE_WRITE);
-    if (!currentFile) {
+    const uint16_t oldest = catalog.oldest(fileOpen ? fileIndex : MAX_LOG_FILES,
+                                           nextOpen ? nextIndex : MAX_LOG_FILES);
+    removeSlot(oldest);
+    return oldest;
+}
+
+// Delete a slot's file and its catalog entry
+void BinaryLogger::removeSlot(uint16_t slot) {
+    char filename[32];
+    LogCatalog::slotFilename(slot, filename, sizeof(filename));
+    
+    // The catalog only knows the size of closed files
+    uint32_t size = 0;
+    File file = SD.open(filename, FILE_READ);
+    if (file) {
+        size = file.size();
+        file.close();
+    }
+    if (SD.remove(filename)) {
+        storage.released(size);
+    }
+    catalog.clear(slot);
+    catalog.saveEntry(slot);
+}
+
+// Reopen a log that was never closed and position after its last intact
+// block. A log that is full or in another format is sealed instead.
+bool BinaryLogger::resumeFile(uint16_t slot) {
+    char filename[32];
+    LogCatalog::slotFilename(slot, filename, sizeof(filename));
+    File file = SD.open(filename, "r+");
+    if (!file) return false;
+    
+    LogReader reader;
+    if (!reader.begin(file) || reader.hasIndex() || reader.isLegacy()) {
+        file.close();
+        return false;
+    }
+    
+    const LogFileHeader header = reader.getHeader();
+    const uint32_t blocks = reader.findEnd();
+    const uint32_t dataEnd = reader.getBlockOffset(blocks);
+    
+    // Normally still preallocated from before the reset, to its own limit.
+    // If not, it may only grow as far as a new file could above the low
+    // watermark; without that room it is sealed like a full one.
+    const uint32_t needed = dataEnd + LOG_BLOCK_SIZE + LOG_INDEX_MAX_BYTES;
+    uint32_t extension = 0;
+    if (needed > file.size() && needed <= MAX_LOG_SIZE_BYTES) {
+        extension = storage.fileSize(MAX_LOG_SIZE_BYTES - file.size());
+    }
+    if (header.version != LOG_FORMAT_VERSION || header.streams != FILE_STREAMS ||
+        header.blockSectors != LOG_BLOCK_SIZE / LOG_SECTOR_SIZE ||
+        needed > MAX_LOG_SIZE_BYTES || needed > file.size() + extension) {
+        sealFile(file, filename, header, blocks);
+        catalog.rescan(slot);
+        catalog.saveEntry(slot);
+        return false;
+    }
+    
+    index->rebuild(file, blocks);
+    
+    fileLimit = file.size();
+    if (extension > 0) {
+        fileLimit += extension;
+        file.seek(fileLimit - 1);
+        file.write((uint8_t)0);
+        storage.allocated(extension);
+    }
+    file.seek(dataEnd);
+    
+    currentFile = file;
+    strncpy(currentFilename, filename, sizeof(currentFilename));
+    fileIndex = slot;
+    blockIndex = blocks;
+    blockCrcSeed = logCrcSeed(header);
+    fileOpen = true;
+    stats.currentFileIndex = slot;
+    stats.currentFileSize = dataEnd;
+    
+    // Blocks written after the last saved entry are not in its packet
+    // count; the size comes from the file itself
+    LogCatalogEntry entry = catalog.get(slot);
+    entry.sizeBytes = dataEnd;
+    catalog.set(slot, entry);
+    catalog.saveEntry(slot);
+    
+    DEBUG_PRINTF(3, "Resumed log file: %s at block %u\n", currentFilename, (unsigned)blocks);
+    return true;
+}
+
+// Append the time index after the given blocks and trim the rest. Closes
+// the file.
+bool BinaryLogger::sealFile(File& file, const char* filename, const LogFileHeader& header,
+                            uint32_t blocks) {
+    const uint32_t dataEnd = LOG_SECTOR_SIZE + blocks * header.blockSectors * LOG_SECTOR_SIZE;
+    
+    // Too big for the stack of most callers
+    LogIndex* rebuilt = new LogIndex();
+    size_t indexBytes = 0;
+    if (rebuilt->rebuild(file, blocks)) {
+        indexBytes = rebuilt->writeTo(file, dataEnd, logCrcSeed(header));
+    }
+    delete rebuilt;
+    const uint32_t oldSize = file.size();
+    file.close();
+    
+    if (indexBytes == 0) {
+        return false;
+    }
+    
+    char path[64];
+    snprintf(path, sizeof(path), "%s%s", SD_MOUNT_POINT, filename);
+    if (truncate(path, dataEnd + indexBytes) != 0) {
+        return false;
+    }
+    if (oldSize > dataEnd + indexBytes) {
+        storage.released(oldSize - dataEnd - indexBytes);
+    }
+    return true;
+}
+
+// Start writing to a new file straight away: at boot, or when a rotation
+// comes before the next file is ready. The new file is swapped in before
+// the old one is finished, so there is always a file to write to; if none
+// can be made, the old one is closed and logging stops until one can.
+bool BinaryLogger::openNewFile() {
+    if (!prepareNextFile(true)) {
         DEBUG_PRINTLN(1, "Failed to create log file!");
-        fileOpen = false;
+        closeFile();
         return false;
     }
+    if (!fileOpen) {
+        switchToNextFile();
+        return true;
+    }
     
-    // Write file header
-    LogFileHeader header;
-    header.magic = 'RLOG';
-    header.version = 1;
-    header.createdTime = millis() / 1000;  // Simplified timestamp
-    header.packetSize = sizeof(TelemetryPacket);
-    header.reserved = 0;
-    strncpy(header.vehicleId, vehicleId, 16);
-    strncpy(header.driverName, driverName, 16);
-    header.crc32 = calculateCRC32(&header, sizeof(header) - 4);
+    File oldFile = currentFile;
+    char oldFilename[32];
+    memcpy(oldFilename, currentFilename, sizeof(oldFilename));
+    const uint16_t oldSlot = fileIndex;
+    const uint32_t oldEnd = stats.currentFileSize;
+    const uint32_t oldLimit = fileLimit;
+    const uint32_t oldSeed = blockCrcSeed;
+    const LogIndex* oldIndex = index;
+    
+    switchToNextFile();
+    finishFile(oldFile, oldFilename, oldSlot, oldEnd, oldLimit, oldSeed, *oldIndex);
+    return true;
+}
+
+// Writer task (or begin()) only. Prepares the next file a step per call:
+// first delete old logs while space is short, then claim its slot and
+// write its header, then preallocate LOG_PREALLOCATE_STEP_BYTES at a time.
+// With finish set, it runs to the end. Returns true once the file is
+// ready.
+bool BinaryLogger::prepareNextFile(bool finish) {
+    if (!nextOpen) {
+        while (storage.needsReclaim(MAX_LOG_SIZE_BYTES) && deleteOldestFile()) {
+            if (!finish) {
+                return false;
+            }
+        }
+        
+        // Whatever is left if that did not free enough. Below the smallest
+        // useful file, keep deleting; with nothing left to delete, no file
+        // is made (and logging stops) rather than eat into the watermark.
+        nextLimit = storage.fileSize(MAX_LOG_SIZE_BYTES);
+        while (nextLimit == 0) {
+            if (!deleteOldestFile()) {
+                DEBUG_PRINTLN(1, "SD card full: no room for another log");
+                return false;
+            }
+            if (!finish) {
+                return false;
+            }
+            nextLimit = storage.fileSize(MAX_LOG_SIZE_BYTES);
+        }
+        if (nextLimit < MAX_LOG_SIZE_BYTES) {
+            DEBUG_PRINTF(2, "SD card nearly full: next log limited to %u MB\n",
+                         (unsigned)(nextLimit / (1024 * 1024)));
+        }
+        
+        nextIndex = claimSlot();
+        LogCatalog::slotFilename(nextIndex, nextFilename, sizeof(nextFilename));
+        nextFile = SD.open(nextFilename, FILE_WRITE);
+        if (!nextFile) {
+            return false;
+        }
+        
+        // Write file header, padded to a full sector so blocks stay aligned
+        uint8_t sector[LOG_SECTOR_SIZE];
+        memset(sector, 0, sizeof(sector));
+        
+        LogFileHeader& header = nextHeader;
+        memset(&header, 0, sizeof(header));
+        header.magic = LOG_FILE_MAGIC;
+        header.version = LOG_FORMAT_VERSION;
+        header.createdTime = millis() / 1000;  // Simplified timestamp
+        header.packetSize = sizeof(TelemetryPacket);
+        header.blockSectors = LOG_BLOCK_SIZE / LOG_SECTOR_SIZE;
+        strncpy(header.vehicleId, vehicleId, 16);
+        strncpy(header.driverName, driverName, 16);
+        header.crc32 = crc32(&header, offsetof(LogFileHeader, crc32));
+        header.fileSequence = nextSequence++;
+        header.streams = FILE_STREAMS;
+        memcpy(sector, &header, sizeof(header));
+        
+        if (nextFile.write(sector, sizeof(sector)) != sizeof(sector)) {
+            nextFile.close();
+            SD.remove(nextFilename);
+            return false;
+        }
+        
+        nextOpen = true;
+        nextAllocated = LOG_SECTOR_SIZE;
+        storage.allocated(LOG_SECTOR_SIZE);
+        
+        LogCatalogEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.used = 1;
+        entry.sequence = header.fileSequence;
+        entry.createdTime = header.createdTime;
+        entry.sizeBytes = LOG_SECTOR_SIZE;
+        catalog.set(nextIndex, entry);
+        catalog.saveEntry(nextIndex);
+        if (!finish) {
+            return false;
+        }
+    }
     
-    currentFile.write((uint8_t*)&header, sizeof(header));
-    currentFile.flush();
+    // Allocate the whole file up front so block writes never have to
+    // extend the FAT chain; closeFile() trims the unused tail
+    while (nextAllocated < nextLimit) {
+        const uint32_t step = min(LOG_PREALLOCATE_STEP_BYTES, nextLimit - nextAllocated);
+        nextAllocated += step;
+        nextFile.seek(nextAllocated - 1);
+        nextFile.write((uint8_t)0);
+        storage.allocated(step);
+        if (nextAllocated == nextLimit) {
+            nextFile.flush();
+        }
+        if (!finish) {
+            break;
+        }
+    }
+    return nextAllocated == nextLimit;
+}
+
+// Make the prepared file the current one. No SD access beyond a seek.
+void BinaryLogger::switchToNextFile() {
+    nextFile.seek(LOG_SECTOR_SIZE);
+    currentFile = nextFile;
+    nextFile = File();
+    memcpy(currentFilename, nextFilename, sizeof(currentFilename));
+    fileIndex = nextIndex;
+    fileLimit = nextLimit;
+    blockIndex = 0;
+    blockCrcSeed = logCrcSeed(nextHeader);
+    index = (index == &indexes[0]) ? &indexes[1] : &indexes[0];
+    index->reset();
+    nextOpen = false;
+    nextAllocated = 0;
     
     fileOpen = true;
     stats.currentFileIndex = fileIndex;
-    stats.currentFileSize = sizeof(header);
+    stats.currentFileSize = LOG_SECTOR_SIZE;
     
     DEBUG_PRINTF(3, "Opened log file: %s\n", currentFilename);
+}
+
+// Remove a prepared file that was never switched to
+void BinaryLogger::discardNextFile() {
+    if (!nextOpen) return;
+    
+    nextFile.close();
+    removeSlot(nextIndex);
+    nextOpen = false;
+    nextAllocated = 0;
+}
+
+// Remove a log that never got a block, as left by a reset while the next
+// file was prepared
+bool BinaryLogger::dropUnusedFile(uint16_t slot) {
+    char filename[32];
+    LogCatalog::slotFilename(slot, filename, sizeof(filename));
+    File file = SD.open(filename, FILE_READ);
+    if (!file) return false;
+    
+    LogReader reader;
+    const bool unused = reader.begin(file) && !reader.hasIndex() && reader.findEnd() == 0;
+    file.close();
+    if (!unused) {
+        return false;
+    }
     
+    removeSlot(slot);
     return true;
 }
 
-bool BinaryLogger::rotateFile() {
-    fileIndex = (fileIndex + 1) % MAX_LOG_FILES;
+void BinaryLogger::closeFile() {
+    if (!fileOpen) return;
     
-    // Delete file if it exists (circular buffer behavior)
-    char filename[32];
-    snprintf(filename, sizeof(filename), "%s_%03d%s", LOG_FILE_BASE, fileIndex, LOG_EXT);
-    if (SD.exists(filename)) {
-        SD.remove(filename);
+    fileOpen = false;
+    finishFile(currentFile, currentFilename, fileIndex, stats.currentFileSize, fileLimit,
+               blockCrcSeed, *index);
+}
+
+// Writer task (or end()) only. Appends the time index after the last block,
+// closes the file, trims its preallocated tail and saves its catalog entry.
+void BinaryLogger::finishFile(File& file, const char* filename, uint16_t slot, uint32_t dataEnd,
+                              uint32_t limit, uint32_t crcSeed, const LogIndex& timeIndex) {
+    size_t indexBytes = timeIndex.writeTo(file, dataEnd, crcSeed);
+    if (indexBytes == 0) {
+        DEBUG_PRINTF(2, "Could not write index for %s\n", filename);
+    }
+    
+    file.close();
+    
+    // Trim the preallocated space that was never written
+    const uint32_t finalSize = dataEnd + indexBytes;
+    char path[64];
+    snprintf(path, sizeof(path), "%s%s", SD_MOUNT_POINT, filename);
+    if (truncate(path, finalSize) != 0) {
+        DEBUG_PRINTF(2, "Could not truncate %s\n", filename);
+    } else if (limit > finalSize) {
+        storage.released(limit - finalSize);
     }
     
-    return openNewFile();
+    LogCatalogEntry entry = catalog.get(slot);
+    entry.sizeBytes = finalSize;
+    catalog.set(slot, entry);
+    catalog.saveEntry(slot);
 }
 
 bool BinaryLogger::write(const TelemetryPacket& packet) {
-    if (!fileOpen) return false;
+    return write(&packet, 1) == 1;
+}
+
+// Caller holds bufferMutex. Hands the stream's active buffer to the writer
+// task if the writer has finished with its other one.
+bool BinaryLogger::swapBuffers(uint16_t stream) {
+    StreamBuffers& s = streams[stream];
+    if (s.flushPtr != nullptr || s.count == 0) {
+        return false;
+    }
+    s.flushPtr = s.active;
+    s.flushCount = s.count;
+    s.flushBytes = s.bytes;
+    s.flushFirst = s.first;
+    s.flushLast = s.last;
+    s.active = (s.active == s.buffer[0]) ? s.buffer[1] : s.buffer[0];
+    s.count = 0;
+    s.bytes = 0;
+    s.handed++;
+    s.flushOrder = swapCount++;
+    if (stream == LOG_STREAM_IMU) {
+        sampleEncoder.reset();
+    } else {
+        encoder.reset();
+    }
+    return true;
+}
+
+// Caller holds bufferMutex. Makes room for one record in the stream's
+// active block; false if both of its blocks are full.
+bool BinaryLogger::makeRoom(uint16_t stream, bool& wake) {
+    if (streams[stream].full()) {
+        if (!swapBuffers(stream)) {
+            return false;  // The card is behind; drop rather than wait
+        }
+        wake = true;
+    }
+    return true;
+}
+
+// Caller holds bufferMutex. Encodes one record into the active block,
+// handing full blocks to the writer; false if both blocks are full.
+bool BinaryLogger::append(const TelemetryPacket& packet, bool& wake) {
+    StreamBuffers& s = streams[LOG_STREAM_PACKETS];
+    if (!makeRoom(LOG_STREAM_PACKETS, wake)) {
+        return false;
+    }
     
-    xSemaphoreTake(bufferMutex, portMAX_DELAY);
+    s.bytes += encoder.encode(packet, s.active + sizeof(LogBlockHeader) + s.bytes);
+    if (s.count++ == 0) {
+        s.first = packet.timestamp_ms;
+    }
+    s.last = packet.timestamp_ms;
     
-    // Check if buffer is full
-    if (bufferCount >= WRITE_BUFFER_SIZE) {
-        xSemaphoreGive(bufferMutex);
-        
-        // Try to flush immediately
-        flush();
-        
-        stats.drops++;
+    // Hand the block over as soon as it is full, while the writer is free
+    if (s.full() && swapBuffers(LOG_STREAM_PACKETS)) {
+        wake = true;
+    }
+    return true;
+}
+
+bool BinaryLogger::append(const IMUData& sample, bool& wake) {
+    StreamBuffers& s = streams[LOG_STREAM_IMU];
+    if (!makeRoom(LOG_STREAM_IMU, wake)) {
         return false;
     }
     
-    // Copy to buffer
-    memcpy(&activeBuffer[bufferCount], &packet, sizeof(TelemetryPacket));
-    bufferCount++;
+    s.bytes += sampleEncoder.encode(sample, s.active + sizeof(LogBlockHeader) + s.bytes);
+    if (s.count++ == 0) {
+        s.first = sample.timestamp_ms;
+    }
+    s.last = sample.timestamp_ms;
+    
+    if (s.full() && swapBuffers(LOG_STREAM_IMU)) {
+        wake = true;
+    }
+    return true;
+}
+
+size_t BinaryLogger::write(const TelemetryPacket* packets, size_t count) {
+    if (packets == nullptr) return 0;
+    
+    size_t written = 0;
+    bool wake = false;
     
+    xSemaphoreTake(bufferMutex, portMAX_DELAY);
+    while (written < count && append(packets[written], wake)) {
+        written++;
+    }
     xSemaphoreGive(bufferMutex);
     
-    // Auto-flush if buffer is full
-    if (bufferCount >= WRITE_BUFFER_SIZE) {
-        flush();
+    finishWrite(LOG_STREAM_PACKETS, written, count, wake);
+    return written;
+}
+
+size_t BinaryLogger::write(const TelemetryPacket* const* packets, size_t count) {
+    if (packets == nullptr) return 0;
+    
+    size_t written = 0;
+    bool wake = false;
+    
+    // Encode straight from the callers' packets
+    xSemaphoreTake(bufferMutex, portMAX_DELAY);
+    while (written < count && append(*packets[written], wake)) {
+        written++;
     }
+    xSemaphoreGive(bufferMutex);
     
-    return true;
+    finishWrite(LOG_STREAM_PACKETS, written, count, wake);
+    return written;
+}
+
+size_t BinaryLogger::write(const IMUData* samples, size_t count) {
+    if (samples == nullptr) return 0;
+    
+    size_t written = 0;
+    bool wake = false;
+    
+    xSemaphoreTake(bufferMutex, portMAX_DELAY);
+    while (written < count && append(samples[written], wake)) {
+        written++;
+    }
+    xSemaphoreGive(bufferMutex);
+    
+    finishWrite(LOG_STREAM_IMU, written, count, wake);
+    return written;
 }
 
-void BinaryLogger::flushWriteBuffer() {
-    if (bufferCount == 0) return;
+size_t BinaryLogger::write(const StampedIMU* samples, size_t count) {
+    if (samples == nullptr) return 0;
+    
+    size_t written = 0;
+    bool wake = false;
     
-    // Write all packets in buffer
-    size_t bytesToWrite = bufferCount * sizeof(TelemetryPacket);
-    size_t written = currentFile.write((uint8_t*)activeBuffer, bytesToWrite);
+    xSemaphoreTake(bufferMutex, portMAX_DELAY);
+    while (written < count && append(samples[written].data, wake)) {
+        written++;
+    }
+    xSemaphoreGive(bufferMutex);
     
+    finishWrite(LOG_STREAM_IMU, written, count, wake);
+    return written;
+}
+
+void BinaryLogger::finishWrite(uint16_t stream, size_t written, size_t count, bool wake) {
+    if (wake) {
+        xSemaphoreGive(writerWake);
+    }
+    if (written < count) {
+        xSemaphoreTake(statsMutex, portMAX_DELAY);
+        if (stream == LOG_STREAM_IMU) {
+            stats.sampleDrops += count - written;
+        } else {
+            stats.drops += count - written;
+        }
+        xSemaphoreGive(statsMutex);
+    }
+}
+
+// Writer task only: frame the stream's handed-over block, seal it with
+// its CRC and write it out whole. Partial blocks (from a sync) are
+// zero-padded so every write stays aligned.
+void BinaryLogger::writeBlock(uint16_t stream) {
+    const StreamBuffers& s = streams[stream];
+    uint8_t* block = s.flushPtr;
+    const size_t count = s.flushCount;
+    const size_t payloadBytes = s.flushBytes;
+    
+    LogBlockHeader header;
+    header.magic = LOG_BLOCK_MAGIC;
+    header.blockIndex = blockIndex;
+    header.packetCount = count;
+    header.stream = stream;
+    header.payloadBytes = payloadBytes;
+    memcpy(block, &header, sizeof(header));
+    
+    const size_t used = sizeof(header) + payloadBytes;
+    memset(block + used, 0, LOG_BLOCK_SIZE - used);
+    
+    const uint32_t crc = crc32Update(blockCrcSeed, block, LOG_BLOCK_SIZE - LOG_BLOCK_CRC_SIZE);
+    memcpy(block + LOG_BLOCK_SIZE - LOG_BLOCK_CRC_SIZE, &crc, sizeof(crc));
+    
+    const size_t bytesToWrite = LOG_BLOCK_SIZE;
+    size_t written = fileOpen ? currentFile.write(block, bytesToWrite) : 0;
+    if (written == bytesToWrite) {
+        index->addBlock(blockIndex, LOG_FORMAT_VERSION, stream, block + sizeof(header), payloadBytes);
+        blockIndex++;
+        
+        // Saved to the card with the next sync
+        LogCatalogEntry entry = catalog.get(fileIndex);
+        if (stream == LOG_STREAM_PACKETS && count > 0) {
+            if (entry.firstTimestamp == 0) {
+                entry.firstTimestamp = s.flushFirst;
+            }
+            entry.lastTimestamp = s.flushLast;
+            entry.packetCount += count;
+        }
+        entry.sizeBytes = stats.currentFileSize + written;
+        catalog.set(fileIndex, entry);
+        catalogDirty = true;
+    }
+    
+    xSemaphoreTake(statsMutex, portMAX_DELAY);
     if (written == bytesToWrite) {
-        stats.packetsWritten += bufferCount;
+        if (stream == LOG_STREAM_IMU) {
+            stats.samplesWritten += count;
+        } else {
+            stats.packetsWritten += count;
+        }
         stats.bytesWritten += written;
         stats.currentFileSize += written;
     } else {
         stats.errorCount++;
-        DEBUG_PRINTLN(1, "SD write error!");
     }
+    xSemaphoreGive(statsMutex);
     
-    bufferCount = 0;
+    if (written != bytesToWrite) {
+        DEBUG_PRINTLN(1, "SD write error!");
+    }
 }
 
-bool BinaryLogger::flush() {
-    if (!fileOpen) return false;
-    
-    xSemaphoreTake(bufferMutex, portMAX_DELAY);
-    
-    flushWriteBuffer();
-    currentFile.flush();
+// Writer task only: rotate if the sync being served asked for it, push
+// everything to the card and publish the sync
+void BinaryLogger::completeSync() {
+    if (syncRotate) {
+        syncRotate = false;
+        openNewFile();
+    }
+    if (fileOpen) {
+        currentFile.flush();
+    }
+    if (catalogDirty) {
+        catalog.saveEntry(fileIndex);
+        catalogDirty = false;
+    }
+    xSemaphoreTake(statsMutex, portMAX_DELAY);
     stats.flushCount++;
+    xSemaphoreGive(statsMutex);
     
-    // Check for rotation
-    if (stats.currentFileSize >= MAX_LOG_SIZE_BYTES) {
+    syncCompletedUs.store(micros(), std::memory_order_relaxed);
+    syncCompleted.store(syncTarget, std::memory_order_release);
+    xSemaphoreGive(syncDone);
+}
+
+// Writer task only: write out every handed-over buffer, completing the
+// sync being served as soon as the blocks it marked are written
+void BinaryLogger::drainBuffers() {
+    while (true) {
+        xSemaphoreTake(bufferMutex, portMAX_DELAY);
+        
+        // Take up the latest request once the last one is done. A request
+        // made while one is served is covered by the next, so writes that
+        // keep arriving cannot hold a sync off.
+        if (syncTarget == syncCompleted.load(std::memory_order_relaxed) &&
+            syncRequested != syncTarget) {
+            syncTarget = syncRequested;
+            for (uint16_t i = 0; i < LOG_STREAM_COUNT; i++) {
+                syncMarks[i] = streams[i].syncMark;
+            }
+            syncRotate = rotateRequested;
+            rotateRequested = false;
+        }
+        bool synced = syncTarget != syncCompleted.load(std::memory_order_relaxed);
+        
+        // Pick up full active buffers, or partial ones holding records the
+        // sync needs, then write the buffer handed over first, so a busy
+        // stream cannot starve the others
+        uint16_t pendingStream = LOG_STREAM_COUNT;
+        for (uint16_t i = 0; i < LOG_STREAM_COUNT; i++) {
+            StreamBuffers& s = streams[i];
+            const bool marked = synced && (int32_t)(s.handed - syncMarks[i]) < 0;
+            if (s.flushPtr == nullptr && (s.full() || marked)) {
+                swapBuffers(i);
+            }
+            if (s.flushPtr != nullptr &&
+                (pendingStream == LOG_STREAM_COUNT ||
+                 (int32_t)(s.flushOrder - streams[pendingStream].flushOrder) < 0)) {
+                pendingStream = i;
+            }
+            if ((int32_t)(s.written - syncMarks[i]) < 0) {
+                synced = false;
+            }
+        }
         xSemaphoreGive(bufferMutex);
-        return rotateFile();
+        
+        // Blocks after the marks go to the new file of a requested rotation
+        if (synced) {
+            completeSync();
+        }
+        
+        // Rotate before a block (and the index after it) would run past
+        // the preallocated space, checked ahead of every block however long
+        // the drain runs. By then the next file is normally ready, prepared
+        // a step per pass while there was time to spare.
+        const bool rotating = rotationDue(0);
+        if (rotating) {
+            openNewFile();
+        }
+        
+        if (pendingStream < LOG_STREAM_COUNT) {
+            writeBlock(pendingStream);
+            
+            xSemaphoreTake(bufferMutex, portMAX_DELAY);
+            streams[pendingStream].flushPtr = nullptr;
+            streams[pendingStream].written++;
+            xSemaphoreGive(bufferMutex);
+            continue;
+        }
+        
+        if (!rotating && fileOpen && rotationDue(LOG_PREPARE_AHEAD_BYTES)) {
+            prepareNextFile(false);
+        }
+        return;
+    }
+}
+
+void BinaryLogger::writerTaskEntry(void* pvParameters) {
+    BinaryLogger* logger = static_cast<BinaryLogger*>(pvParameters);
+    
+    while (!logger->writerStop.load()) {
+        xSemaphoreTake(logger->writerWake, portMAX_DELAY);
+        logger->drainBuffers();
     }
     
+    // Last touch of the logger: end() may destroy it right after this
+    logger->writerRunning.store(false);
+    vTaskDelete(nullptr);
+}
+
+uint32_t BinaryLogger::requestSync() {
+    xSemaphoreTake(bufferMutex, portMAX_DELAY);
+    const uint32_t id = ++syncRequested;
+    for (StreamBuffers& s : streams) {
+        s.syncMark = s.handed + (s.count > 0 ? 1 : 0);
+    }
     xSemaphoreGive(bufferMutex);
+    
+    xSemaphoreGive(writerWake);
+    return id;
+}
+
+uint32_t BinaryLogger::flush() {
+    if (!writerRunning.load()) return 0;
+    
+    return requestSync();
+}
+
+bool BinaryLogger::isFlushed(uint32_t ticket, uint32_t& syncedUs) const {
+    if ((int32_t)(syncCompleted.load(std::memory_order_acquire) - ticket) < 0) {
+        return false;
+    }
+    syncedUs = syncCompletedUs.load(std::memory_order_relaxed);
     return true;
 }
 
-uint32_t BinaryLogger::calculateCRC32(const void* data, size_t length) {
-    const uint8_t* bytes = static_cast<const uint8_t*>(data);
-    uint32_t crc = 0xFFFFFFFF;
+bool BinaryLogger::sync(TickType_t timeoutTicks) {
+    if (!writerRunning.load()) return false;
+    
+    const uint32_t target = requestSync();
+    const TickType_t start = xTaskGetTickCount();
     
-    for (size_t i = 0; i < length; i++) {
-        crc = crc32Table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    while ((int32_t)(syncCompleted.load(std::memory_order_acquire) - target) < 0) {
+        if (timeoutTicks != portMAX_DELAY && xTaskGetTickCount() - start >= timeoutTicks) {
+            return false;
+        }
+        // Another waiter may take the signal first, so recheck periodically
+        xSemaphoreTake(syncDone, pdMS_TO_TICKS(10));
     }
+    return true;
+}
+
+bool BinaryLogger::rotate() {
+    if (!writerRunning.load()) return false;
     
-    return crc ^ 0xFFFFFFFF;
+    xSemaphoreTake(bufferMutex, portMAX_DELAY);
+    rotateRequested = true;
+    xSemaphoreGive(bufferMutex);
+    
+    // Buffered packets still go to the old file first
+    requestSync();
+    return true;
 }
 
 bool BinaryLogger::setVehicleInfo(const char* vehicle, const char* driver) {
@@ -254,44 +884,70 @@ bool BinaryLogger::isHealthy() const {
 }
 
 float BinaryLogger::getBufferUtilization() const {
-    return (float)bufferCount / WRITE_BUFFER_SIZE * 100.0f;
+    size_t bytes = 0;
+    for (const StreamBuffers& s : streams) {
+        bytes = max(bytes, s.bytes);
+    }
+    return (float)bytes / LOG_BLOCK_PAYLOAD * 100.0f;
 }
 
 uint32_t BinaryLogger::getFreeSpaceMB() const {
-    // ESP32 SD library doesn't have a direct free space function
-    // This is a simplified estimation
-    return 0;  // TODO: Implement using fs_stat
-}
-
-uint8_t BinaryLogger::countLogFiles() const {
-    uint8_t count = 0;
-    for (uint8_t i = 0; i < MAX_LOG_FILES; i++) {
-        char filename[32];
-        snprintf(filename, sizeof(filename), "%s_%03d%s", LOG_FILE_BASE, i, LOG_EXT);
-        if (SD.exists(filename)) {
-            count++;
-        }
-    }
-    return count;
+    return storage.getFreeBytes() / (1024 * 1024);
+}
+
+uint16_t BinaryLogger::countLogFiles() const {
+    return catalog.count();
 }
 
 bool BinaryLogger::deleteOldestFile() {
-    // Find oldest file (lowest index that's not current)
-    for (uint8_t i = 0; i < MAX_LOG_FILES; i++) {
-        if (i == fileIndex) continue;
-        
-        char filename[32];
-        snprintf(filename, sizeof(filename), "%s_%03d%s", LOG_FILE_BASE, i, LOG_EXT);
-        if (SD.exists(filename)) {
-            SD.remove(filename);
-            DEBUG_PRINTF(3, "Deleted old log: %s\n", filename);
-            return true;
+    // Oldest by sequence, never the current or the prepared file
+    const uint16_t oldest = catalog.oldest(fileOpen ? fileIndex : MAX_LOG_FILES,
+                                           nextOpen ? nextIndex : MAX_LOG_FILES);
+    if (oldest == MAX_LOG_FILES) {
+        return false;
+    }
+    
+    char filename[32];
+    LogCatalog::slotFilename(oldest, filename, sizeof(filename));
+    removeSlot(oldest);
+    DEBUG_PRINTF(3, "Deleted old log: %s\n", filename);
+    return true;
+}
+
+bool BinaryLogger::rebuildIndex(const char* filename) {
+    if (fileOpen && strcmp(filename, currentFilename) == 0) {
+        return false;
+    }
+    
+    File file = SD.open(filename, "r+");
+    if (!file) return false;
+    
+    // Format 1 logs have no blocks to index
+    LogReader reader;
+    if (!reader.begin(file) || reader.isLegacy()) {
+        file.close();
+        return false;
+    }
+    const LogFileHeader header = reader.getHeader();
+    if (!sealFile(file, filename, header, reader.findEnd())) {
+        return false;
+    }
+    
+    // Its catalog entry still has the preallocated size
+    for (uint16_t i = 0; i < MAX_LOG_FILES; i++) {
+        char slotName[32];
+        LogCatalog::slotFilename(i, slotName, sizeof(slotName));
+        if (strcmp(filename, slotName) == 0) {
+            catalog.rescan(i);
+            catalog.saveEntry(i);
+            break;
         }
     }
-    return false;
+    return true;
 }
 
-bool BinaryLogger::exportToCSV(const char* binFile, const char* csvFile) {
+bool BinaryLogger::exportToCSV(const char* binFile, const char* csvFile,
+                               uint32_t startMs, uint32_t endMs) {
     File bin = SD.open(binFile, FILE_READ);
     if (!bin) return false;
     
@@ -301,35 +957,10 @@ bool BinaryLogger::exportToCSV(const char* binFile, const char* csvFile) {
         return false;
     }
     
-    // Read and verify header
-    LogFileHeader header;
-    if (bin.read((uint8_t*)&header, sizeof(header)) != sizeof(header)) {
-        bin.close();
-        csv.close();
-        return false;
-    }
+    CsvExporter exporter(csv);
+    const bool ok = exporter.exportLog(bin, startMs, endMs);
     
-    // Write CSV header
-    csv.println("Timestamp,AccelX,AccelY,AccelZ,GyroX,GyroY,GyroZ,TempC,"
-                "Latitude,Longitude,Altitude,SpeedKmh,Heading,Satellites,FixQuality");
-    
-    // Read packets
-    TelemetryPacket packet;
-    while (bin.read((uint8_t*)&packet, sizeof(packet)) == sizeof(packet)) {
-        csv.printf("%u,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.2f,",
-                   packet.timestamp_ms,
-                   packet.imu.accel_x, packet.imu.accel_y, packet.imu.accel_z,
-                   packet.imu.gyro_x, packet.imu.gyro_y, packet.imu.gyro_z,
-                   packet.imu.temperature);
-        csv.printf("%.6f,%.6f,%.1f,%.1f,%.1f,%u,%u\n",
-                   packet.gps.latitude, packet.gps.longitude,
-                   packet.gps.altitude, packet.gps.speed_kmh, packet.gps.heading,
-                   packet.gps.satellites, packet.gps.fix_quality);
-    }
-    
-    csv.flush();
     csv.close();
     bin.close();
-    
-    return true;
+    return ok;
 }
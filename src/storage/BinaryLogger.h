@@ -2,60 +2,127 @@
  * High-Performance Binary Data Logger
  * 
  * Features:
- * - Binary format (much smaller than CSV)
- * - Automatic log rotation by size
- * - Double buffering for zero-copy writes
- * - CRC32 checksums for data integrity
- * - Write-ahead indexing for fast seeking
+ * - Binary format (much smaller than CSV), delta/varint coded
+ * - Fixed-size, sector-aligned block writes into preallocated files
+ * - Automatic log rotation by size; the next file is prepared ahead of
+ *   time, so switching to it does not stall the writer
+ * - Ping-pong buffers drained by a dedicated SD writer task, so write()
+ *   never waits for the card
+ * - CRC-32 on every block, so corruption costs one block, not the file
+ * - Time index appended on close, for O(log n) seeking by timestamp
+ * - Catalog of all logs kept in RAM and on the card, so lookups and
+ *   listings never probe the slots
+ * - Retention by free space, tracked as files grow and shrink rather than
+ *   read from the card; the oldest logs go first
+ * - Second stream of raw IMU samples at the full sample rate, in blocks
+ *   of its own beside the fused packets
  */
 
 #pragma once
 
 #include "../core/config.h"
+#include "LogFormat.h"
+#include "LogCodec.h"
+#include "LogIndex.h"
+#include "LogCatalog.h"
+#include "LogStorage.h"
 #include <SD.h>
 #include <SPI.h>
-
-// File header for binary log files
-struct __attribute__((packed)) LogFileHeader {
-    uint32_t magic;           // 'RLOG'
-    uint16_t version;         // File format version
-    uint32_t createdTime;     // Unix timestamp
-    uint16_t packetSize;      // Expected packet size
-    uint16_t reserved;
-    char vehicleId[16];       // Vehicle identifier
-    char driverName[16];      // Driver name
-    uint32_t crc32;           // Header checksum
-};
+#include <atomic>
 
 // File statistics
 struct LogStats {
     uint32_t packetsWritten;
+    uint32_t samplesWritten;  // Raw IMU samples
     uint32_t bytesWritten;
     uint32_t flushCount;
     uint32_t errorCount;
     uint32_t drops;           // Packets dropped due to full buffer
-    uint32_t currentFileSize;
-    uint8_t currentFileIndex;
+    uint32_t sampleDrops;     // Raw IMU samples dropped the same way
+    uint32_t currentFileSize; // Bytes of real data (the file itself is preallocated)
+    uint16_t currentFileIndex;
 };
 
 class BinaryLogger {
 private:
     File currentFile;
-    bool fileOpen = false;
-    
-    // Double buffer for batch writes
-    static const size_t WRITE_BUFFER_SIZE = 16;  // 16 packets = ~1KB
-    TelemetryPacket writeBuffer1[WRITE_BUFFER_SIZE];
-    TelemetryPacket writeBuffer2[WRITE_BUFFER_SIZE];
-    TelemetryPacket* activeBuffer = writeBuffer1;
-    TelemetryPacket* flushBufferPtr = nullptr;
-    size_t bufferCount = 0;
+    volatile bool fileOpen = false;      // Writer side only; write() buffers regardless
+    
+    // Ping-pong block buffers, one pair per stream: write() fills the
+    // active one while the writer task drains the other. bufferMutex only
+    // guards encoding and the swap, never SD I/O. Records are encoded
+    // straight in behind the block header.
+    struct StreamBuffers {
+        uint8_t buffer[2][LOG_BLOCK_SIZE];
+        uint8_t* active;
+        uint8_t* flushPtr;               // Owned by the writer while set
+        size_t count;                    // Records in the active block
+        size_t bytes;                    // Payload bytes in the active block
+        size_t flushCount;
+        size_t flushBytes;
+        uint32_t first;                  // Timestamps of the active block's
+        uint32_t last;                   // first and last records
+        uint32_t flushFirst;
+        uint32_t flushLast;
+        size_t maxRecord;                // Worst-case record size
+        uint32_t handed;                 // Blocks ever handed to the writer
+        uint32_t flushOrder;             // swapCount when flushPtr was handed
+        uint32_t written;                // Of those, written out
+        uint32_t syncMark;               // handed count that covers every
+                                         // record as of the last sync request
+        
+        bool full() const { return LOG_BLOCK_PAYLOAD - bytes < maxRecord; }
+    };
+    StreamBuffers streams[LOG_STREAM_COUNT];
+    LogEncoder encoder;                  // Restarted with every block
+    LogSampleEncoder sampleEncoder;
+    uint32_t swapCount = 0;              // Blocks handed over, all streams
+    uint32_t blockIndex = 0;             // Next block in the current file
+    uint32_t blockCrcSeed = 0;           // Header CRC of the current file
+    LogIndex indexes[2];                 // Time indexes, appended on close:
+    LogIndex* index = &indexes[0];       // the current file's, and the one
+                                         // being closed after a rotation
     
     SemaphoreHandle_t bufferMutex = nullptr;
     
-    // File rotation
+    // SD writer task. Sync requests are numbered; the writer publishes the
+    // last one whose data has reached the card, and when (micros()). Each
+    // request marks how far every stream had got, and the writer serves
+    // one at a time: the latest request, with its marks and any rotation
+    // asked for before it.
+    TaskHandle_t writerTask = nullptr;
+    SemaphoreHandle_t writerWake = nullptr;
+    SemaphoreHandle_t syncDone = nullptr;
+    uint32_t syncRequested = 0;
+    std::atomic<uint32_t> syncCompleted{0};
+    std::atomic<uint32_t> syncCompletedUs{0};
+    bool rotateRequested = false;
+    uint32_t syncTarget = 0;             // Writer side: the request being served
+    uint32_t syncMarks[LOG_STREAM_COUNT] = {};
+    bool syncRotate = false;
+    std::atomic<bool> writerStop{false};
+    std::atomic<bool> writerRunning{false};
+    
+    // File rotation. Slots are reused oldest first, by header sequence,
+    // not by slot number. The catalog entry of the current file is
+    // updated in RAM with every block and saved with every sync.
     char currentFilename[32];
-    uint8_t fileIndex = 0;
+    uint16_t fileIndex = 0;
+    LogCatalog catalog;
+    bool catalogDirty = false;
+    uint32_t nextSequence = 1;
+    LogStorage storage;
+    uint32_t fileLimit = MAX_LOG_SIZE_BYTES;  // Preallocated size of the current file
+    
+    // Next file, created and preallocated by the writer task before the
+    // current one fills up. Rotation then only swaps it in.
+    File nextFile;
+    LogFileHeader nextHeader;
+    char nextFilename[32];
+    uint16_t nextIndex = 0;
+    bool nextOpen = false;
+    uint32_t nextAllocated = 0;          // Bytes preallocated so far
+    uint32_t nextLimit = MAX_LOG_SIZE_BYTES;
     
     // Statistics
     LogStats stats;
@@ -65,14 +132,32 @@ private:
     char vehicleId[17] = "RALLY_CAR_01";
     char driverName[17] = "DRIVER";
     
-    // CRC32 table
-    static const uint32_t crc32Table[256];
-    
     bool openNewFile();
-    bool rotateFile();
-    void flushWriteBuffer();
-    uint32_t calculateCRC32(const void* data, size_t length);
-    uint32_t calculatePacketCRC(const TelemetryPacket& packet);
+    void closeFile();
+    void finishFile(File& file, const char* filename, uint16_t slot, uint32_t dataEnd,
+                    uint32_t limit, uint32_t crcSeed, const LogIndex& timeIndex);
+    bool prepareNextFile(bool finish);
+    void switchToNextFile();
+    void discardNextFile();
+    bool dropUnusedFile(uint16_t slot);
+    bool rotationDue(uint32_t margin) const {
+        return stats.currentFileSize + LOG_BLOCK_SIZE + LOG_INDEX_MAX_BYTES + margin > fileLimit;
+    }
+    void scanLogFiles();
+    uint16_t claimSlot();
+    void removeSlot(uint16_t slot);
+    bool resumeFile(uint16_t slot);
+    bool sealFile(File& file, const char* filename, const LogFileHeader& header, uint32_t blocks);
+    bool append(const TelemetryPacket& packet, bool& wake);
+    bool append(const IMUData& sample, bool& wake);
+    bool makeRoom(uint16_t stream, bool& wake);
+    bool swapBuffers(uint16_t stream);
+    uint32_t requestSync();
+    void finishWrite(uint16_t stream, size_t written, size_t count, bool wake);
+    void writeBlock(uint16_t stream);
+    void completeSync();
+    void drainBuffers();
+    static void writerTaskEntry(void* pvParameters);
     
 public:
     BinaryLogger();
@@ -81,15 +166,33 @@ public:
     bool begin();
     void end();
     
-    // Write packet (non-blocking, buffered)
+    // Write packet (non-blocking, buffered; dropped if both buffers are full)
     bool write(const TelemetryPacket& packet);
     
-    // Force flush to SD card
-    bool flush();
+    // Write a contiguous run of packets, copying as many as fit per lock
+    size_t write(const TelemetryPacket* packets, size_t count);
+    
+    // Write packets held elsewhere (e.g. pool blocks), in order
+    size_t write(const TelemetryPacket* const* packets, size_t count);
+    
+    // Write raw IMU samples to the IMU stream (same buffering and drops)
+    size_t write(const IMUData* samples, size_t count);
+    size_t write(const StampedIMU* samples, size_t count);
+    
+    // Ask the writer task to push buffered packets to the card (non-blocking).
+    // Returns a ticket for isFlushed(), or 0 if the writer is not running.
+    uint32_t flush();
+    
+    // Whether the flush with this ticket is done; syncedUs is then the
+    // micros() time the latest flush finished
+    bool isFlushed(uint32_t ticket, uint32_t& syncedUs) const;
+    
+    // Fence: wait until everything written so far is on the card
+    bool sync(TickType_t timeoutTicks = portMAX_DELAY);
     
     // File management
     bool setVehicleInfo(const char* vehicle, const char* driver);
-    bool rotate();  // Manually rotate to new file
+    bool rotate();  // Manually rotate to new file (done by the writer task)
     bool getCurrentFilename(char* buffer, size_t size) const;
     
     // Statistics
@@ -102,9 +205,16 @@ public:
     
     // Maintenance
     bool deleteOldestFile();
-    uint8_t countLogFiles() const;
-    uint32_t getFreeSpaceMB() const;
+    uint16_t countLogFiles() const;
+    uint32_t getFreeSpaceMB() const;  // Tracked, not read from the card
+    
+    // Every log on the card, without touching the card
+    const LogCatalog& getCatalog() const { return catalog; }
+    
+    // Append a time index to a log that was never closed (not the open one)
+    bool rebuildIndex(const char* filename);
     
-    // Export functionality
-    bool exportToCSV(const char* binFile, const char* csvFile);
+    // Export functionality (optionally only packets in [startMs, endMs])
+    bool exportToCSV(const char* binFile, const char* csvFile,
+                     uint32_t startMs = 0, uint32_t endMs = UINT32_MAX);
 };
@@ -0,0 +1,150 @@
+#include "CsvExporter.h"
+#include "LogReader.h"
+#include <math.h>
+
+static const uint32_t POW10[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+// Largest scaled value written in fixed form (fits a uint64_t with room)
+static constexpr double MAX_SCALED = 1e18;
+
+char* CsvExporter::formatUnsigned(char* out, uint32_t value) {
+    char digits[10];
+    int n = 0;
+    do {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+    while (n > 0) {
+        *out++ = digits[--n];
+    }
+    return out;
+}
+
+char* CsvExporter::formatFixed(char* out, double value, uint8_t decimals) {
+    if (decimals > 9) decimals = 9;
+    
+    if (isnan(value)) {
+        memcpy(out, "nan", 3);
+        return out + 3;
+    }
+    if (signbit(value)) {
+        *out++ = '-';
+        value = -value;
+    }
+    
+    // rint() rounds half to even, as printf does for exact halves. Floats
+    // times up to 10^6 are exact in a double, so those always agree.
+    const double scaled = rint(value * POW10[decimals]);
+    if (!(scaled < MAX_SCALED)) {
+        return out + snprintf(out, 32, "%.*e", decimals, value);
+    }
+    
+    // One 64-bit division, then 32-bit digit loops (no 64-bit divide on
+    // the ESP32)
+    const uint64_t fixed = (uint64_t)scaled;
+    const uint64_t whole = fixed / POW10[decimals];
+    uint32_t fraction = (uint32_t)(fixed - whole * POW10[decimals]);
+    if (whole > UINT32_MAX) {
+        out = formatUnsigned(out, (uint32_t)(whole / 1000000000));
+        const uint32_t low = (uint32_t)(whole % 1000000000);
+        for (uint32_t p = 100000000; p > 0; p /= 10) {
+            *out++ = '0' + low / p % 10;
+        }
+    } else {
+        out = formatUnsigned(out, (uint32_t)whole);
+    }
+    
+    if (decimals > 0) {
+        *out++ = '.';
+        for (int i = decimals - 1; i >= 0; i--) {
+            out[i] = '0' + fraction % 10;
+            fraction /= 10;
+        }
+        out += decimals;
+    }
+    return out;
+}
+
+size_t CsvExporter::formatRow(const TelemetryPacket& packet, char* out) {
+    char* p = out;
+    p = formatUnsigned(p, packet.timestamp_ms);
+    *p++ = ',';
+    p = formatFixed(p, packet.imu.accel_x, 3);
+    *p++ = ',';
+    p = formatFixed(p, packet.imu.accel_y, 3);
+    *p++ = ',';
+    p = formatFixed(p, packet.imu.accel_z, 3);
+    *p++ = ',';
+    p = formatFixed(p, packet.imu.gyro_x, 3);
+    *p++ = ',';
+    p = formatFixed(p, packet.imu.gyro_y, 3);
+    *p++ = ',';
+    p = formatFixed(p, packet.imu.gyro_z, 3);
+    *p++ = ',';
+    p = formatFixed(p, packet.imu.temperature, 2);
+    *p++ = ',';
+    p = formatFixed(p, packet.gps.latitude, 6);
+    *p++ = ',';
+    p = formatFixed(p, packet.gps.longitude, 6);
+    *p++ = ',';
+    p = formatFixed(p, packet.gps.altitude, 1);
+    *p++ = ',';
+    p = formatFixed(p, packet.gps.speed_kmh, 1);
+    *p++ = ',';
+    p = formatFixed(p, packet.gps.heading, 1);
+    *p++ = ',';
+    p = formatUnsigned(p, packet.gps.satellites);
+    *p++ = ',';
+    p = formatUnsigned(p, packet.gps.fix_quality);
+    *p++ = '\n';
+    return p - out;
+}
+
+void CsvExporter::flushBuffer() {
+    if (used > 0 && sink.write((const uint8_t*)buffer, used) != used) {
+        failed = true;
+    }
+    used = 0;
+}
+
+void CsvExporter::writeHeader() {
+    const size_t length = strlen(HEADER);
+    if (BUFFER_SIZE - used < length) {
+        flushBuffer();
+    }
+    memcpy(buffer + used, HEADER, length);
+    used += length;
+}
+
+void CsvExporter::writeRow(const TelemetryPacket& packet) {
+    if (BUFFER_SIZE - used < MAX_ROW_SIZE) {
+        flushBuffer();
+    }
+    used += formatRow(packet, buffer + used);
+    rows++;
+}
+
+bool CsvExporter::finish() {
+    flushBuffer();
+    sink.flush();
+    return !failed;
+}
+
+bool CsvExporter::exportLog(File& log, uint32_t startMs, uint32_t endMs) {
+    LogReader reader;
+    if (!reader.begin(log)) {
+        return false;
+    }
+    if (startMs > 0) {
+        reader.seek(startMs);
+    }
+    
+    writeHeader();
+    TelemetryPacket packet;
+    while (!failed && reader.next(packet) && packet.timestamp_ms <= endMs) {
+        writeRow(packet);
+    }
+    return finish();
+}
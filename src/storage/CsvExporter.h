@@ -0,0 +1,75 @@
+/**
+ * Streaming CSV Exporter
+ *
+ * Turns the packets of a binary log into CSV rows and streams them to any
+ * Print sink: a File on the card, a chunked HTTP response, or Serial (the
+ * host's stdout). Rows are formatted into one fixed buffer that is handed
+ * to the sink whenever it fills, so memory use does not depend on the
+ * size of the log and no row allocates.
+ *
+ * Numbers go through formatFixed() rather than printf: floats are scaled
+ * to integers and written digit by digit. This matches "%.Nf" to the last
+ * digit within the sensor ranges tested (test_csv_export compares it with
+ * snprintf on random values); values too large to scale are written in
+ * exponent form.
+ */
+
+#pragma once
+
+#include "../core/config.h"
+#include <FS.h>
+
+class CsvExporter {
+public:
+    static constexpr size_t BUFFER_SIZE = 2048;
+    static constexpr size_t MAX_ROW_SIZE = 512;   // 15 fields of at most 32 chars
+    static constexpr const char* HEADER =
+        "Timestamp,AccelX,AccelY,AccelZ,GyroX,GyroY,GyroZ,TempC,"
+        "Latitude,Longitude,Altitude,SpeedKmh,Heading,Satellites,FixQuality\n";
+    
+private:
+    Print& sink;
+    char buffer[BUFFER_SIZE];
+    size_t used = 0;
+    uint32_t rows = 0;
+    bool failed = false;
+    
+    void flushBuffer();
+    
+public:
+    explicit CsvExporter(Print& output) : sink(output) {}
+    
+    /**
+     * @brief Write the header and every packet in [startMs, endMs]
+     * @param log Open log file
+     * @return false if the file is not a log or the sink failed
+     */
+    bool exportLog(File& log, uint32_t startMs = 0, uint32_t endMs = UINT32_MAX);
+    
+    void writeHeader();
+    void writeRow(const TelemetryPacket& packet);
+    
+    /**
+     * @brief Hand what is buffered to the sink
+     * @return false if any write to the sink came up short
+     */
+    bool finish();
+    
+    uint32_t getRows() const { return rows; }
+    
+    /**
+     * @brief Format one packet as a CSV line, newline included
+     * @param out At least MAX_ROW_SIZE bytes
+     * @return Characters written (no terminator)
+     */
+    static size_t formatRow(const TelemetryPacket& packet, char* out);
+    
+    /**
+     * @brief Write value with a fixed number of decimals (at most 9), like
+     *        "%.*f"
+     * @return End of the text written (no terminator)
+     */
+    static char* formatFixed(char* out, double value, uint8_t decimals);
+    
+    static char* formatUnsigned(char* out, uint32_t value);
+};
@@ -0,0 +1,206 @@
+#include "LogCatalog.h"
+#include "LogReader.h"
+#include "../utils/Crc.h"
+#include <SD.h>
+
+static uint32_t entryCrc(const LogCatalogEntry& entry) {
+    return crc32(&entry, offsetof(LogCatalogEntry, crc32));
+}
+
+static uint32_t entryOffset(uint16_t slot) {
+    return (slot + 1) * sizeof(LogCatalogEntry);
+}
+
+LogCatalog::LogCatalog() {
+    memset(entries, 0, sizeof(entries));
+    mutex = xSemaphoreCreateMutex();
+}
+
+LogCatalog::~LogCatalog() {
+    close();
+    if (mutex) vSemaphoreDelete(mutex);
+}
+
+void LogCatalog::slotFilename(uint16_t slot, char* buffer, size_t size) {
+    snprintf(buffer, size, "%s_%03d%s", LOG_FILE_BASE, slot, LOG_EXT);
+}
+
+bool LogCatalog::load() {
+    close();
+    
+    File in = SD.open(LOG_CATALOG_FILE, FILE_READ);
+    
+    // Read straight into the entries (too big for the stack); nobody sees
+    // them before the mutex is given back
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    LogCatalogHeader header;
+    bool ok = in && in.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              header.magic == LOG_CATALOG_MAGIC && header.version == LOG_CATALOG_VERSION &&
+              header.slotCount == MAX_LOG_FILES &&
+              header.crc32 == crc32(&header, offsetof(LogCatalogHeader, crc32)) &&
+              in.seek(entryOffset(0)) &&
+              in.read((uint8_t*)entries, sizeof(entries)) == sizeof(entries);
+    
+    // One torn entry means the catalog cannot be trusted
+    for (uint16_t i = 0; ok && i < MAX_LOG_FILES; i++) {
+        ok = entries[i].crc32 == entryCrc(entries[i]);
+    }
+    if (!ok) {
+        memset(entries, 0, sizeof(entries));
+    }
+    xSemaphoreGive(mutex);
+    
+    if (in) {
+        in.close();
+    }
+    if (!ok) {
+        return false;
+    }
+    
+    file = SD.open(LOG_CATALOG_FILE, "r+");
+    return (bool)file;
+}
+
+bool LogCatalog::save() {
+    close();
+    file = SD.open(LOG_CATALOG_FILE, "w+");
+    if (!file) return false;
+    
+    LogCatalogEntry first;
+    memset(&first, 0, sizeof(first));
+    LogCatalogHeader header;
+    header.magic = LOG_CATALOG_MAGIC;
+    header.version = LOG_CATALOG_VERSION;
+    header.slotCount = MAX_LOG_FILES;
+    header.crc32 = crc32(&header, offsetof(LogCatalogHeader, crc32));
+    memcpy(&first, &header, sizeof(header));
+    
+    bool ok = file.write((const uint8_t*)&first, sizeof(first)) == sizeof(first);
+    for (uint16_t i = 0; ok && i < MAX_LOG_FILES; i++) {
+        ok = writeEntry(i, get(i));
+    }
+    return ok;
+}
+
+bool LogCatalog::saveEntry(uint16_t slot) {
+    return file && writeEntry(slot, get(slot));
+}
+
+bool LogCatalog::writeEntry(uint16_t slot, const LogCatalogEntry& entry) {
+    LogCatalogEntry sealed = entry;
+    sealed.crc32 = entryCrc(sealed);
+    
+    bool ok = file.seek(entryOffset(slot)) &&
+              file.write((const uint8_t*)&sealed, sizeof(sealed)) == sizeof(sealed);
+    file.flush();
+    return ok;
+}
+
+void LogCatalog::close() {
+    if (file) {
+        file.close();
+    }
+}
+
+bool LogCatalog::rescan(uint16_t slot) {
+    char filename[32];
+    slotFilename(slot, filename, sizeof(filename));
+    
+    LogCatalogEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    File log = SD.open(filename, FILE_READ);
+    if (!log) {
+        set(slot, entry);
+        return false;
+    }
+    
+    // Unreadable files still take up the slot, as the oldest
+    entry.used = 1;
+    entry.sizeBytes = log.size();
+    LogReader reader;
+    if (reader.begin(log)) {
+        entry.sequence = reader.getHeader().fileSequence;
+        entry.createdTime = reader.getHeader().createdTime;
+        
+        // A file that was never closed is still preallocated
+        if (!reader.hasIndex()) {
+            entry.sizeBytes = reader.getBlockOffset(reader.findEnd());
+        }
+        
+        // First packet, then the last block's packets
+        TelemetryPacket packet;
+        if (reader.begin(log) && reader.next(packet)) {
+            entry.firstTimestamp = entry.lastTimestamp = packet.timestamp_ms;
+            reader.seekBlock(reader.findBlock(UINT32_MAX));
+            while (reader.next(packet)) {
+                entry.lastTimestamp = packet.timestamp_ms;
+            }
+        }
+    } else {
+        LogFileHeader header;
+        if (log.seek(0) && log.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+            header.magic == LOG_FILE_MAGIC) {
+            entry.sequence = header.fileSequence;
+            entry.createdTime = header.createdTime;
+        }
+    }
+    log.close();
+    
+    set(slot, entry);
+    return true;
+}
+
+void LogCatalog::set(uint16_t slot, const LogCatalogEntry& entry) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    entries[slot] = entry;
+    xSemaphoreGive(mutex);
+}
+
+LogCatalogEntry LogCatalog::get(uint16_t slot) const {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    LogCatalogEntry entry = entries[slot];
+    xSemaphoreGive(mutex);
+    return entry;
+}
+
+void LogCatalog::clear(uint16_t slot) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    memset(&entries[slot], 0, sizeof(entries[slot]));
+    xSemaphoreGive(mutex);
+}
+
+uint16_t LogCatalog::count() const {
+    uint16_t n = 0;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for (uint16_t i = 0; i < MAX_LOG_FILES; i++) {
+        n += entries[i].used ? 1 : 0;
+    }
+    xSemaphoreGive(mutex);
+    return n;
+}
+
+uint16_t LogCatalog::newest() const {
+    uint16_t newest = MAX_LOG_FILES;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for (uint16_t i = 0; i < MAX_LOG_FILES; i++) {
+        if (entries[i].used &&
+            (newest == MAX_LOG_FILES || entries[i].sequence > entries[newest].sequence)) {
+            newest = i;
+        }
+    }
+    xSemaphoreGive(mutex);
+    return newest;
+}
+
+uint16_t LogCatalog::oldest(uint16_t excludeA, uint16_t excludeB) const {
+    uint16_t oldest = MAX_LOG_FILES;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for (uint16_t i = 0; i < MAX_LOG_FILES; i++) {
+        if (!entries[i].used || i == excludeA || i == excludeB) continue;
+        if (oldest == MAX_LOG_FILES || entries[i].sequence < entries[oldest].sequence) {
+            oldest = i;
+        }
+    }
+    xSemaphoreGive(mutex);
+    return oldest;
+}
@@ -0,0 +1,97 @@
+/**
+ * Log Catalog
+ *
+ * One entry per log slot, kept in RAM and mirrored to LOG_CATALOG_FILE on
+ * the card, so finding, counting and listing logs never has to probe the
+ * slots on the card.
+ *
+ * Layout: a LogCatalogHeader padded to one entry, then MAX_LOG_FILES
+ * LogCatalogEntry records. Each entry carries its own CRC and is written
+ * on its own, so an update is one small write. A catalog that is missing,
+ * damaged or sized for another MAX_LOG_FILES fails load(); the logger then
+ * rebuilds it from the log files once.
+ *
+ * Entries are read and written under a mutex, so other tasks (the web
+ * server) can read while the SD writer task updates them.
+ */
+
+#pragma once
+
+#include "../core/config.h"
+#include <FS.h>
+
+constexpr uint32_t LOG_CATALOG_MAGIC = 0x52434154;  // "RCAT"
+constexpr uint16_t LOG_CATALOG_VERSION = 1;
+
+struct __attribute__((packed)) LogCatalogHeader {
+    uint32_t magic;           // 'RCAT'
+    uint16_t version;
+    uint16_t slotCount;       // MAX_LOG_FILES it was written for
+    uint32_t crc32;           // Checksum of the fields above
+};
+
+struct __attribute__((packed)) LogCatalogEntry {
+    uint8_t used;             // Slot holds a log
+    uint8_t reserved[3];
+    uint32_t sequence;        // LogFileHeader.fileSequence
+    uint32_t createdTime;     // LogFileHeader.createdTime
+    uint32_t firstTimestamp;  // timestamp_ms of the first packet, 0 if none
+    uint32_t lastTimestamp;   // timestamp_ms of the last packet
+    uint32_t packetCount;     // 0 if unknown (rebuilt from the file)
+    uint32_t sizeBytes;       // Bytes of data and index, not preallocation
+    uint32_t crc32;           // Checksum of the fields above
+};
+
+static_assert(sizeof(LogCatalogHeader) <= sizeof(LogCatalogEntry), "Catalog header must fit in one entry");
+
+class LogCatalog {
+private:
+    LogCatalogEntry entries[MAX_LOG_FILES];
+    File file;
+    SemaphoreHandle_t mutex = nullptr;
+    
+    bool writeEntry(uint16_t slot, const LogCatalogEntry& entry);
+    
+public:
+    LogCatalog();
+    ~LogCatalog();
+    
+    /**
+     * @brief Read the catalog from the card
+     * @return false if it is missing or damaged; all slots read as empty
+     */
+    bool load();
+    
+    /**
+     * @brief Write the whole catalog (after a rebuild)
+     */
+    bool save();
+    
+    /**
+     * @brief Write one slot's entry to the card
+     */
+    bool saveEntry(uint16_t slot);
+    
+    void close();
+    
+    /**
+     * @brief Fill a slot's entry from its log file
+     * @return false if the slot holds no log
+     */
+    bool rescan(uint16_t slot);
+    
+    void set(uint16_t slot, const LogCatalogEntry& entry);
+    LogCatalogEntry get(uint16_t slot) const;
+    void clear(uint16_t slot);
+    
+    uint16_t count() const;
+    
+    // Slot with the highest sequence, or MAX_LOG_FILES if none
+    uint16_t newest() const;
+    
+    // Slot with the lowest sequence other than the excluded ones, or
+    // MAX_LOG_FILES if none
+    uint16_t oldest(uint16_t excludeA, uint16_t excludeB) const;
+    
+    static void slotFilename(uint16_t slot, char* buffer, size_t size);
+};
@@ -0,0 +1,246 @@
+#include "LogCodec.h"
+
+static const uint8_t FLAG_GPS = 0x01;
+static const uint8_t FLAG_SEQUENCE_JUMP = 0x02;
+
+// =============================================================================
+// Fixed-point conversion
+// =============================================================================
+
+static int32_t toFixed(double value, double scale) {
+    double scaled = value * scale;
+    if (scaled >= 2147483647.0) return INT32_MAX;
+    if (scaled <= -2147483648.0) return INT32_MIN;
+    return (int32_t)(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+}
+
+// Gyro rates are rad/s, as the MPU6050 driver reports them; 1e-4 rad/s
+// is finer than one sensor LSB at +-1000 deg/s (1/32.8 deg/s, 5.3e-4 rad/s)
+static void quantizeIMU(const TelemetryPacket& packet, int32_t* q) {
+    const IMUData& imu = packet.imu;
+    q[0] = (int32_t)(imu.timestamp_ms - packet.timestamp_ms);
+    q[1] = toFixed(imu.accel_x, 1000);
+    q[2] = toFixed(imu.accel_y, 1000);
+    q[3] = toFixed(imu.accel_z, 1000);
+    q[4] = toFixed(imu.gyro_x, 10000);
+    q[5] = toFixed(imu.gyro_y, 10000);
+    q[6] = toFixed(imu.gyro_z, 10000);
+    q[7] = toFixed(imu.temperature, 100);
+}
+
+static void quantizeSample(const IMUData& imu, int32_t* q) {
+    q[0] = toFixed(imu.accel_x, 1000);
+    q[1] = toFixed(imu.accel_y, 1000);
+    q[2] = toFixed(imu.accel_z, 1000);
+    q[3] = toFixed(imu.gyro_x, 10000);
+    q[4] = toFixed(imu.gyro_y, 10000);
+    q[5] = toFixed(imu.gyro_z, 10000);
+    q[6] = toFixed(imu.temperature, 100);
+}
+
+static void restoreSample(const int32_t* q, IMUData& imu) {
+    imu.accel_x = q[0] / 1000.0f;
+    imu.accel_y = q[1] / 1000.0f;
+    imu.accel_z = q[2] / 1000.0f;
+    imu.gyro_x = q[3] / 10000.0f;
+    imu.gyro_y = q[4] / 10000.0f;
+    imu.gyro_z = q[5] / 10000.0f;
+    imu.temperature = q[6] / 100.0f;
+}
+
+static void restoreIMU(const int32_t* q, TelemetryPacket& packet) {
+    IMUData& imu = packet.imu;
+    imu.timestamp_ms = packet.timestamp_ms + (uint32_t)q[0];
+    imu.accel_x = q[1] / 1000.0f;
+    imu.accel_y = q[2] / 1000.0f;
+    imu.accel_z = q[3] / 1000.0f;
+    imu.gyro_x = q[4] / 10000.0f;
+    imu.gyro_y = q[5] / 10000.0f;
+    imu.gyro_z = q[6] / 10000.0f;
+    imu.temperature = q[7] / 100.0f;
+}
+
+static void quantizeGPS(const GPSData& gps, int32_t* q) {
+    q[0] = (int32_t)gps.timestamp_ms;
+    q[1] = toFixed(gps.latitude, 1e7);
+    q[2] = toFixed(gps.longitude, 1e7);
+    q[3] = toFixed(gps.altitude, 100);
+    q[4] = toFixed(gps.speed_kmh, 100);
+    q[5] = toFixed(gps.heading, 100);
+    q[6] = gps.satellites;
+    q[7] = gps.fix_quality;
+    q[8] = gps.hdop;
+    q[9] = gps.padding;
+}
+
+static void restoreGPS(const int32_t* q, GPSData& gps) {
+    gps.timestamp_ms = (uint32_t)q[0];
+    gps.latitude = q[1] / 1e7;
+    gps.longitude = q[2] / 1e7;
+    gps.altitude = q[3] / 100.0f;
+    gps.speed_kmh = q[4] / 100.0f;
+    gps.heading = q[5] / 100.0f;
+    gps.satellites = (uint8_t)q[6];
+    gps.fix_quality = (uint8_t)q[7];
+    gps.hdop = (uint8_t)q[8];
+    gps.padding = (uint8_t)q[9];
+}
+
+// =============================================================================
+// Zigzag varints
+// =============================================================================
+
+// Deltas wrap modulo 2^32, so every int32 pair round-trips exactly
+static size_t putDelta(uint8_t* out, int32_t current, int32_t previous) {
+    const uint32_t delta = (uint32_t)current - (uint32_t)previous;
+    uint32_t v = (delta << 1) ^ (uint32_t)((int32_t)delta >> 31);
+    
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+static bool getDelta(const uint8_t* in, size_t length, size_t& pos, int32_t& value) {
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (pos >= length) return false;
+        const uint8_t byte = in[pos++];
+        v |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            const uint32_t delta = (v >> 1) ^ (0u - (v & 1));
+            value = (int32_t)((uint32_t)value + delta);
+            return true;
+        }
+    }
+    return false;  // Longer than 5 bytes
+}
+
+// =============================================================================
+// Codec
+// =============================================================================
+
+void LogCodecState::reset() {
+    timestamp = 0;
+    sequence = 0xFFFF;  // So a block starting at sequence 0 needs no jump
+    memset(imu, 0, sizeof(imu));
+    memset(gps, 0, sizeof(gps));
+}
+
+size_t LogEncoder::encode(const TelemetryPacket& packet, uint8_t* out) {
+    int32_t imu[LOG_IMU_CHANNELS];
+    int32_t gps[LOG_GPS_CHANNELS];
+    quantizeIMU(packet, imu);
+    quantizeGPS(packet.gps, gps);
+    
+    uint8_t flags = 0;
+    if (memcmp(gps, state.gps, sizeof(gps)) != 0) {
+        flags |= FLAG_GPS;
+    }
+    const uint16_t expected = state.sequence + 1;
+    if (packet.sequence != expected) {
+        flags |= FLAG_SEQUENCE_JUMP;
+    }
+    
+    size_t n = 0;
+    out[n++] = flags;
+    n += putDelta(out + n, (int32_t)packet.timestamp_ms, (int32_t)state.timestamp);
+    if (flags & FLAG_SEQUENCE_JUMP) {
+        n += putDelta(out + n, packet.sequence, expected);
+    }
+    for (size_t i = 0; i < LOG_IMU_CHANNELS; i++) {
+        n += putDelta(out + n, imu[i], state.imu[i]);
+    }
+    if (flags & FLAG_GPS) {
+        for (size_t i = 0; i < LOG_GPS_CHANNELS; i++) {
+            n += putDelta(out + n, gps[i], state.gps[i]);
+        }
+        memcpy(state.gps, gps, sizeof(gps));
+    }
+    
+    state.timestamp = packet.timestamp_ms;
+    state.sequence = packet.sequence;
+    memcpy(state.imu, imu, sizeof(imu));
+    return n;
+}
+
+size_t LogDecoder::decode(const uint8_t* in, size_t length, TelemetryPacket& packet) {
+    if (length == 0) return 0;
+    
+    // Work on a copy so a truncated record leaves the state untouched
+    LogCodecState next = state;
+    size_t pos = 0;
+    const uint8_t flags = in[pos++];
+    if (flags & ~(FLAG_GPS | FLAG_SEQUENCE_JUMP)) return 0;
+    
+    int32_t timestamp = (int32_t)next.timestamp;
+    if (!getDelta(in, length, pos, timestamp)) return 0;
+    next.timestamp = (uint32_t)timestamp;
+    
+    int32_t sequence = (uint16_t)(next.sequence + 1);
+    if ((flags & FLAG_SEQUENCE_JUMP) && !getDelta(in, length, pos, sequence)) return 0;
+    next.sequence = (uint16_t)sequence;
+    
+    for (size_t i = 0; i < LOG_IMU_CHANNELS; i++) {
+        if (!getDelta(in, length, pos, next.imu[i])) return 0;
+    }
+    if (flags & FLAG_GPS) {
+        for (size_t i = 0; i < LOG_GPS_CHANNELS; i++) {
+            if (!getDelta(in, length, pos, next.gps[i])) return 0;
+        }
+    }
+    
+    state = next;
+    packet.magic = PACKET_MAGIC;
+    packet.version = PACKET_VERSION;
+    packet.sequence = state.sequence;
+    packet.timestamp_ms = state.timestamp;
+    restoreIMU(state.imu, packet);
+    restoreGPS(state.gps, packet.gps);
+    packet.crc16 = calculatePacketCRC(packet);
+    return pos;
+}
+
+// =============================================================================
+// Raw IMU samples
+// =============================================================================
+
+void LogSampleState::reset() {
+    timestamp = 0;
+    memset(channels, 0, sizeof(channels));
+}
+
+size_t LogSampleEncoder::encode(const IMUData& sample, uint8_t* out) {
+    int32_t channels[LOG_SAMPLE_CHANNELS];
+    quantizeSample(sample, channels);
+    
+    size_t n = putDelta(out, (int32_t)sample.timestamp_ms, (int32_t)state.timestamp);
+    for (size_t i = 0; i < LOG_SAMPLE_CHANNELS; i++) {
+        n += putDelta(out + n, channels[i], state.channels[i]);
+    }
+    
+    state.timestamp = sample.timestamp_ms;
+    memcpy(state.channels, channels, sizeof(channels));
+    return n;
+}
+
+size_t LogSampleDecoder::decode(const uint8_t* in, size_t length, IMUData& sample) {
+    // Work on a copy so a truncated record leaves the state untouched
+    LogSampleState next = state;
+    size_t pos = 0;
+    
+    int32_t timestamp = (int32_t)next.timestamp;
+    if (!getDelta(in, length, pos, timestamp)) return 0;
+    next.timestamp = (uint32_t)timestamp;
+    for (size_t i = 0; i < LOG_SAMPLE_CHANNELS; i++) {
+        if (!getDelta(in, length, pos, next.channels[i])) return 0;
+    }
+    
+    state = next;
+    sample.timestamp_ms = state.timestamp;
+    restoreSample(state.channels, sample);
+    return pos;
+}
@@ -0,0 +1,140 @@
+/**
+ * Delta/Varint Record Codec (log format 3)
+ *
+ * Each packet becomes one variable-length record, coded against the
+ * previous record in the same block (the first against all zeros, so
+ * every block decodes on its own):
+ *
+ *   flags     u8      bit0: GPS fields follow, bit1: sequence jumped
+ *   dt        varint  timestamp_ms delta
+ *   [dseq]    varint  sequence - (previous + 1), only with bit1
+ *   imu[8]    varint  deltas of the fixed-point IMU channels
+ *   [gps[10]] varint  deltas of the fixed-point GPS channels, only with
+ *                     bit0, i.e. when any GPS channel changed
+ *
+ * Every varint is a zigzag-encoded signed delta in LEB128 (at most 5
+ * bytes). magic, version and crc16 are not stored; the decoder fills
+ * them in, recomputing crc16 over the decoded values. Fixed-point
+ * scales (the only loss):
+ *   accel 0.001 m/s^2, gyro 0.0001 rad/s, temperature 0.01 C,
+ *   lat/lon 1e-7 deg, altitude 0.01 m, speed 0.01 km/h, heading 0.01 deg
+ *
+ * Raw IMU samples (the full-rate stream, format 5) use the same scheme
+ * with no flags byte: a timestamp_ms delta followed by deltas of the seven
+ * sensor channels, at the same scales.
+ */
+
+#pragma once
+
+#include "../core/config.h"
+#include "../utils/Crc.h"
+#include <stddef.h>
+
+constexpr size_t LOG_IMU_CHANNELS = 8;
+constexpr size_t LOG_GPS_CHANNELS = 10;
+
+// TelemetryPacket.crc16: CRC-16/CCITT over every byte before it
+inline uint16_t calculatePacketCRC(const TelemetryPacket& packet) {
+    return crc16Ccitt(&packet, offsetof(TelemetryPacket, crc16));
+}
+
+// Worst-case encoded record size
+constexpr size_t LOG_MAX_RECORD_SIZE = 1 + 5 * (2 + LOG_IMU_CHANNELS + LOG_GPS_CHANNELS);
+
+// Raw IMU sample records
+constexpr size_t LOG_SAMPLE_CHANNELS = 7;
+constexpr size_t LOG_MAX_SAMPLE_SIZE = 5 * (1 + LOG_SAMPLE_CHANNELS);
+
+/**
+ * @brief Previous-record state shared by encoder and decoder
+ */
+struct LogCodecState {
+    uint32_t timestamp;
+    uint16_t sequence;
+    int32_t imu[LOG_IMU_CHANNELS];
+    int32_t gps[LOG_GPS_CHANNELS];
+    
+    void reset();
+};
+
+class LogEncoder {
+private:
+    LogCodecState state;
+    
+public:
+    LogEncoder() { reset(); }
+    
+    // Start a new block
+    void reset() { state.reset(); }
+    
+    /**
+     * @brief Append one record
+     * @param out Destination with room for LOG_MAX_RECORD_SIZE bytes
+     * @return Bytes written
+     */
+    size_t encode(const TelemetryPacket& packet, uint8_t* out);
+};
+
+class LogDecoder {
+private:
+    LogCodecState state;
+    
+public:
+    LogDecoder() { reset(); }
+    
+    // Start a new block
+    void reset() { state.reset(); }
+    
+    /**
+     * @brief Decode one record
+     * @param in Record bytes
+     * @param length Bytes available at in
+     * @return Bytes consumed, or 0 if the record is truncated or malformed
+     */
+    size_t decode(const uint8_t* in, size_t length, TelemetryPacket& packet);
+};
+
+/**
+ * @brief Previous-sample state for the raw IMU stream
+ */
+struct LogSampleState {
+    uint32_t timestamp;
+    int32_t channels[LOG_SAMPLE_CHANNELS];
+    
+    void reset();
+};
+
+class LogSampleEncoder {
+private:
+    LogSampleState state;
+    
+public:
+    LogSampleEncoder() { reset(); }
+    
+    // Start a new block
+    void reset() { state.reset(); }
+    
+    /**
+     * @brief Append one sample
+     * @param out Destination with room for LOG_MAX_SAMPLE_SIZE bytes
+     * @return Bytes written
+     */
+    size_t encode(const IMUData& sample, uint8_t* out);
+};
+
+class LogSampleDecoder {
+private:
+    LogSampleState state;
+    
+public:
+    LogSampleDecoder() { reset(); }
+    
+    // Start a new block
+    void reset() { state.reset(); }
+    
+    /**
+     * @brief Decode one sample
+     * @return Bytes consumed, or 0 if the record is truncated or malformed
+     */
+    size_t decode(const uint8_t* in, size_t length, IMUData& sample);
+};
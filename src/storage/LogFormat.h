@@ -0,0 +1,122 @@
+/**
+ * Binary Log File Format
+ *
+ * Layout:
+ *   sector 0        LogFileHeader, zero-padded to LOG_SECTOR_SIZE
+ *   then            LOG_BLOCK_SIZE blocks, each a LogBlockHeader followed
+ *                   by packetCount records and zero padding
+ *
+ * LogFileHeader.version selects how records are stored:
+ *   1 (legacy)      No sectors or blocks: the header up to crc32
+ *                   (LOG_LEGACY_HEADER_SIZE bytes), then whole
+ *                   TelemetryPacket structs back to back. Read only.
+ *   2 (raw)         Whole TelemetryPacket structs
+ *   3 (delta)       Delta/varint records, see LogCodec.h
+ *   4 (checked)     Delta records, and the last 4 bytes of every block
+ *                   hold a CRC-32 of the rest of it
+ *   5 (streams)     As 4, and each block belongs to one LogStream: fused
+ *                   packets, or raw IMU samples at the full sample rate.
+ *                   The streams' blocks are interleaved in write order.
+ *
+ * The block CRC is seeded from the file header (logCrcSeed()), so a stale
+ * block left on the card by another file never verifies. Readers skip a
+ * block whose CRC fails and carry on with the next one.
+ *
+ * Every SD write is one whole, sector-aligned block. Files are
+ * preallocated to MAX_LOG_SIZE_BYTES and truncated on close, so a file
+ * that was never closed ends in unwritten space; readers stop at the
+ * first block whose header does not match.
+ *
+ * Closing a file appends a time index after the last block: one
+ * LogIndexEntry per LOG_INDEX_INTERVAL_BLOCKS blocks (the first packet
+ * block in each run of that many, so it only covers the packet stream),
+ * zero padding, and a
+ * LogFooter in the file's last bytes, padded to whole sectors. A file
+ * without a valid footer (never closed, or a slice) is still seekable by
+ * bisecting its blocks.
+ */
+
+#pragma once
+
+#include "../core/config.h"
+
+constexpr uint32_t LOG_FILE_MAGIC = 0x524C4F47;   // "RLOG"
+constexpr uint32_t LOG_BLOCK_MAGIC = 0x52424C4B;  // "RBLK"
+constexpr uint32_t LOG_FOOTER_MAGIC = 0x52494458; // "RIDX"
+constexpr uint16_t LOG_FORMAT_LEGACY = 1;
+constexpr uint16_t LOG_FORMAT_RAW = 2;
+constexpr uint16_t LOG_FORMAT_DELTA = 3;
+constexpr uint16_t LOG_FORMAT_CHECKED = 4;
+constexpr uint16_t LOG_FORMAT_STREAMS = 5;
+constexpr uint16_t LOG_FORMAT_VERSION = LOG_FORMAT_STREAMS;  // Written by BinaryLogger
+
+// What a block holds (format 5)
+enum LogStream : uint16_t {
+    LOG_STREAM_PACKETS = 0,   // TelemetryPacket records
+    LOG_STREAM_IMU = 1,       // Raw IMUData samples
+    LOG_STREAM_COUNT
+};
+
+// File header for binary log files
+struct __attribute__((packed)) LogFileHeader {
+    uint32_t magic;           // 'RLOG'
+    uint16_t version;         // File format version
+    uint32_t createdTime;     // Unix timestamp
+    uint16_t packetSize;      // Expected packet size
+    uint16_t blockSectors;    // Sectors per data block
+    char vehicleId[16];       // Vehicle identifier
+    char driverName[16];      // Driver name
+    uint32_t crc32;           // Checksum of the fields above
+    uint32_t fileSequence;    // Grows with every new file; 0 in older files
+    uint16_t streams;         // Bit per LogStream the file may hold (format 5)
+};
+
+// Format 1 header: today's LogFileHeader up to and including crc32
+constexpr size_t LOG_LEGACY_HEADER_SIZE = offsetof(LogFileHeader, fileSequence);
+
+// Seed for block and footer CRCs. Files from before fileSequence existed
+// have it zero, so their seed is unchanged.
+inline uint32_t logCrcSeed(const LogFileHeader& header) {
+    return header.crc32 ^ header.fileSequence;
+}
+
+// Header at the start of every data block (16 bytes)
+struct __attribute__((packed)) LogBlockHeader {
+    uint32_t magic;           // 'RBLK'
+    uint32_t blockIndex;      // Position in the file, from 0
+    uint16_t packetCount;     // Records in this block
+    uint16_t stream;          // LogStream; sizeof(TelemetryPacket) before format 5
+    uint32_t payloadBytes;    // Record bytes after this header (delta format)
+};
+
+// Block CRC trailer (format 4)
+constexpr size_t LOG_BLOCK_CRC_SIZE = sizeof(uint32_t);
+
+constexpr size_t LOG_BLOCK_PAYLOAD = LOG_BLOCK_SIZE - sizeof(LogBlockHeader) - LOG_BLOCK_CRC_SIZE;
+
+// Time index entry: first packet timestamp of a block
+struct __attribute__((packed)) LogIndexEntry {
+    uint32_t timestamp;       // timestamp_ms of the block's first packet
+    uint32_t blockIndex;
+};
+
+// Last bytes of a closed file
+struct __attribute__((packed)) LogFooter {
+    uint32_t magic;           // 'RIDX'
+    uint32_t indexOffset;     // File offset of the first LogIndexEntry
+    uint32_t entryCount;
+    uint32_t blockCount;      // Data blocks in the file
+    uint32_t crc32;           // Entries then footer, seeded by logCrcSeed()
+};
+
+constexpr size_t LOG_INDEX_CAPACITY =
+    (MAX_LOG_SIZE_BYTES / LOG_BLOCK_SIZE + LOG_INDEX_INTERVAL_BLOCKS - 1) / LOG_INDEX_INTERVAL_BLOCKS;
+
+// Space a full index takes at the end of a file
+constexpr size_t LOG_INDEX_MAX_BYTES =
+    (LOG_INDEX_CAPACITY * sizeof(LogIndexEntry) + sizeof(LogFooter) + LOG_SECTOR_SIZE - 1) /
+    LOG_SECTOR_SIZE * LOG_SECTOR_SIZE;
+
+static_assert(sizeof(LogFileHeader) <= LOG_SECTOR_SIZE, "Log header must fit in one sector");
+static_assert(LOG_BLOCK_SIZE % LOG_SECTOR_SIZE == 0, "Log blocks must be whole sectors");
+static_assert(MAX_LOG_SIZE_BYTES % LOG_BLOCK_SIZE == 0, "Log size must be whole blocks");
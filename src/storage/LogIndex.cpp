@@ -0,0 +1,125 @@
+#include "LogIndex.h"
+#include "LogCodec.h"
+#include "../utils/Crc.h"
+#include <stddef.h>
+
+bool LogIndex::firstTimestamp(uint16_t version, uint16_t stream, const uint8_t* payload,
+                              size_t length, uint32_t& timestamp) {
+    if (version == LOG_FORMAT_RAW) {
+        if (length < sizeof(TelemetryPacket)) return false;
+        memcpy(&timestamp, payload + offsetof(TelemetryPacket, timestamp_ms), sizeof(timestamp));
+        return true;
+    }
+    
+    // The first record of a block is coded against zeros
+    if (stream == LOG_STREAM_IMU) {
+        LogSampleDecoder decoder;
+        IMUData sample;
+        if (decoder.decode(payload, length, sample) == 0) return false;
+        timestamp = sample.timestamp_ms;
+        return true;
+    }
+    
+    LogDecoder decoder;
+    TelemetryPacket packet;
+    if (decoder.decode(payload, length, packet) == 0) return false;
+    timestamp = packet.timestamp_ms;
+    return true;
+}
+
+void LogIndex::addBlock(uint32_t blockIndex, uint16_t version, uint16_t stream,
+                        const uint8_t* payload, size_t length) {
+    blocks = blockIndex + 1;
+    if (stream != LOG_STREAM_PACKETS || covered(blockIndex) || count >= LOG_INDEX_CAPACITY) {
+        return;
+    }
+    
+    uint32_t timestamp;
+    if (firstTimestamp(version, stream, payload, length, timestamp)) {
+        entries[count].timestamp = timestamp;
+        entries[count].blockIndex = blockIndex;
+        count++;
+    }
+}
+
+bool LogIndex::rebuild(File& file, uint32_t blockCount) {
+    reset();
+    
+    LogFileHeader header;
+    if (!file.seek(0) ||
+        file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+        header.magic != LOG_FILE_MAGIC || header.blockSectors == 0) {
+        return false;
+    }
+    
+    const uint32_t blockSize = header.blockSectors * LOG_SECTOR_SIZE;
+    uint8_t buffer[sizeof(LogBlockHeader) + LOG_MAX_RECORD_SIZE + sizeof(TelemetryPacket)];
+    
+    // Read block starts until each interval has its first packet block.
+    // Files before format 5 hold only packets, so that is one read per
+    // interval. A damaged block just leaves a gap in the index.
+    for (uint32_t block = 0; block < blockCount && count < LOG_INDEX_CAPACITY; block++) {
+        if (covered(block)) {
+            block = (block / LOG_INDEX_INTERVAL_BLOCKS + 1) * LOG_INDEX_INTERVAL_BLOCKS - 1;
+            continue;
+        }
+        if (!file.seek(LOG_SECTOR_SIZE + block * blockSize)) {
+            break;
+        }
+        size_t got = file.read(buffer, sizeof(buffer));
+        if (got < sizeof(LogBlockHeader)) {
+            break;
+        }
+        
+        LogBlockHeader blockHeader;
+        memcpy(&blockHeader, buffer, sizeof(blockHeader));
+        const uint16_t stream = header.version >= LOG_FORMAT_STREAMS ? blockHeader.stream
+                                                                     : (uint16_t)LOG_STREAM_PACKETS;
+        if (blockHeader.magic != LOG_BLOCK_MAGIC || blockHeader.blockIndex != block ||
+            stream != LOG_STREAM_PACKETS) {
+            continue;
+        }
+        
+        uint32_t timestamp;
+        if (firstTimestamp(header.version, stream, buffer + sizeof(LogBlockHeader),
+                           got - sizeof(LogBlockHeader), timestamp)) {
+            entries[count].timestamp = timestamp;
+            entries[count].blockIndex = block;
+            count++;
+        }
+    }
+    
+    blocks = blockCount;
+    return true;
+}
+
+size_t LogIndex::writeTo(File& file, uint32_t offset, uint32_t crcSeed) const {
+    const size_t entryBytes = count * sizeof(LogIndexEntry);
+    const size_t total = (entryBytes + sizeof(LogFooter) + LOG_SECTOR_SIZE - 1) /
+                         LOG_SECTOR_SIZE * LOG_SECTOR_SIZE;
+    
+    LogFooter footer;
+    footer.magic = LOG_FOOTER_MAGIC;
+    footer.indexOffset = offset;
+    footer.entryCount = count;
+    footer.blockCount = blocks;
+    uint32_t crc = crc32Update(crcSeed, entries, entryBytes);
+    footer.crc32 = crc32Update(crc, &footer, sizeof(footer) - sizeof(footer.crc32));
+    
+    if (!file.seek(offset) || file.write((const uint8_t*)entries, entryBytes) != entryBytes) {
+        return 0;
+    }
+    
+    static const uint8_t zeros[64] = {0};
+    size_t padding = total - entryBytes - sizeof(footer);
+    while (padding > 0) {
+        size_t chunk = min(padding, sizeof(zeros));
+        if (file.write(zeros, chunk) != chunk) return 0;
+        padding -= chunk;
+    }
+    
+    if (file.write((const uint8_t*)&footer, sizeof(footer)) != sizeof(footer)) {
+        return 0;
+    }
+    return total;
+}
@@ -0,0 +1,65 @@
+/**
+ * Log Time Index
+ *
+ * Collects the first timestamp of the first packet block in every run of
+ * LOG_INDEX_INTERVAL_BLOCKS blocks while a file is written, and appends
+ * the entries plus a LogFooter when the file is closed (see LogFormat.h).
+ * LogReader uses the footer to seek by time.
+ *
+ * rebuild() recreates the entries of a file that was never closed from
+ * its sampled blocks, so its index can be appended after the fact.
+ */
+
+#pragma once
+
+#include "LogFormat.h"
+#include <FS.h>
+
+class LogIndex {
+private:
+    LogIndexEntry entries[LOG_INDEX_CAPACITY];
+    size_t count = 0;
+    uint32_t blocks = 0;
+    
+    // Whether the interval blockIndex falls in already has its entry
+    bool covered(uint32_t blockIndex) const {
+        return count > 0 &&
+               entries[count - 1].blockIndex / LOG_INDEX_INTERVAL_BLOCKS ==
+               blockIndex / LOG_INDEX_INTERVAL_BLOCKS;
+    }
+    
+public:
+    void reset() {
+        count = 0;
+        blocks = 0;
+    }
+    
+    /**
+     * @brief Note a block that has been written
+     * @param payload Records of the block, after its LogBlockHeader
+     */
+    void addBlock(uint32_t blockIndex, uint16_t version, uint16_t stream,
+                  const uint8_t* payload, size_t length);
+    
+    /**
+     * @brief Recreate the entries of a file from its blocks
+     * @param blockCount Blocks holding data (see LogReader::findEnd())
+     * @return false if the file is not a log
+     */
+    bool rebuild(File& file, uint32_t blockCount);
+    
+    /**
+     * @brief Write entries and footer at a sector-aligned offset
+     * @return Bytes written (whole sectors), or 0 on error
+     */
+    size_t writeTo(File& file, uint32_t offset, uint32_t crcSeed) const;
+    
+    size_t getCount() const { return count; }
+    uint32_t getBlockCount() const { return blocks; }
+    
+    /**
+     * @brief Timestamp of the first record in a block's payload
+     */
+    static bool firstTimestamp(uint16_t version, uint16_t stream, const uint8_t* payload,
+                               size_t length, uint32_t& timestamp);
+};
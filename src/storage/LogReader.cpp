@@ -0,0 +1,474 @@
+#include "LogReader.h"
+#include "LogIndex.h"
+#include "../utils/Crc.h"
+
+bool LogReader::begin(File& logFile, uint16_t logStream) {
+    file = &logFile;
+    stream = logStream;
+    finished = true;
+    remaining = 0;
+    nextBlockIndex = 0;
+    blocksRead = 0;
+    corruptBlocks = 0;
+    skipBefore = 0;
+    indexed = false;
+    legacy = false;
+    dataStart = LOG_SECTOR_SIZE;
+    
+    // A format 1 header is shorter, and its file may be too
+    memset(&header, 0, sizeof(header));
+    if (!file->seek(0) ||
+        file->read((uint8_t*)&header, sizeof(header)) < LOG_LEGACY_HEADER_SIZE) {
+        return false;
+    }
+    if (header.magic == LOG_FILE_MAGIC && header.version == LOG_FORMAT_LEGACY) {
+        // No sequence or streams yet (those bytes are the first packet),
+        // and blockSectors was a reserved field
+        header.fileSequence = 0;
+        header.streams = 0;
+        if (header.packetSize != sizeof(TelemetryPacket) || !hasStream(stream)) {
+            return false;
+        }
+        legacy = true;
+        dataStart = LOG_LEGACY_HEADER_SIZE;
+        blockSize = sizeof(TelemetryPacket);
+        firstBlockIndex = 0;
+        blockLimit = file->size() > dataStart ? (file->size() - dataStart) / blockSize : 0;
+        nextBlockIndex = 0;
+        nextBlockOffset = dataStart;
+        finished = false;
+        return true;
+    }
+    if (header.magic != LOG_FILE_MAGIC ||
+        header.version < LOG_FORMAT_RAW || header.version > LOG_FORMAT_STREAMS ||
+        header.packetSize != sizeof(TelemetryPacket) || header.blockSectors == 0 ||
+        !hasStream(stream)) {
+        return false;
+    }
+    
+    blockSize = header.blockSectors * LOG_SECTOR_SIZE;
+    
+    // Slices start part-way through the original numbering
+    LogBlockHeader first;
+    firstBlockIndex = 0;
+    if (file->seek(LOG_SECTOR_SIZE) &&
+        file->read((uint8_t*)&first, sizeof(first)) == sizeof(first) &&
+        first.magic == LOG_BLOCK_MAGIC) {
+        firstBlockIndex = first.blockIndex;
+    }
+    
+    indexed = loadFooter();
+    if (indexed) {
+        blockLimit = footer.blockCount;
+    } else {
+        blockLimit = file->size() > LOG_SECTOR_SIZE ? (file->size() - LOG_SECTOR_SIZE) / blockSize : 0;
+    }
+    
+    nextBlockIndex = firstBlockIndex;
+    nextBlockOffset = LOG_SECTOR_SIZE;
+    finished = false;
+    return true;
+}
+
+bool LogReader::loadFooter() {
+    const uint32_t size = file->size();
+    if (size < LOG_SECTOR_SIZE + sizeof(footer) ||
+        !file->seek(size - sizeof(footer)) ||
+        file->read((uint8_t*)&footer, sizeof(footer)) != sizeof(footer)) {
+        return false;
+    }
+    
+    const uint32_t entryBytes = footer.entryCount * sizeof(LogIndexEntry);
+    if (footer.magic != LOG_FOOTER_MAGIC || footer.entryCount > LOG_INDEX_CAPACITY ||
+        footer.indexOffset < LOG_SECTOR_SIZE ||
+        footer.indexOffset + entryBytes + sizeof(footer) > size ||
+        footer.indexOffset < LOG_SECTOR_SIZE + footer.blockCount * blockSize) {
+        return false;
+    }
+    
+    // Verify the entries, streaming them through the stage buffer
+    if (!file->seek(footer.indexOffset)) {
+        return false;
+    }
+    uint32_t crc = logCrcSeed(header);
+    uint32_t left = entryBytes;
+    while (left > 0) {
+        size_t want = min((size_t)left, sizeof(stage));
+        if (file->read(stage, want) != want) {
+            return false;
+        }
+        crc = crc32Update(crc, stage, want);
+        left -= want;
+    }
+    crc = crc32Update(crc, &footer, sizeof(footer) - sizeof(footer.crc32));
+    return crc == footer.crc32;
+}
+
+bool LogReader::blockValid(const LogBlockHeader& block, uint32_t index) const {
+    const uint32_t payloadCapacity = header.blockSectors * LOG_SECTOR_SIZE - sizeof(block) -
+                                     (header.version >= LOG_FORMAT_CHECKED ? LOG_BLOCK_CRC_SIZE : 0);
+    const uint32_t payload = header.version == LOG_FORMAT_RAW ?
+                             block.packetCount * sizeof(TelemetryPacket) : block.payloadBytes;
+    const bool streamValid = header.version >= LOG_FORMAT_STREAMS ?
+                             block.stream < LOG_STREAM_COUNT : block.stream == sizeof(TelemetryPacket);
+    return block.magic == LOG_BLOCK_MAGIC && block.blockIndex == index &&
+           streamValid && payload <= payloadCapacity;
+}
+
+// Check the block's CRC trailer, streaming the block through the stage buffer
+bool LogReader::verifyBlock(uint32_t offset, uint32_t blockSize) {
+    if (!file->seek(offset)) {
+        return false;
+    }
+    
+    uint32_t crc = logCrcSeed(header);
+    uint32_t left = blockSize - LOG_BLOCK_CRC_SIZE;
+    while (left > 0) {
+        size_t want = min((size_t)left, sizeof(stage));
+        if (file->read(stage, want) != want) {
+            return false;
+        }
+        crc = crc32Update(crc, stage, want);
+        left -= want;
+    }
+    
+    uint32_t stored;
+    if (file->read((uint8_t*)&stored, sizeof(stored)) != sizeof(stored)) {
+        return false;
+    }
+    return stored == crc;
+}
+
+bool LogReader::loadNextBlock() {
+    if (legacy) {
+        if (nextBlockIndex >= blockLimit || !file->seek(nextBlockOffset)) {
+            finished = true;
+            return false;
+        }
+        nextBlockIndex++;
+        nextBlockOffset += blockSize;
+        blocksRead++;
+        remaining = 1;
+        return true;
+    }
+    
+    const bool checked = header.version >= LOG_FORMAT_CHECKED;
+    uint8_t badRun = 0;
+    
+    while (badRun <= MAX_CORRUPT_RUN) {
+        const uint32_t offset = nextBlockOffset;
+        const uint32_t index = nextBlockIndex;
+        LogBlockHeader block;
+        
+        if (!file->seek(offset) ||
+            file->read((uint8_t*)&block, sizeof(block)) != sizeof(block)) {
+            break;
+        }
+        nextBlockIndex++;
+        nextBlockOffset += blockSize;
+        
+        // The other stream's blocks are passed over unverified
+        const bool valid = blockValid(block, index);
+        if (valid && blockStream(block) != stream) {
+            corruptBlocks += badRun;
+            badRun = 0;
+            continue;
+        }
+        
+        if (valid && (!checked || verifyBlock(offset, blockSize))) {
+            // Only bad blocks followed by a good one count as corruption;
+            // a bad run at the end is just the unwritten tail
+            corruptBlocks += badRun;
+            blocksRead++;
+            
+            file->seek(offset + sizeof(block));
+            remaining = block.packetCount;
+            payloadLeft = header.version == LOG_FORMAT_RAW ?
+                          block.packetCount * sizeof(TelemetryPacket) : block.payloadBytes;
+            stagePos = stageLen = 0;
+            decoder.reset();
+            sampleDecoder.reset();
+            return true;
+        }
+        
+        // Without a CRC there is no telling damage from the tail
+        if (!checked) {
+            break;
+        }
+        badRun++;
+    }
+    
+    finished = true;
+    return false;
+}
+
+// Keep at least one worst-case record staged
+bool LogReader::fillStage() {
+    if (stageLen - stagePos < LOG_MAX_RECORD_SIZE && payloadLeft > 0) {
+        memmove(stage, stage + stagePos, stageLen - stagePos);
+        stageLen -= stagePos;
+        stagePos = 0;
+        
+        size_t want = min((size_t)payloadLeft, sizeof(stage) - stageLen);
+        size_t got = file->read(stage + stageLen, want);
+        stageLen += got;
+        payloadLeft -= got;
+        if (got != want) {
+            payloadLeft = 0;
+        }
+    }
+    return stageLen > stagePos;
+}
+
+bool LogReader::nextDelta(TelemetryPacket& packet) {
+    fillStage();
+    size_t used = decoder.decode(stage + stagePos, stageLen - stagePos, packet);
+    if (used == 0) {
+        return false;
+    }
+    stagePos += used;
+    return true;
+}
+
+// Make sure the current block has a record left
+bool LogReader::nextRecord() {
+    while (remaining == 0) {
+        if (finished || !loadNextBlock()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LogReader::next(TelemetryPacket& packet) {
+    if (stream != LOG_STREAM_PACKETS) {
+        return false;
+    }
+    
+    while (true) {
+        if (!nextRecord()) {
+            return false;
+        }
+        
+        bool ok = header.version <= LOG_FORMAT_RAW ?
+                  file->read((uint8_t*)&packet, sizeof(packet)) == sizeof(packet) :
+                  nextDelta(packet);
+        if (!ok) {
+            finished = true;
+            remaining = 0;
+            return false;
+        }
+        remaining--;
+        
+        // Format 1 has no block CRC; the packet's magic is all there is
+        if (legacy && packet.magic != PACKET_MAGIC) {
+            corruptBlocks++;
+            continue;
+        }
+        
+        if (packet.timestamp_ms >= skipBefore) {
+            skipBefore = 0;
+            return true;
+        }
+    }
+}
+
+bool LogReader::next(IMUData& sample) {
+    if (stream != LOG_STREAM_IMU) {
+        return false;
+    }
+    
+    while (true) {
+        if (!nextRecord()) {
+            return false;
+        }
+        
+        fillStage();
+        size_t used = sampleDecoder.decode(stage + stagePos, stageLen - stagePos, sample);
+        if (used == 0) {
+            finished = true;
+            remaining = 0;
+            return false;
+        }
+        stagePos += used;
+        remaining--;
+        
+        if (sample.timestamp_ms >= skipBefore) {
+            skipBefore = 0;
+            return true;
+        }
+    }
+}
+
+bool LogReader::readIndexEntry(uint32_t entry, LogIndexEntry& out) {
+    return file->seek(footer.indexOffset + entry * sizeof(out)) &&
+           file->read((uint8_t*)&out, sizeof(out)) == sizeof(out);
+}
+
+// Whether the first block of the stream in [block, end) starts before
+// timestampMs; found is that block. The scan passes over the other
+// stream's blocks and stops at the first invalid one.
+bool LogReader::blockStartsBefore(uint32_t block, uint32_t end, uint32_t timestampMs,
+                                  uint32_t& found) {
+    if (legacy) {
+        TelemetryPacket packet;
+        for (; block < end; block++) {
+            if (!file->seek(getBlockOffset(block)) ||
+                file->read((uint8_t*)&packet, sizeof(packet)) != sizeof(packet)) {
+                return false;
+            }
+            if (packet.magic == PACKET_MAGIC) {
+                found = block;
+                return packet.timestamp_ms < timestampMs;
+            }
+        }
+        return false;
+    }
+    
+    const size_t want = sizeof(LogBlockHeader) +
+                        (header.version == LOG_FORMAT_RAW ? sizeof(TelemetryPacket) : LOG_MAX_RECORD_SIZE);
+    
+    for (; block < end; block++) {
+        if (!file->seek(getBlockOffset(block))) {
+            return false;
+        }
+        size_t got = file->read(stage, want);
+        if (got < sizeof(LogBlockHeader)) {
+            return false;
+        }
+        
+        LogBlockHeader blockHeader;
+        memcpy(&blockHeader, stage, sizeof(blockHeader));
+        if (!blockValid(blockHeader, firstBlockIndex + block)) {
+            return false;
+        }
+        if (blockStream(blockHeader) != stream) {
+            continue;
+        }
+        
+        const uint32_t payload = header.version == LOG_FORMAT_RAW ?
+                                 blockHeader.packetCount * sizeof(TelemetryPacket) : blockHeader.payloadBytes;
+        const size_t length = min((size_t)payload, got - sizeof(blockHeader));
+        uint32_t timestamp;
+        found = block;
+        return LogIndex::firstTimestamp(header.version, stream, stage + sizeof(blockHeader), length,
+                                        timestamp) &&
+               timestamp < timestampMs;
+    }
+    return false;
+}
+
+uint32_t LogReader::findBlock(uint32_t timestampMs) {
+    uint32_t lo = 0;
+    uint32_t hi = blockLimit;
+    
+    // Narrow to one index interval: the last entry older than timestampMs
+    // and the one after it. The index only covers the packet stream.
+    if (indexed && footer.entryCount > 0 && stream == LOG_STREAM_PACKETS) {
+        LogIndexEntry entry;
+        uint32_t l = 0;
+        uint32_t r = footer.entryCount;
+        bool ok = true;
+        while (ok && l < r) {
+            uint32_t m = l + (r - l) / 2;
+            ok = readIndexEntry(m, entry);
+            if (ok && entry.timestamp < timestampMs) {
+                l = m + 1;
+            } else {
+                r = m;
+            }
+        }
+        if (ok) {
+            if (l == 0) {
+                return 0;
+            }
+            if (readIndexEntry(l - 1, entry)) lo = entry.blockIndex;
+            if (l < footer.entryCount && readIndexEntry(l, entry)) hi = entry.blockIndex;
+        }
+    }
+    
+    // Bisect the blocks: lo is a block of the stream that starts before
+    // timestampMs (or the first block), and nothing of the stream from hi
+    // on does
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        uint32_t found;
+        if (blockStartsBefore(mid, hi, timestampMs, found)) {
+            lo = found;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+bool LogReader::blockIntact(uint32_t block) {
+    if (legacy) {
+        TelemetryPacket packet;
+        return file->seek(getBlockOffset(block)) &&
+               file->read((uint8_t*)&packet, sizeof(packet)) == sizeof(packet) &&
+               packet.magic == PACKET_MAGIC;
+    }
+    
+    LogBlockHeader blockHeader;
+    const uint32_t offset = getBlockOffset(block);
+    if (!file->seek(offset) ||
+        file->read((uint8_t*)&blockHeader, sizeof(blockHeader)) != sizeof(blockHeader) ||
+        !blockValid(blockHeader, firstBlockIndex + block)) {
+        return false;
+    }
+    return header.version < LOG_FORMAT_CHECKED || verifyBlock(offset, blockSize);
+}
+
+uint32_t LogReader::findEnd() {
+    uint32_t lo = 0;
+    
+    while (true) {
+        // First slot at or after lo that is not intact, if the intact
+        // blocks form one run
+        uint32_t hi = blockLimit;
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (blockIntact(mid)) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        
+        // An intact block shortly after means lo is a hole, not the end
+        uint32_t resume = 0;
+        for (uint32_t k = lo + 1; k <= lo + MAX_CORRUPT_RUN && k < blockLimit; k++) {
+            if (blockIntact(k)) {
+                resume = k + 1;
+                break;
+            }
+        }
+        if (resume == 0) {
+            return lo;
+        }
+        lo = resume;
+    }
+}
+
+bool LogReader::seekBlock(uint32_t block) {
+    if (file == nullptr || blockSize == 0) {
+        return false;
+    }
+    
+    nextBlockIndex = firstBlockIndex + block;
+    nextBlockOffset = getBlockOffset(block);
+    remaining = 0;
+    stagePos = stageLen = 0;
+    finished = false;
+    skipBefore = 0;
+    return true;
+}
+
+bool LogReader::seek(uint32_t timestampMs) {
+    if (file == nullptr || blockSize == 0 || !seekBlock(findBlock(timestampMs))) {
+        return false;
+    }
+    skipBefore = timestampMs;
+    return true;
+}
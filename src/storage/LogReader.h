@@ -0,0 +1,153 @@
+/**
+ * Binary Log Reader
+ *
+ * Walks the blocks of a log file written by BinaryLogger and yields the
+ * records of one stream in order (fused packets by default, or raw IMU
+ * samples), decoding whichever record format the file header names.
+ * Blocks of the other stream are passed over by their header alone.
+ * Stops cleanly at the end of the written data, including the unwritten
+ * preallocated tail of a file that was never closed.
+ *
+ * Blocks of checked (format 4) logs are verified before any of their
+ * packets are returned. A damaged block is skipped; a run of more than
+ * MAX_CORRUPT_RUN bad blocks is taken as the end of the log.
+ *
+ * seek() jumps to a point in time: it bisects the footer's time index,
+ * then the blocks it brackets (or all blocks, for a file without an
+ * index or when reading IMU samples), so it costs O(log n) small reads
+ * rather than a scan.
+ *
+ * A file may start at any block index, so a run of whole blocks cut from
+ * a log behind its header sector (a time slice) reads like the original.
+ *
+ * Format 1 logs (from firmware before blocks) hold bare packets after a
+ * short header. They are read as if each packet were a block of its own,
+ * so next(), seek() and findEnd() work on them too; packets with a bad
+ * magic are skipped and counted as corrupt.
+ *
+ * Delta records are staged through a small buffer, so memory use does not
+ * depend on the block size.
+ */
+
+#pragma once
+
+#include "LogFormat.h"
+#include "LogCodec.h"
+#include <FS.h>
+
+class LogReader {
+public:
+    static constexpr uint8_t MAX_CORRUPT_RUN = 4;
+    
+private:
+    File* file = nullptr;
+    LogFileHeader header;
+    uint16_t stream = LOG_STREAM_PACKETS;
+    LogDecoder decoder;
+    LogSampleDecoder sampleDecoder;
+    uint32_t blockSize = 0;
+    uint32_t dataStart = LOG_SECTOR_SIZE;  // Offset of the first block
+    bool legacy = false;           // Format 1: one packet per "block"
+    uint32_t firstBlockIndex = 0;  // blockIndex of the file's first block
+    uint32_t blockLimit = 0;       // Block slots that can hold data
+    
+    // Time index (closed files only)
+    LogFooter footer;
+    bool indexed = false;
+    uint32_t skipBefore = 0;       // next() drops records older than this
+    
+    uint32_t nextBlockOffset = 0;
+    uint32_t nextBlockIndex = 0;
+    uint16_t remaining = 0;       // Records left in the current block
+    uint32_t payloadLeft = 0;     // Delta bytes of this block not yet staged
+    bool finished = true;
+    uint32_t blocksRead = 0;
+    uint32_t corruptBlocks = 0;
+    
+    // Staging buffer for delta records
+    uint8_t stage[4 * LOG_MAX_RECORD_SIZE];
+    size_t stagePos = 0;
+    size_t stageLen = 0;
+    
+    uint16_t blockStream(const LogBlockHeader& block) const {
+        return header.version >= LOG_FORMAT_STREAMS ? block.stream : (uint16_t)LOG_STREAM_PACKETS;
+    }
+    bool loadNextBlock();
+    bool blockValid(const LogBlockHeader& block, uint32_t index) const;
+    bool verifyBlock(uint32_t offset, uint32_t blockSize);
+    bool fillStage();
+    bool nextDelta(TelemetryPacket& packet);
+    bool nextRecord();
+    bool loadFooter();
+    bool readIndexEntry(uint32_t entry, LogIndexEntry& out);
+    bool blockStartsBefore(uint32_t block, uint32_t end, uint32_t timestampMs, uint32_t& found);
+    bool blockIntact(uint32_t block);
+    
+public:
+    /**
+     * @brief Validate the file header and position at the first record
+     * @param logFile Open log file (must outlive the reader)
+     * @param logStream Stream to read (LogStream)
+     * @return false if the file is not a supported log or has no such
+     *         stream
+     */
+    bool begin(File& logFile, uint16_t logStream = LOG_STREAM_PACKETS);
+    
+    /**
+     * @brief Read the next packet (packet stream)
+     * @return false at the end of the log
+     */
+    bool next(TelemetryPacket& packet);
+    
+    /**
+     * @brief Read the next raw IMU sample (IMU stream)
+     * @return false at the end of the log
+     */
+    bool next(IMUData& sample);
+    
+    /**
+     * @brief Position so that next() returns the first record at or after
+     *        timestampMs
+     */
+    bool seek(uint32_t timestampMs);
+    
+    /**
+     * @brief Position so that next() starts at a block (see findBlock())
+     */
+    bool seekBlock(uint32_t block);
+    
+    /**
+     * @brief Find the block where the stream's records from timestampMs on
+     *        start
+     * @return Position of the last block of the stream whose first record
+     *         is older than timestampMs (counted from the file's first
+     *         block), or 0
+     * @note Moves the file position; call seek() or begin() before next()
+     */
+    uint32_t findBlock(uint32_t timestampMs);
+    
+    /**
+     * @brief Find where the data of a file that was never closed ends
+     * @return Number of block slots up to the last intact block
+     * @note Bisects on whole-block validity (header and, for checked logs,
+     *       CRC), looking MAX_CORRUPT_RUN blocks past each candidate end so
+     *       a damaged block mid-file is not mistaken for the end. Moves the
+     *       file position like findBlock().
+     */
+    uint32_t findEnd();
+    
+    /**
+     * @brief Whether the file may hold records of a stream
+     */
+    bool hasStream(uint16_t logStream) const {
+        return header.version >= LOG_FORMAT_STREAMS ? (header.streams >> logStream) & 1
+                                                    : logStream == LOG_STREAM_PACKETS;
+    }
+    
+    uint32_t getBlockOffset(uint32_t block) const { return dataStart + block * blockSize; }
+    bool hasIndex() const { return indexed; }
+    bool isLegacy() const { return legacy; }
+    const LogFileHeader& getHeader() const { return header; }
+    uint32_t getBlocksRead() const { return blocksRead; }
+    uint32_t getCorruptBlocks() const { return corruptBlocks; }
+};
@@ -0,0 +1,78 @@
+#include "LogStorage.h"
+#include <SD.h>
+
+static constexpr uint64_t MB = 1024 * 1024;
+
+LogStorage::LogStorage() {
+    mutex = xSemaphoreCreateMutex();
+}
+
+LogStorage::~LogStorage() {
+    if (mutex) vSemaphoreDelete(mutex);
+}
+
+bool LogStorage::refresh() {
+    const uint64_t total = SD.totalBytes();
+    const uint64_t used = SD.usedBytes();
+    
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    known = total > 0 && used <= total;
+    totalBytes = known ? total : 0;
+    usedBytes = known ? used : 0;
+    reclaiming = false;
+    xSemaphoreGive(mutex);
+    return known;
+}
+
+void LogStorage::allocated(uint64_t bytes) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    usedBytes = min(usedBytes + bytes, totalBytes);
+    xSemaphoreGive(mutex);
+}
+
+void LogStorage::released(uint64_t bytes) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    usedBytes = bytes < usedBytes ? usedBytes - bytes : 0;
+    xSemaphoreGive(mutex);
+}
+
+uint64_t LogStorage::getFreeBytes() const {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    const uint64_t free = totalBytes - usedBytes;
+    xSemaphoreGive(mutex);
+    return free;
+}
+
+uint64_t LogStorage::getTotalBytes() const {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    const uint64_t total = totalBytes;
+    xSemaphoreGive(mutex);
+    return total;
+}
+
+bool LogStorage::needsReclaim(uint32_t fileBytes) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    const uint64_t free = totalBytes - usedBytes;
+    if (!known) {
+        reclaiming = false;
+    } else if (free < fileBytes + LOG_FREE_LOW_WATERMARK_MB * MB) {
+        reclaiming = true;
+    } else if (free >= fileBytes + LOG_FREE_HIGH_WATERMARK_MB * MB) {
+        reclaiming = false;
+    }
+    const bool reclaim = reclaiming;
+    xSemaphoreGive(mutex);
+    return reclaim;
+}
+
+uint32_t LogStorage::fileSize(uint32_t wanted) const {
+    if (!known) return wanted;
+    
+    const uint64_t free = getFreeBytes();
+    const uint64_t low = LOG_FREE_LOW_WATERMARK_MB * MB;
+    const uint64_t room = free > low ? (free - low) / LOG_SECTOR_SIZE * LOG_SECTOR_SIZE : 0;
+    if (room < LOG_MIN_FILE_BYTES) {
+        return 0;   // Never preallocate into the watermark
+    }
+    return (uint32_t)min<uint64_t>(room, wanted);
+}
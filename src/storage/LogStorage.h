@@ -0,0 +1,66 @@
+/**
+ * Log Storage
+ *
+ * Free space on the card, read from the filesystem once (refresh()) and
+ * then kept up to date from what the logger allocates and releases, so
+ * asking for it while recording never walks the FAT.
+ *
+ * Also decides retention: whether old logs must go before a new file is
+ * created (free-space watermarks, with hysteresis), and how big the new
+ * file can be if deleting is not enough.
+ *
+ * Figures are read and updated under a mutex, so other tasks can read
+ * them while the SD writer task updates them.
+ */
+
+#pragma once
+
+#include "../core/config.h"
+#include "LogFormat.h"
+
+static_assert(LOG_FREE_HIGH_WATERMARK_MB >= LOG_FREE_LOW_WATERMARK_MB,
+              "High free-space watermark must not be below the low one");
+static_assert(LOG_MIN_FILE_BYTES > LOG_SECTOR_SIZE + LOG_BLOCK_SIZE + LOG_INDEX_MAX_BYTES +
+                                   LOG_PREPARE_AHEAD_BYTES,
+              "Smallest log file must hold more than a block and its index");
+
+class LogStorage {
+private:
+    uint64_t totalBytes = 0;
+    uint64_t usedBytes = 0;
+    bool known = false;         // refresh() succeeded
+    bool reclaiming = false;    // Deleting down to the high watermark
+    SemaphoreHandle_t mutex = nullptr;
+    
+public:
+    LogStorage();
+    ~LogStorage();
+    
+    /**
+     * @brief Read total and used bytes from the filesystem
+     * @note Slow on large cards (walks the FAT); call at mount time only
+     */
+    bool refresh();
+    
+    // Bytes the logger added to or removed from the card
+    void allocated(uint64_t bytes);
+    void released(uint64_t bytes);
+    
+    uint64_t getFreeBytes() const;
+    uint64_t getTotalBytes() const;
+    
+    /**
+     * @brief Whether an old log should be deleted before a new file
+     *
+     * True once the new file would leave less than the low watermark free,
+     * and from then on until it would leave the high watermark free.
+     */
+    bool needsReclaim(uint32_t fileBytes);
+    
+    /**
+     * @brief Size to preallocate for a new file
+     * @return wanted, or what fits above the low watermark (sector
+     *         multiple), or 0 if that is less than LOG_MIN_FILE_BYTES
+     */
+    uint32_t fileSize(uint32_t wanted) const;
+};
@@ -1,9 +1,11 @@
 #include "WiFiTelemetry.h"
+#include "../storage/CsvExporter.h"
+#include "../storage/LogCatalog.h"
+#include "../storage/LogReader.h"
 #include <SD.h>
 
 WiFiTelemetry::WiFiTelemetry() {
     statsMutex = xSemaphoreCreateMutex();
-    packetMutex = xSemaphoreCreateMutex();
     
     // Default config
     strncpy(apSSID, WIFI_AP_SSID, 32);
@@ -18,13 +20,13 @@ WiFiTelemetry::WiFiTelemetry() {
     udpPort = TELEMETRY_UDP_PORT;
     udpBroadcast = true;
     
-    memset(&lastPacket, 0, sizeof(lastPacket));
+    memset(&imuBufferStats, 0, sizeof(imuBufferStats));
+    memset(&gpsBufferStats, 0, sizeof(gpsBufferStats));
 }
 
 WiFiTelemetry::~WiFiTelemetry() {
     end();
     if (statsMutex) vSemaphoreDelete(statsMutex);
-    if (packetMutex) vSemaphoreDelete(packetMutex);
 }
 
 bool WiFiTelemetry::begin(WiFiMode wifiMode) {
@@ -301,6 +303,27 @@ String WiFiTelemetry::getContentType(const String& filename) {
     return "text/plain";
 }
 
+static String bufferStatsJson(const RingBufferStats& s) {
+    String json = "{";
+    json += "\"drops\":" + String(s.drops) + ",";
+    json += "\"overwrites\":" + String(s.overwrites) + ",";
+    json += "\"highWater\":" + String(s.highWater) + ",";
+    json += "\"capacity\":" + String(s.capacity);
+    json += "}";
+    return json;
+}
+
+static String latencyJson(const LatencySummary& s) {
+    String json = "{";
+    json += "\"count\":" + String(s.count) + ",";
+    json += "\"p50\":" + String(s.p50) + ",";
+    json += "\"p99\":" + String(s.p99) + ",";
+    json += "\"p999\":" + String(s.p999) + ",";
+    json += "\"max\":" + String(s.max);
+    json += "}";
+    return json;
+}
+
 void WiFiTelemetry::handleStatus() {
     String json = "{";
     json += "\"mode\":\"" + getModeString() + "\",";
@@ -308,38 +331,54 @@ void WiFiTelemetry::handleStatus() {
     json += "\"rssi\":" + String(getSignalStrength()) + ",";
     json += "\"connected\":" + String(isConnected() ? "true" : "false") + ",";
     json += "\"version\":\"" + String(FIRMWARE_VERSION) + "\",";
-    json += "\"heap\":" + String(ESP.getFreeHeap());
-    json += "}";
+    json += "\"heap\":" + String(ESP.getFreeHeap()) + ",";
+    
+    xSemaphoreTake(statsMutex, portMAX_DELAY);
+    RingBufferStats imu = imuBufferStats;
+    RingBufferStats gps = gpsBufferStats;
+    xSemaphoreGive(statsMutex);
+    
+    json += "\"buffers\":{";
+    json += "\"imu\":" + bufferStatsJson(imu) + ",";
+    json += "\"gps\":" + bufferStatsJson(gps);
+    json += "},";
+    
+    // Histograms are lock-free; read them directly (microseconds)
+    json += "\"latency_us\":{";
+    for (size_t i = 0; i < latencyStageCount; i++) {
+        if (i > 0) json += ",";
+        json += "\"" + String(latencyStageNames[i]) + "\":" + latencyJson(latencyStages[i].summarize());
+    }
+    json += "}}";
     webServer->send(200, "application/json", json);
 }
 
 void WiFiTelemetry::handleLiveData() {
-    xSemaphoreTake(packetMutex, portMAX_DELAY);
+    // Snapshot first so building the JSON never holds up stream()
+    const TelemetryPacket packet = lastPacket.read();
     
     // Convert last packet to JSON
     String json = "{";
-    json += "\"timestamp\":" + String(lastPacket.timestamp_ms) + ",";
-    json += "\"sequence\":" + String(lastPacket.sequence) + ",";
+    json += "\"timestamp\":" + String(packet.timestamp_ms) + ",";
+    json += "\"sequence\":" + String(packet.sequence) + ",";
     json += "\"imu\":{";
-    json += "\"ax\":" + String(lastPacket.imu.accel_x, 3) + ",";
-    json += "\"ay\":" + String(lastPacket.imu.accel_y, 3) + ",";
-    json += "\"az\":" + String(lastPacket.imu.accel_z, 3) + ",";
-    json += "\"gx\":" + String(lastPacket.imu.gyro_x, 3) + ",";
-    json += "\"gy\":" + String(lastPacket.imu.gyro_y, 3) + ",";
-    json += "\"gz\":" + String(lastPacket.imu.gyro_z, 3) + ",";
-    json += "\"temp\":" + String(lastPacket.imu.temperature, 1);
+    json += "\"ax\":" + String(packet.imu.accel_x, 3) + ",";
+    json += "\"ay\":" + String(packet.imu.accel_y, 3) + ",";
+    json += "\"az\":" + String(packet.imu.accel_z, 3) + ",";
+    json += "\"gx\":" + String(packet.imu.gyro_x, 3) + ",";
+    json += "\"gy\":" + String(packet.imu.gyro_y, 3) + ",";
+    json += "\"gz\":" + String(packet.imu.gyro_z, 3) + ",";
+    json += "\"temp\":" + String(packet.imu.temperature, 1);
     json += "},\"gps\":{";
-    json += "\"lat\":" + String(lastPacket.gps.latitude, 6) + ",";
-    json += "\"lon\":" + String(lastPacket.gps.longitude, 6) + ",";
-    json += "\"alt\":" + String(lastPacket.gps.altitude, 1) + ",";
-    json += "\"speed\":" + String(lastPacket.gps.speed_kmh, 1) + ",";
-    json += "\"heading\":" + String(lastPacket.gps.heading, 1) + ",";
-    json += "\"sats\":" + String(lastPacket.gps.satellites) + ",";
-    json += "\"fix\":" + String(lastPacket.gps.fix_quality);
+    json += "\"lat\":" + String(packet.gps.latitude, 6) + ",";
+    json += "\"lon\":" + String(packet.gps.longitude, 6) + ",";
+    json += "\"alt\":" + String(packet.gps.altitude, 1) + ",";
+    json += "\"speed\":" + String(packet.gps.speed_kmh, 1) + ",";
+    json += "\"heading\":" + String(packet.gps.heading, 1) + ",";
+    json += "\"sats\":" + String(packet.gps.satellites) + ",";
+    json += "\"fix\":" + String(packet.gps.fix_quality);
     json += "}}";
     
-    xSemaphoreGive(packetMutex);
-    
     webServer->send(200, "application/json", json);
 }
 
@@ -370,20 +409,36 @@ void WiFiTelemetry::handleListFiles() {
         <p><a href="/">← Back to Dashboard</a></p>
 )";
 
-    // List binary files
-    for (uint8_t i = 0; i < MAX_LOG_FILES; i++) {
+    // List binary files, from the catalog when the logger has one
+    for (uint16_t i = 0; i < MAX_LOG_FILES; i++) {
         char filename[32];
-        snprintf(filename, sizeof(filename), "%s_%03d%s", LOG_FILE_BASE, i, LOG_EXT);
-        if (SD.exists(filename)) {
+        LogCatalog::slotFilename(i, filename, sizeof(filename));
+        
+        LogCatalogEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        if (logCatalog) {
+            entry = logCatalog->get(i);
+        } else if (SD.exists(filename)) {
             File f = SD.open(filename);
-            size_t size = f.size();
+            entry.used = 1;
+            entry.sizeBytes = f.size();
             f.close();
-            
+        }
+        
+        if (entry.used) {
+            size_t size = entry.sizeBytes;
             String sizeStr;
             if (size < 1024) sizeStr = String(size) + " B";
             else if (size < 1024*1024) sizeStr = String(size/1024) + " KB";
             else sizeStr = String(size/(1024*1024)) + " MB";
             
+            if (entry.lastTimestamp > entry.firstTimestamp) {
+                sizeStr += " &middot; " + String((entry.lastTimestamp - entry.firstTimestamp) / 1000) + " s";
+            }
+            if (entry.packetCount > 0) {
+                sizeStr += " &middot; " + String(entry.packetCount) + " packets";
+            }
+            
             html += "<div class='file'>";
             html += "<div class='file-info'>";
             html += "<div class='file-name'>" + String(filename) + "</div>";
@@ -423,68 +478,50 @@ void WiFiTelemetry::handleConvertBinary() {
         return;
     }
     
-    // Convert to CSV
-    String csvData;
-    if (!convertBinaryToCSV(filename.c_str(), csvData)) {
-        webServer->send(500, "text/plain", "Conversion failed");
+    File file = SD.open(filename, FILE_READ);
+    if (!file) {
+        webServer->send(500, "text/plain", "Cannot open file");
         return;
     }
     
-    String csvFilename = filename.substring(0, filename.lastIndexOf('.')) + ".csv";
-    
-    webServer->sendHeader("Content-Disposition", "attachment; filename=\"" + csvFilename.substring(1) + "\"");
-    webServer->send(200, "text/csv", csvData);
+    uint32_t startMs, endMs;
+    getTimeRange(startMs, endMs);
+    sendLogCSV(file, filename, startMs, endMs);
+    file.close();
 }
 
-bool WiFiTelemetry::convertBinaryToCSV(const char* binPath, String& csvOutput) {
-    File binFile = SD.open(binPath, FILE_READ);
-    if (!binFile) return false;
+// Print sink that sends each write as one chunk of the current response
+class ChunkedResponse : public Print {
+private:
+    WebServer& server;
     
-    // Read header
-    struct __attribute__((packed)) LogFileHeader {
-        uint32_t magic;
-        uint16_t version;
-        uint32_t createdTime;
-        uint16_t packetSize;
-        uint16_t reserved;
-        char vehicleId[16];
-        char driverName[16];
-        uint32_t crc32;
-    } header;
+public:
+    explicit ChunkedResponse(WebServer& webServer) : server(webServer) {}
     
-    if (binFile.read((uint8_t*)&header, sizeof(header)) != sizeof(header)) {
-        binFile.close();
-        return false;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        server.sendContent((const char*)buffer, size);
+        return size;
+    }
+};
+
+void WiFiTelemetry::sendLogCSV(File& file, const String& filename, uint32_t startMs, uint32_t endMs) {
+    LogReader reader;
+    if (!reader.begin(file)) {
+        webServer->send(400, "text/plain", "Not a log file");
+        return;
     }
     
-    // CSV header
-    csvOutput = "Timestamp,AccelX,AccelY,AccelZ,GyroX,GyroY,GyroZ,TempC,";
-    csvOutput += "Latitude,Longitude,Altitude,SpeedKmh,Heading,Satellites,FixQuality\n";
+    // Rows go out as they are formatted; the CSV is never held whole
+    String csvFilename = filename.substring(1, filename.lastIndexOf('.')) + ".csv";
+    webServer->sendHeader("Content-Disposition", "attachment; filename=\"" + csvFilename + "\"");
+    webServer->setContentLength(CONTENT_LENGTH_UNKNOWN);
+    webServer->send(200, "text/csv", "");
     
-    // Read packets
-    TelemetryPacket packet;
-    while (binFile.read((uint8_t*)&packet, sizeof(packet)) == sizeof(packet)) {
-        if (packet.magic != PACKET_MAGIC) continue;
-        
-        csvOutput += String(packet.timestamp_ms) + ",";
-        csvOutput += String(packet.imu.accel_x, 3) + ",";
-        csvOutput += String(packet.imu.accel_y, 3) + ",";
-        csvOutput += String(packet.imu.accel_z, 3) + ",";
-        csvOutput += String(packet.imu.gyro_x, 3) + ",";
-        csvOutput += String(packet.imu.gyro_y, 3) + ",";
-        csvOutput += String(packet.imu.gyro_z, 3) + ",";
-        csvOutput += String(packet.imu.temperature, 1) + ",";
-        csvOutput += String(packet.gps.latitude, 6) + ",";
-        csvOutput += String(packet.gps.longitude, 6) + ",";
-        csvOutput += String(packet.gps.altitude, 1) + ",";
-        csvOutput += String(packet.gps.speed_kmh, 1) + ",";
-        csvOutput += String(packet.gps.heading, 1) + ",";
-        csvOutput += String(packet.gps.satellites) + ",";
-        csvOutput += String(packet.gps.fix_quality) + "\n";
-    }
-    
-    binFile.close();
-    return true;
+    ChunkedResponse response(*webServer);
+    CsvExporter exporter(response);
+    exporter.exportLog(file, startMs, endMs);
+    webServer->sendContent("");
 }
 
 void WiFiTelemetry::handleDownload() {
@@ -507,11 +544,73 @@ void WiFiTelemetry::handleDownload() {
         return;
     }
     
+    uint32_t startMs, endMs;
+    if (getTimeRange(startMs, endMs)) {
+        sendLogSlice(file, filename, startMs, endMs);
+        file.close();
+        return;
+    }
+    
     webServer->sendHeader("Content-Disposition", "attachment; filename=\"" + filename.substring(1) + "\"");
     webServer->streamFile(file, "application/octet-stream");
     file.close();
 }
 
+bool WiFiTelemetry::getTimeRange(uint32_t& startMs, uint32_t& endMs) {
+    startMs = webServer->hasArg("t0") ? webServer->arg("t0").toInt() : 0;
+    endMs = webServer->hasArg("t1") ? webServer->arg("t1").toInt() : UINT32_MAX;
+    return webServer->hasArg("t0") || webServer->hasArg("t1");
+}
+
+// Send the header sector plus the whole blocks covering [startMs, endMs].
+// The result is itself a readable log; the blocks are located through the
+// file's time index, so nothing outside the slice is read.
+void WiFiTelemetry::sendLogSlice(File& file, const String& filename, uint32_t startMs, uint32_t endMs) {
+    LogReader reader;
+    if (!reader.begin(file)) {
+        webServer->send(400, "text/plain", "Not a log file");
+        return;
+    }
+    if (reader.isLegacy()) {
+        webServer->send(400, "text/plain", "Format 1 logs cannot be sliced; export them as CSV");
+        return;
+    }
+    
+    const uint32_t endKey = endMs == UINT32_MAX ? endMs : endMs + 1;
+    uint32_t firstBlock = reader.findBlock(startMs);
+    uint32_t lastBlock = reader.findBlock(endKey);
+    
+    // Raw IMU blocks are interleaved with the packet blocks; cover both
+    LogReader imuReader;
+    if (imuReader.begin(file, LOG_STREAM_IMU)) {
+        firstBlock = min(firstBlock, imuReader.findBlock(startMs));
+        lastBlock = max(lastBlock, imuReader.findBlock(endKey));
+    }
+    const uint32_t sliceStart = reader.getBlockOffset(firstBlock);
+    const uint32_t sliceEnd = min((uint32_t)file.size(), reader.getBlockOffset(lastBlock + 1));
+    const uint32_t sliceBytes = sliceEnd > sliceStart ? sliceEnd - sliceStart : 0;
+    
+    String sliceName = filename.substring(1, filename.lastIndexOf('.')) + "_" +
+                       String(startMs) + "-" + String(endMs) + LOG_EXT;
+    webServer->sendHeader("Content-Disposition", "attachment; filename=\"" + sliceName + "\"");
+    webServer->setContentLength(LOG_SECTOR_SIZE + sliceBytes);
+    webServer->send(200, "application/octet-stream", "");
+    
+    uint8_t chunk[LOG_SECTOR_SIZE];
+    file.seek(0);
+    size_t got = file.read(chunk, sizeof(chunk));
+    webServer->sendContent((const char*)chunk, got);
+    
+    file.seek(sliceStart);
+    uint32_t left = sliceBytes;
+    while (left > 0) {
+        got = file.read(chunk, min((uint32_t)sizeof(chunk), left));
+        if (got == 0) break;
+        webServer->sendContent((const char*)chunk, got);
+        left -= got;
+    }
+}
+
 void WiFiTelemetry::handleConfig() {
     // Handle configuration updates via POST
     if (webServer->hasArg("ssid")) {
@@ -527,9 +626,7 @@ void WiFiTelemetry::handleNotFound() {
 }
 
 void WiFiTelemetry::updateLiveData(const TelemetryPacket& packet) {
-    xSemaphoreTake(packetMutex, portMAX_DELAY);
-    memcpy(&lastPacket, &packet, sizeof(packet));
-    xSemaphoreGive(packetMutex);
+    lastPacket.write(packet);
 }
 
 void WiFiTelemetry::setAPConfig(const char* ssid, const char* password) {
@@ -546,6 +643,17 @@ void WiFiTelemetry::setSTAConfig(const char* ssid, const char* password) {
     staPassword[31] = '\0';
 }
 
+void WiFiTelemetry::setLogCatalog(const LogCatalog* catalog) {
+    logCatalog = catalog;
+}
+
+void WiFiTelemetry::setLatencyStages(const LatencyHistogram* stages, const char* const* names,
+                                     size_t count) {
+    latencyStages = stages;
+    latencyStageNames = names;
+    latencyStageCount = count;
+}
+
 void WiFiTelemetry::setUDPEndpoint(const char* ip, uint16_t port, bool broadcast) {
     udpAddress.fromString(ip);
     udpPort = port;
@@ -656,6 +764,13 @@ void WiFiTelemetry::resetStats() {
     xSemaphoreGive(statsMutex);
 }
 
+void WiFiTelemetry::updateBufferStats(const RingBufferStats& imu, const RingBufferStats& gps) {
+    xSemaphoreTake(statsMutex, portMAX_DELAY);
+    imuBufferStats = imu;
+    gpsBufferStats = gps;
+    xSemaphoreGive(statsMutex);
+}
+
 void WiFiTelemetry::handleWebClient() {
     if (webServer) {
         webServer->handleClient();
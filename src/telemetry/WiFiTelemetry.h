@@ -13,6 +13,9 @@
 #pragma once
 
 #include "../core/config.h"
+#include "../utils/RingBuffer.h"
+#include "../utils/SeqLock.h"
+#include "../utils/LatencyHistogram.h"
 #include <WiFi.h>
 #include <WiFiUdp.h>
 #include <WebServer.h>
@@ -45,6 +48,8 @@ struct TelemetryStats {
     float avgLatency;
 };
 
+class LogCatalog;
+
 class WiFiTelemetry {
 private:
     WiFiMode mode = WiFiMode::OFF;
@@ -62,21 +67,30 @@ private:
     uint16_t udpPort;
     bool udpBroadcast;
     
+    // Log file list, owned by the logger
+    const LogCatalog* logCatalog = nullptr;
+    
+    // Pipeline latency histograms, owned and recorded by the tasks
+    const LatencyHistogram* latencyStages = nullptr;
+    const char* const* latencyStageNames = nullptr;
+    size_t latencyStageCount = 0;
+    
     // TCP clients
     static const int MAX_TCP_CLIENTS = 4;
     WiFiClient tcpClients[MAX_TCP_CLIENTS];
     
     // Statistics
     TelemetryStats stats;
+    RingBufferStats imuBufferStats;
+    RingBufferStats gpsBufferStats;
     SemaphoreHandle_t statsMutex = nullptr;
     
     // Rate limiting
     uint32_t lastPacketTime = 0;
     uint32_t minIntervalMs = 50;  // Max 20Hz
     
-    // Current telemetry data for web API
-    TelemetryPacket lastPacket;
-    SemaphoreHandle_t packetMutex = nullptr;
+    // Current telemetry data for web API (written by stream(), read by HTTP handlers)
+    SeqLock<TelemetryPacket> lastPacket;
     
     // Web server handlers
     void setupWebServer();
@@ -95,8 +109,12 @@ private:
     String getContentType(const String& filename);
     bool serveFile(const String& path);
     
-    // Binary to CSV conversion
-    bool convertBinaryToCSV(const char* binPath, String& csvOutput);
+    // Binary to CSV conversion, streamed as a chunked response
+    void sendLogCSV(File& file, const String& filename, uint32_t startMs, uint32_t endMs);
+    
+    // Time slices ("t0"/"t1" request args, in ms)
+    bool getTimeRange(uint32_t& startMs, uint32_t& endMs);
+    void sendLogSlice(File& file, const String& filename, uint32_t startMs, uint32_t endMs);
     
 public:
     WiFiTelemetry();
@@ -109,6 +127,8 @@ public:
     void setAPConfig(const char* ssid, const char* password);
     void setSTAConfig(const char* ssid, const char* password);
     void setUDPEndpoint(const char* ip, uint16_t port, bool broadcast = true);
+    void setLogCatalog(const LogCatalog* catalog);
+    void setLatencyStages(const LatencyHistogram* stages, const char* const* names, size_t count);
     
     // Main streaming function
     bool stream(const TelemetryPacket& packet);
@@ -130,6 +150,7 @@ public:
     String getModeString() const;
     TelemetryStats getStats();
     void resetStats();
+    void updateBufferStats(const RingBufferStats& imu, const RingBufferStats& gps);
     
     // Web interface
     void handleWebClient();
@@ -0,0 +1,214 @@
+/**
+ * Lock-Free Fixed-Block Pool with Reference-Counted Handles
+ *
+ * A static array of N blocks of T. allocate() hands out a 4-byte handle with
+ * one reference; every holder calls release() when done and the block goes
+ * back on the free list when the last reference is dropped. Blocks are never
+ * copied, so a packet can be written once and passed around by handle.
+ *
+ * Features:
+ * - No heap: storage is part of the pool object
+ * - Lock-free allocate/retain/release, safe across tasks and cores
+ * - Handles carry a generation count, so tryRetain() on a stale handle
+ *   fails instead of resurrecting a recycled block
+ * - Low-water, allocation-failure and stale-handle counters for sizing
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * @brief Pool occupancy counters
+ */
+struct BlockPoolStats {
+    uint32_t capacity;        // Total blocks
+    uint32_t available;       // Blocks currently free
+    uint32_t lowWater;        // Fewest free blocks seen
+    uint32_t allocFailures;   // allocate() calls that found the pool empty
+    uint32_t staleRetains;    // tryRetain() calls on handles already recycled
+};
+
+/**
+ * @brief Fixed-block pool template
+ * @tparam T Block type
+ * @tparam N Number of blocks (at most 65534)
+ */
+template<typename T, size_t N>
+class BlockPool {
+    static_assert(N > 0 && N < 0xFFFF, "Block index must fit in 16 bits");
+
+public:
+    // generation << 16 | block index
+    typedef uint32_t Handle;
+    static constexpr Handle INVALID_HANDLE = 0xFFFFFFFF;
+
+private:
+    static constexpr uint32_t INDEX_MASK = 0xFFFF;
+    static constexpr uint32_t REF_MASK = 0xFFFF;
+    static constexpr uint16_t END_OF_LIST = 0xFFFF;
+    
+    struct Block {
+        std::atomic<uint32_t> state;      // generation << 16 | reference count
+        std::atomic<uint16_t> nextFree;   // Free-list link
+        T item;
+    };
+    
+    Block blocks[N];
+    
+    // Treiber stack of free blocks; the upper half is an ABA tag
+    std::atomic<uint32_t> freeHead;
+    std::atomic<uint32_t> freeCount;
+    std::atomic<uint32_t> lowWater;
+    std::atomic<uint32_t> allocFailures;
+    std::atomic<uint32_t> staleRetains;
+    
+    void pushFree(uint16_t index) {
+        uint32_t head = freeHead.load(std::memory_order_relaxed);
+        uint32_t next;
+        
+        // Count first so concurrent allocate() calls never see it underflow
+        freeCount.fetch_add(1, std::memory_order_relaxed);
+        do {
+            blocks[index].nextFree.store(head & INDEX_MASK, std::memory_order_relaxed);
+            next = ((head + 0x10000) & ~INDEX_MASK) | index;
+        } while (!freeHead.compare_exchange_weak(head, next, std::memory_order_release,
+                                                 std::memory_order_relaxed));
+    }
+    
+    bool popFree(uint16_t& index) {
+        uint32_t head = freeHead.load(std::memory_order_acquire);
+        uint32_t next;
+        do {
+            if ((head & INDEX_MASK) == END_OF_LIST) {
+                return false;
+            }
+            const uint16_t link = blocks[head & INDEX_MASK].nextFree.load(std::memory_order_relaxed);
+            next = ((head + 0x10000) & ~INDEX_MASK) | link;
+        } while (!freeHead.compare_exchange_weak(head, next, std::memory_order_acquire,
+                                                 std::memory_order_acquire));
+        index = head & INDEX_MASK;
+        return true;
+    }
+
+public:
+    BlockPool() {
+        freeHead.store(END_OF_LIST, std::memory_order_relaxed);
+        freeCount.store(0, std::memory_order_relaxed);
+        allocFailures.store(0, std::memory_order_relaxed);
+        staleRetains.store(0, std::memory_order_relaxed);
+        for (size_t i = N; i-- > 0;) {
+            blocks[i].state.store(0, std::memory_order_relaxed);
+            pushFree((uint16_t)i);
+        }
+        lowWater.store(N, std::memory_order_relaxed);
+    }
+    
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+    
+    /**
+     * @brief Take a free block
+     * @return Handle holding one reference, or INVALID_HANDLE if the pool is empty
+     */
+    Handle allocate() {
+        uint16_t index;
+        if (!popFree(index)) {
+            allocFailures.fetch_add(1, std::memory_order_relaxed);
+            return INVALID_HANDLE;
+        }
+    
+        const uint32_t free = freeCount.fetch_sub(1, std::memory_order_relaxed) - 1;
+        if (free < lowWater.load(std::memory_order_relaxed)) {
+            lowWater.store(free, std::memory_order_relaxed);
+        }
+    
+        // New generation, one reference
+        const uint32_t generation = (blocks[index].state.load(std::memory_order_relaxed) >> 16) + 1;
+        const uint32_t state = (generation << 16) | 1;
+        blocks[index].state.store(state, std::memory_order_relaxed);
+        return (state & ~REF_MASK) | index;
+    }
+    
+    /**
+     * @brief Access a block (caller must hold a reference)
+     */
+    T& get(Handle h) {
+        return blocks[h & INDEX_MASK].item;
+    }
+    
+    const T& get(Handle h) const {
+        return blocks[h & INDEX_MASK].item;
+    }
+    
+    /**
+     * @brief Add a reference (caller must already hold one)
+     */
+    void retain(Handle h) {
+        blocks[h & INDEX_MASK].state.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    /**
+     * @brief Add a reference to a handle the caller does not own yet
+     *
+     * For handles read from shared storage: fails if the block has been
+     * freed (or freed and reused) since the handle was issued.
+     *
+     * @return true if the caller now holds a reference
+     */
+    bool tryRetain(Handle h) {
+        std::atomic<uint32_t>& state = blocks[h & INDEX_MASK].state;
+        uint32_t s = state.load(std::memory_order_relaxed);
+        do {
+            if ((s >> 16) != (h >> 16) || (s & REF_MASK) == 0) {
+                staleRetains.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        } while (!state.compare_exchange_weak(s, s + 1, std::memory_order_acquire,
+                                              std::memory_order_relaxed));
+        return true;
+    }
+    
+    /**
+     * @brief Drop a reference; the block is freed with the last one
+     */
+    void release(Handle h) {
+        const uint16_t index = h & INDEX_MASK;
+        const uint32_t prev = blocks[index].state.fetch_sub(1, std::memory_order_acq_rel);
+        if ((prev & REF_MASK) == 1) {
+            pushFree(index);
+        }
+    }
+    
+    /**
+     * @brief Number of free blocks
+     */
+    size_t available() const {
+        return freeCount.load(std::memory_order_relaxed);
+    }
+    
+    /**
+     * @brief Snapshot of occupancy counters
+     */
+    BlockPoolStats getStats() const {
+        BlockPoolStats s;
+        s.capacity = N;
+        s.available = freeCount.load(std::memory_order_relaxed);
+        s.lowWater = lowWater.load(std::memory_order_relaxed);
+        s.allocFailures = allocFailures.load(std::memory_order_relaxed);
+        s.staleRetains = staleRetains.load(std::memory_order_relaxed);
+        return s;
+    }
+    
+    /**
+     * @brief Get pool capacity
+     */
+    static constexpr size_t capacity() {
+        return N;
+    }
+};
+
+template<typename T, size_t N>
+constexpr typename BlockPool<T, N>::Handle BlockPool<T, N>::INVALID_HANDLE;
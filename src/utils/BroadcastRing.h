@@ -0,0 +1,299 @@
+/**
+ * Single-Producer Multi-Consumer Broadcast Ring
+ *
+ * Disruptor-style ring: the producer writes each item once into shared
+ * storage and every registered consumer reads it through its own cursor.
+ * The producer never waits for consumers; a consumer that falls more than
+ * Size items behind loses the oldest items and has them counted as overruns.
+ *
+ * Reads are validated seqlock-style against a claim counter the producer
+ * advances (with a release fence) before overwriting a slot, so a torn copy
+ * is always detected and discarded.
+ *
+ * Each consumer can block in waitForItems() until its own backlog reaches a
+ * watermark; publish() wakes it through its task notification.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <algorithm>
+#include <atomic>
+#include "RingBuffer.h"
+
+/**
+ * @brief Per-consumer counters
+ */
+struct BroadcastConsumerStats {
+    const char* name;
+    uint32_t consumed;        // Items delivered to this consumer
+    uint32_t overruns;        // Items lost because the producer lapped the cursor
+    uint32_t skipped;         // Items deliberately skipped by latest()
+    uint32_t lag;             // Items published but not yet read
+    uint32_t maxLag;          // Worst lag observed at read time
+};
+
+/**
+ * @brief Broadcast ring buffer template
+ * @tparam T Type of elements stored (should be trivially copyable)
+ * @tparam Size Buffer size (must be power of 2)
+ * @tparam MaxConsumers Maximum number of independent cursors
+ */
+template<typename T, size_t Size, size_t MaxConsumers>
+class BroadcastRing {
+    static_assert((Size & (Size - 1)) == 0, "Size must be a power of 2");
+    static_assert(MaxConsumers > 0, "At least one consumer required");
+
+private:
+    static constexpr uint32_t mask = Size - 1;
+
+    struct Cursor {
+        alignas(RING_BUFFER_CACHE_LINE) std::atomic<uint32_t> next;  // Next sequence to read
+        std::atomic<uint32_t> consumed;
+        std::atomic<uint32_t> overruns;
+        std::atomic<uint32_t> skipped;
+        std::atomic<uint32_t> maxLag;
+        const char* name;
+        RingWaiter waiter;
+    };
+
+    // Producer state. claimed runs ahead of published while a slot is written.
+    alignas(RING_BUFFER_CACHE_LINE) std::atomic<uint32_t> claimed{0};
+    std::atomic<uint32_t> published{0};
+
+    alignas(RING_BUFFER_CACHE_LINE) T slots[Size];
+
+    Cursor cursors[MaxConsumers];
+    std::atomic<uint32_t> consumerCount{0};
+
+    // Number of leading items in [first, first + count) that may have been
+    // overwritten while they were being copied
+    uint32_t tornPrefix(uint32_t first, uint32_t count) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint32_t c = claimed.load(std::memory_order_relaxed);
+        uint32_t distance = c - first;
+        if (distance <= Size) return 0;
+        return std::min(distance - (uint32_t)Size, count);
+    }
+
+    void recordLag(Cursor& cur, uint32_t lag) {
+        if (lag > cur.maxLag.load(std::memory_order_relaxed)) {
+            cur.maxLag.store(lag, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    BroadcastRing() {
+        for (size_t i = 0; i < MaxConsumers; i++) {
+            cursors[i].next.store(0, std::memory_order_relaxed);
+            cursors[i].consumed.store(0, std::memory_order_relaxed);
+            cursors[i].overruns.store(0, std::memory_order_relaxed);
+            cursors[i].skipped.store(0, std::memory_order_relaxed);
+            cursors[i].maxLag.store(0, std::memory_order_relaxed);
+            cursors[i].name = nullptr;
+        }
+    }
+
+    BroadcastRing(const BroadcastRing&) = delete;
+    BroadcastRing& operator=(const BroadcastRing&) = delete;
+
+    /**
+     * @brief Register a new consumer cursor
+     *
+     * The cursor starts at the current end of the stream, so a consumer only
+     * sees items published after it registered.
+     *
+     * @param name Label used in statistics (must outlive the ring)
+     * @return Consumer id, or -1 if all MaxConsumers cursors are taken
+     */
+    int registerConsumer(const char* name) {
+        uint32_t id = consumerCount.load(std::memory_order_relaxed);
+        do {
+            if (id >= MaxConsumers) return -1;
+        } while (!consumerCount.compare_exchange_weak(id, id + 1, std::memory_order_acq_rel));
+
+        cursors[id].name = name;
+        cursors[id].next.store(published.load(std::memory_order_acquire), std::memory_order_release);
+        return (int)id;
+    }
+
+    /**
+     * @brief Publish an item to all consumers (producer side, never blocks)
+     * @param item Item to publish
+     */
+    void publish(const T& item) {
+        T evicted;
+        publish(item, evicted);
+    }
+
+    /**
+     * @brief Publish an item and hand back the one it displaced
+     *
+     * Lets the producer reclaim resources owned by ring entries (e.g. pool
+     * handles) once they fall out of the consumers' reach.
+     *
+     * @param item Item to publish
+     * @param evicted Receives the item that dropped out of the history
+     * @return true if an item was evicted (the ring had wrapped)
+     */
+    bool publish(const T& item, T& evicted) {
+        const uint32_t seq = published.load(std::memory_order_relaxed);
+        const bool wrapped = seq >= Size;
+        if (wrapped) {
+            evicted = slots[seq & mask];  // Only the producer writes slots
+        }
+
+        // Claim the slot before touching it so readers can detect the overwrite
+        claimed.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slots[seq & mask] = item;
+        published.store(seq + 1, std::memory_order_release);
+        
+        const uint32_t consumers = consumerCount.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < consumers; i++) {
+            cursors[i].waiter.notify(seq + 1 - cursors[i].next.load(std::memory_order_relaxed));
+        }
+        return wrapped;
+    }
+
+    /**
+     * @brief Copy up to maxItems unread items for one consumer
+     * @param id Consumer id from registerConsumer()
+     * @param items Destination array (receives oldest first)
+     * @param maxItems Capacity of destination array
+     * @return Number of items copied (0 if the consumer is caught up)
+     */
+    size_t pollN(int id, T* items, size_t maxItems) {
+        Cursor& cur = cursors[id];
+
+        while (true) {
+            uint32_t next = cur.next.load(std::memory_order_relaxed);
+            const uint32_t end = published.load(std::memory_order_acquire);
+            uint32_t avail = end - next;
+            if (avail == 0 || maxItems == 0) return 0;
+
+            recordLag(cur, avail);
+
+            // Producer already lapped this cursor: jump to the oldest live item
+            if (avail > Size) {
+                cur.overruns.fetch_add(avail - Size, std::memory_order_relaxed);
+                next += avail - Size;
+                avail = Size;
+            }
+
+            const uint32_t n = std::min((uint32_t)maxItems, avail);
+            const uint32_t start = next & mask;
+            const uint32_t firstRun = std::min(n, (uint32_t)Size - start);
+            std::copy(&slots[start], &slots[start] + firstRun, items);
+            std::copy(&slots[0], &slots[0] + (n - firstRun), items + firstRun);
+
+            // Drop anything the producer overwrote during the copy
+            const uint32_t torn = tornPrefix(next, n);
+            if (torn > 0) {
+                cur.overruns.fetch_add(torn, std::memory_order_relaxed);
+                std::copy(items + torn, items + n, items);
+            }
+
+            cur.next.store(next + n, std::memory_order_relaxed);
+            if (n > torn) {
+                cur.consumed.fetch_add(n - torn, std::memory_order_relaxed);
+                return n - torn;
+            }
+        }
+    }
+
+    /**
+     * @brief Read the next unread item for one consumer
+     * @return true if an item was copied
+     */
+    bool poll(int id, T& item) {
+        return pollN(id, &item, 1) == 1;
+    }
+
+    /**
+     * @brief Read the newest item, skipping any backlog
+     *
+     * For consumers that only care about current state (e.g. streaming).
+     * Skipped items are counted separately from overruns.
+     *
+     * @return true if there was an unread item
+     */
+    bool latest(int id, T& item) {
+        Cursor& cur = cursors[id];
+
+        while (true) {
+            const uint32_t next = cur.next.load(std::memory_order_relaxed);
+            const uint32_t end = published.load(std::memory_order_acquire);
+            if (end == next) return false;
+
+            recordLag(cur, end - next);
+
+            const uint32_t seq = end - 1;
+            item = slots[seq & mask];
+            if (tornPrefix(seq, 1) > 0) {
+                continue;  // Lapped mid-copy; retry on the new newest item
+            }
+
+            cur.skipped.fetch_add(seq - next, std::memory_order_relaxed);
+            cur.consumed.fetch_add(1, std::memory_order_relaxed);
+            cur.next.store(end, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    /**
+     * @brief Block until a consumer has at least minItems unread items
+     * @param id Consumer id (must be called from that consumer's task)
+     * @param minItems Watermark to wait for
+     * @param timeoutTicks Maximum time to block
+     * @return true if the watermark was reached, false on timeout
+     */
+    bool waitForItems(int id, size_t minItems, TickType_t timeoutTicks = portMAX_DELAY) {
+        return cursors[id].waiter.wait(minItems, timeoutTicks, [this, id]() { return pending(id); });
+    }
+    
+    /**
+     * @brief Number of items published but not yet read by a consumer
+     */
+    uint32_t pending(int id) const {
+        return published.load(std::memory_order_acquire) -
+               cursors[id].next.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Snapshot of one consumer's counters
+     */
+    BroadcastConsumerStats getConsumerStats(int id) const {
+        const Cursor& cur = cursors[id];
+        BroadcastConsumerStats s;
+        s.name = cur.name;
+        s.consumed = cur.consumed.load(std::memory_order_relaxed);
+        s.overruns = cur.overruns.load(std::memory_order_relaxed);
+        s.skipped = cur.skipped.load(std::memory_order_relaxed);
+        s.lag = pending(id);
+        s.maxLag = cur.maxLag.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    /**
+     * @brief Number of registered consumers
+     */
+    size_t getConsumerCount() const {
+        return consumerCount.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Total items published since start
+     */
+    uint32_t getPublishedCount() const {
+        return published.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Get buffer capacity (history visible to a consumer)
+     */
+    static constexpr size_t capacity() {
+        return Size;
+    }
+};
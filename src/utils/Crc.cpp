@@ -0,0 +1,106 @@
+#include "Crc.h"
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include <esp_rom_crc.h>
+#endif
+
+namespace {
+
+constexpr uint32_t CRC32_POLY = 0xEDB88320;  // Reflected 0x04C11DB7
+
+// table[0] is the classic byte table; table[k][b] is the CRC of byte b
+// followed by k zero bytes, so eight lookups cover eight bytes at once
+struct Crc32Tables {
+    uint32_t table[8][256];
+
+    Crc32Tables() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ (CRC32_POLY & (0 - (crc & 1)));
+            }
+            table[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; i++) {
+            for (int k = 1; k < 8; k++) {
+                table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF];
+            }
+        }
+    }
+};
+
+const Crc32Tables& tables() {
+    static const Crc32Tables instance;
+    return instance;
+}
+
+}  // namespace
+
+uint32_t crc32Bytewise(uint32_t crc, const void* data, size_t length) {
+    const uint32_t (&t)[256] = tables().table[0];
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc = t[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// Assumes a little-endian target (ESP32, x86, ARM)
+uint32_t crc32Slice8(uint32_t crc, const void* data, size_t length) {
+    const uint32_t (&t)[8][256] = tables().table;
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+    crc = ~crc;
+
+    // Byte steps until aligned, so the word loads below are cheap
+    while (length > 0 && ((uintptr_t)bytes & 3) != 0) {
+        crc = t[0][(crc ^ *bytes++) & 0xFF] ^ (crc >> 8);
+        length--;
+    }
+
+    while (length >= 8) {
+        uint32_t lo, hi;
+        memcpy(&lo, bytes, 4);
+        memcpy(&hi, bytes + 4, 4);
+        lo ^= crc;
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^
+              t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^
+              t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+        bytes += 8;
+        length -= 8;
+    }
+
+    while (length-- > 0) {
+        crc = t[0][(crc ^ *bytes++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+#if defined(ESP_PLATFORM)
+uint32_t crc32Rom(uint32_t crc, const void* data, size_t length) {
+    return esp_rom_crc32_le(crc, static_cast<const uint8_t*>(data), length);
+}
+#endif
+
+uint32_t crc32Update(uint32_t crc, const void* data, size_t length) {
+#if defined(ESP_PLATFORM)
+    return crc32Rom(crc, data, length);
+#else
+    return crc32Slice8(crc, data, length);
+#endif
+}
+
+uint16_t crc16Ccitt(const void* data, size_t length, uint16_t crc) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+    for (size_t i = 0; i < length; i++) {
+        uint8_t x = (crc >> 8) ^ bytes[i];
+        x ^= x >> 4;
+        crc = (crc << 8) ^ ((uint16_t)x << 12) ^ ((uint16_t)x << 5) ^ x;
+    }
+    return crc;
+}
@@ -0,0 +1,46 @@
+/**
+ * CRC Engine
+ *
+ * CRC-32 (IEEE 802.3, the zlib/PNG polynomial) and CRC-16/CCITT-FALSE.
+ *
+ * crc32Update() is the one to call. On the ESP32 it uses the ROM routine
+ * (esp_rom_crc32_le), which needs no table in RAM; everywhere else it uses
+ * a slicing-by-8 table walk that handles eight bytes per step. The
+ * byte-at-a-time and slicing versions are exposed as well so tests and
+ * benchmarks can compare the paths against each other.
+ *
+ * CRC-32 values chain like zlib's crc32(): start from 0 and feed the
+ * previous result back in to continue over more data.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Continue a CRC-32 over more data (fastest path for this target)
+ * @param crc Result of the previous call, or 0 to start
+ */
+uint32_t crc32Update(uint32_t crc, const void* data, size_t length);
+
+// Reference implementation: one table lookup per byte
+uint32_t crc32Bytewise(uint32_t crc, const void* data, size_t length);
+
+// Software path: eight table lookups per 8-byte step (8KB of tables,
+// built on first use)
+uint32_t crc32Slice8(uint32_t crc, const void* data, size_t length);
+
+#if defined(ESP_PLATFORM)
+// ESP32 ROM routine
+uint32_t crc32Rom(uint32_t crc, const void* data, size_t length);
+#endif
+
+inline uint32_t crc32(const void* data, size_t length) {
+    return crc32Update(0, data, length);
+}
+
+/**
+ * @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), table-free
+ */
+uint16_t crc16Ccitt(const void* data, size_t length, uint16_t crc = 0xFFFF);
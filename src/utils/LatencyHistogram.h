@@ -0,0 +1,154 @@
+/**
+ * Lock-Free Log-Scale Latency Histogram
+ *
+ * Counts microsecond durations into fixed buckets: exact below 32us, then
+ * 16 linear buckets per power of two, so every bucket is within 1/16
+ * (6.25%) of the values it holds. Anything beyond ~16.7s lands in the last
+ * bucket. record() is a few relaxed atomic adds, so any number of tasks (or
+ * cores) can record into one histogram while another summarizes it.
+ *
+ * Features:
+ * - Fixed size (1.3KB), no heap, no locks
+ * - p50/p99/p999 and exact min/max from summarize()
+ * - reset() to start a new measurement window
+ *
+ * Summaries taken while records land are approximate by those records.
+ * Records racing a reset() may survive it or be lost.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * @brief Percentiles of a histogram, in microseconds
+ *
+ * Percentiles are bucket upper bounds (never below the true value), capped
+ * at the largest value recorded. All zero when nothing was recorded.
+ */
+struct LatencySummary {
+    uint32_t count;
+    uint32_t min;
+    uint32_t p50;
+    uint32_t p99;
+    uint32_t p999;
+    uint32_t max;
+};
+
+class LatencyHistogram {
+public:
+    static constexpr uint32_t SUB_BUCKET_BITS = 4;
+    static constexpr uint32_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr uint32_t RANGE_BITS = 24;        // Values below 2^24 us are resolved
+    // Resolved buckets, then one for everything beyond
+    static constexpr size_t BUCKET_COUNT = (RANGE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + 1;
+    
+private:
+    std::atomic<uint32_t> buckets[BUCKET_COUNT];
+    std::atomic<uint32_t> minValue;
+    std::atomic<uint32_t> maxValue;
+    
+public:
+    LatencyHistogram() {
+        reset();
+    }
+    
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+    
+    /**
+     * @brief Bucket holding a value
+     */
+    static size_t bucketFor(uint32_t us) {
+        if (us < 2 * SUB_BUCKETS) {
+            return us;
+        }
+        // Top SUB_BUCKET_BITS + 1 bits select the bucket within the octave
+        const uint32_t shift = (31 - __builtin_clz(us)) - SUB_BUCKET_BITS;
+        const size_t index = (shift + 1) * SUB_BUCKETS + ((us >> shift) - SUB_BUCKETS);
+        return index < BUCKET_COUNT ? index : BUCKET_COUNT - 1;
+    }
+    
+    /**
+     * @brief Largest value counted into a bucket (UINT32_MAX for the overflow)
+     */
+    static uint32_t bucketUpperBound(size_t index) {
+        if (index >= BUCKET_COUNT - 1) {
+            return UINT32_MAX;
+        }
+        if (index < 2 * SUB_BUCKETS) {
+            return index;
+        }
+        const uint32_t shift = index / SUB_BUCKETS - 1;
+        const uint32_t lower = (uint32_t)(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+        return lower + (1u << shift) - 1;
+    }
+    
+    /**
+     * @brief Count one duration (any task or core, never blocks)
+     */
+    void record(uint32_t us) {
+        buckets[bucketFor(us)].fetch_add(1, std::memory_order_relaxed);
+        
+        uint32_t seen = minValue.load(std::memory_order_relaxed);
+        while (us < seen && !minValue.compare_exchange_weak(seen, us, std::memory_order_relaxed)) {}
+        seen = maxValue.load(std::memory_order_relaxed);
+        while (us > seen && !maxValue.compare_exchange_weak(seen, us, std::memory_order_relaxed)) {}
+    }
+    
+    /**
+     * @brief Number of values recorded
+     */
+    uint32_t count() const {
+        uint32_t total = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            total += buckets[i].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+    
+    /**
+     * @brief Percentiles of everything recorded since the last reset
+     */
+    LatencySummary summarize() const {
+        LatencySummary s = {0, 0, 0, 0, 0, 0};
+        s.count = count();
+        if (s.count == 0) {
+            return s;
+        }
+        s.min = minValue.load(std::memory_order_relaxed);
+        s.max = maxValue.load(std::memory_order_relaxed);
+        
+        // Rank of each percentile, rounded up so p999 of 10 values is the max
+        const uint32_t ranks[3] = {
+            (uint32_t)(((uint64_t)s.count * 500 + 999) / 1000),
+            (uint32_t)(((uint64_t)s.count * 990 + 999) / 1000),
+            (uint32_t)(((uint64_t)s.count * 999 + 999) / 1000)
+        };
+        uint32_t* values[3] = {&s.p50, &s.p99, &s.p999};
+        
+        // Counts only grow between the two passes, so every rank is reached
+        uint32_t seen = 0;
+        size_t next = 0;
+        for (size_t i = 0; i < BUCKET_COUNT && next < 3; i++) {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            while (next < 3 && seen >= ranks[next]) {
+                *values[next++] = min(bucketUpperBound(i), s.max);
+            }
+        }
+        return s;
+    }
+    
+    /**
+     * @brief Start over (concurrent records may survive or be lost)
+     */
+    void reset() {
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            buckets[i].store(0, std::memory_order_relaxed);
+        }
+        minValue.store(UINT32_MAX, std::memory_order_relaxed);
+        maxValue.store(0, std::memory_order_relaxed);
+    }
+};
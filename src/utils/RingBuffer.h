@@ -1,18 +1,157 @@
 /**
- * Thread-Safe Ring Buffer for RTOS
+ * Thread-Safe Ring Buffers for RTOS
  * 
- * Lock-free ring buffer using atomic operations for single-producer/single-consumer
- * scenarios. Falls back to mutex for multi-producer cases.
+ * SPSCRingBuffer is a lock-free ring buffer using atomic acquire/release indices
+ * for single-producer/single-consumer data flow (task-to-task or ISR-to-task).
+ * RingBuffer falls back to a mutex for multi-producer or multi-consumer cases.
+ * 
+ * Both support waitForItems(): the consumer blocks on its FreeRTOS task
+ * notification until a watermark is reached, and the producer wakes it from
+ * push(). Consumers no longer need to poll with vTaskDelay().
+ * 
+ * When full, a buffer either rejects the new item or evicts the oldest one
+ * (OverflowPolicy). Either way the loss is counted in RingBufferStats rather
+ * than reported from the producer's hot path.
  */
 
 #pragma once
 
 #include <Arduino.h>
+#include <algorithm>
+#include <atomic>
+#include <stdint.h>
 #include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include <freertos/semphr.h>
 
+// Producer and consumer indices are kept on separate cache lines so the two
+// cores do not invalidate each other's line on every push/pop
+#ifndef RING_BUFFER_CACHE_LINE
+#define RING_BUFFER_CACHE_LINE 64
+#endif
+
+/**
+ * @brief Contiguous run of elements inside a ring buffer's storage
+ */
+template<typename T>
+struct RingSpan {
+    T* data;
+    size_t count;
+};
+
+/**
+ * @brief Readable region of a ring buffer
+ * 
+ * The occupied region wraps at most once, so it is described by at most two
+ * contiguous runs: first (oldest elements) then second. second.count is 0
+ * when the region does not wrap.
+ */
+template<typename T>
+struct RingSpanPair {
+    RingSpan<T> first;
+    RingSpan<T> second;
+    
+    size_t total() const { return first.count + second.count; }
+};
+
 /**
- * @brief Thread-safe ring buffer template
+ * @brief What push() does when the buffer is full
+ */
+enum class OverflowPolicy : uint8_t {
+    REJECT_NEWEST,      // push() fails and the new item is dropped
+    OVERWRITE_OLDEST    // push() evicts the oldest unread item to make room
+};
+
+/**
+ * @brief Overflow accounting for one buffer
+ */
+struct RingBufferStats {
+    uint32_t drops;           // New items rejected (REJECT_NEWEST)
+    uint32_t overwrites;      // Unread items evicted (OVERWRITE_OLDEST)
+    uint32_t highWater;       // Highest fill level seen
+    uint32_t capacity;        // Usable slots
+};
+
+/**
+ * @brief Watermark wakeup for one waiting consumer task
+ * 
+ * The consumer arms a watermark and blocks in ulTaskNotifyTake(); the
+ * producer checks the fill level after each publish and gives the task
+ * notification once the watermark is reached. The watermark is disarmed by
+ * the notifying producer, so each wait costs at most one notification.
+ * 
+ * Arming and publishing are separated by full fences on both sides, so
+ * either the consumer sees the new fill level or the producer sees the
+ * armed watermark - a wakeup is never lost.
+ */
+class RingWaiter {
+private:
+    std::atomic<TaskHandle_t> task{nullptr};
+    std::atomic<uint32_t> watermark{0};  // 0 = nobody waiting
+    
+    bool claim(size_t level) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint32_t w = watermark.load(std::memory_order_relaxed);
+        return w != 0 && level >= w &&
+               watermark.compare_exchange_strong(w, 0, std::memory_order_acq_rel);
+    }
+    
+public:
+    /**
+     * @brief Wake the waiting task if level reached its watermark (producer side)
+     */
+    void notify(size_t level) {
+        if (claim(level)) {
+            xTaskNotifyGive(task.load(std::memory_order_relaxed));
+        }
+    }
+    
+    /**
+     * @brief ISR variant of notify()
+     */
+    void notifyFromISR(size_t level, BaseType_t* pxHigherPriorityTaskWoken) {
+        if (claim(level)) {
+            vTaskNotifyGiveFromISR(task.load(std::memory_order_relaxed), pxHigherPriorityTaskWoken);
+        }
+    }
+    
+    /**
+     * @brief Block the calling task until level() >= items or timeout (consumer side)
+     * @param items Watermark to wait for
+     * @param timeoutTicks Maximum time to block (portMAX_DELAY = forever)
+     * @param level Callable returning the current fill level
+     * @return true if the watermark was reached
+     */
+    template<typename LevelFn>
+    bool wait(size_t items, TickType_t timeoutTicks, LevelFn level) {
+        const TickType_t start = xTaskGetTickCount();
+        
+        while (level() < items) {
+            const TickType_t elapsed = xTaskGetTickCount() - start;
+            if (elapsed >= timeoutTicks) {
+                return false;
+            }
+            
+            task.store(xTaskGetCurrentTaskHandle(), std::memory_order_relaxed);
+            watermark.store((uint32_t)items, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            
+            if (level() < items) {
+                ulTaskNotifyTake(pdTRUE, timeoutTicks - elapsed);
+            }
+            watermark.store(0, std::memory_order_relaxed);
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Mutex-protected ring buffer template
+ * 
+ * Safe for any number of producers and consumers, but every operation takes
+ * a FreeRTOS mutex, so it cannot be used from an ISR. Prefer SPSCRingBuffer
+ * for fixed producer/consumer pairs.
+ * 
  * @tparam T Type of elements stored
  * @tparam Size Buffer size (must be power of 2)
  */
@@ -26,9 +165,19 @@ private:
     volatile size_t tail = 0;  // Read index
     SemaphoreHandle_t mutex = nullptr;
     const size_t mask = Size - 1;
+    RingWaiter waiter;
+    OverflowPolicy policy;
+    RingBufferStats stats;
+    
+    void recordLevel(size_t level) {
+        if (level > stats.highWater) stats.highWater = level;
+    }
     
 public:
-    RingBuffer() {
+    explicit RingBuffer(OverflowPolicy overflowPolicy = OverflowPolicy::REJECT_NEWEST)
+        : policy(overflowPolicy) {
+        memset(&stats, 0, sizeof(stats));
+        stats.capacity = Size - 1;
         mutex = xSemaphoreCreateMutex();
     }
     
@@ -49,31 +198,22 @@ public:
         
         size_t nextHead = (head + 1) & mask;
         if (nextHead == tail) {
-            xSemaphoreGive(mutex);
-            return false;  // Buffer full
+            if (policy == OverflowPolicy::REJECT_NEWEST) {
+                stats.drops++;
+                xSemaphoreGive(mutex);
+                return false;  // Buffer full
+            }
+            tail = (tail + 1) & mask;  // Evict oldest
+            stats.overwrites++;
         }
         
         buffer[head] = item;
         head = nextHead;
+        size_t level = (head - tail) & mask;
+        recordLevel(level);
         
         xSemaphoreGive(mutex);
-        return true;
-    }
-    
-    /**
-     * @brief Push item from ISR context
-     * @param item Item to push
-     * @param pxHigherPriorityTaskWoken Task switch flag
-     * @return true if successful
-     */
-    bool pushFromISR(const T& item, BaseType_t* pxHigherPriorityTaskWoken = nullptr) {
-        size_t nextHead = (head + 1) & mask;
-        if (nextHead == tail) {
-            return false;  // Buffer full
-        }
-        
-        buffer[head] = item;
-        head = nextHead;
+        waiter.notify(level);
         return true;
     }
     
@@ -100,6 +240,117 @@ public:
         return true;
     }
     
+    /**
+     * @brief Push up to count items in a single critical section
+     * @param items Items to push (oldest first)
+     * @param count Number of items
+     * @param timeoutTicks Timeout in RTOS ticks for acquiring the mutex
+     * @return Number of items accepted (count unless REJECT_NEWEST filled up)
+     */
+    size_t pushN(const T* items, size_t count, TickType_t timeoutTicks = portMAX_DELAY) {
+        if (xSemaphoreTake(mutex, timeoutTicks) != pdTRUE) {
+            return 0;
+        }
+        
+        const size_t accepted = count;
+        size_t space = Size - 1 - ((head - tail) & mask);
+        size_t n = count;
+        if (policy == OverflowPolicy::REJECT_NEWEST) {
+            n = std::min(count, space);
+            stats.drops += count - n;
+        } else {
+            // Only the newest Size-1 items can survive; evict to make room
+            if (n > Size - 1) {
+                stats.overwrites += n - (Size - 1);
+                items += n - (Size - 1);
+                n = Size - 1;
+            }
+            if (n > space) {
+                tail = (tail + (n - space)) & mask;
+                stats.overwrites += n - space;
+            }
+        }
+        
+        size_t firstRun = std::min(n, Size - head);
+        std::copy(items, items + firstRun, &buffer[head]);
+        std::copy(items + firstRun, items + n, &buffer[0]);
+        head = (head + n) & mask;
+        size_t level = (head - tail) & mask;
+        recordLevel(level);
+        
+        xSemaphoreGive(mutex);
+        if (n > 0) waiter.notify(level);
+        return policy == OverflowPolicy::REJECT_NEWEST ? n : accepted;
+    }
+    
+    /**
+     * @brief Pop up to maxItems items in a single critical section
+     * @param items Destination array (receives oldest first)
+     * @param maxItems Capacity of destination array
+     * @param timeoutTicks Timeout in RTOS ticks for acquiring the mutex
+     * @return Number of items popped
+     */
+    size_t popN(T* items, size_t maxItems, TickType_t timeoutTicks = portMAX_DELAY) {
+        if (xSemaphoreTake(mutex, timeoutTicks) != pdTRUE) {
+            return 0;
+        }
+        
+        size_t n = std::min(maxItems, (size_t)((head - tail) & mask));
+        size_t firstRun = std::min(n, Size - tail);
+        std::copy(&buffer[tail], &buffer[tail] + firstRun, items);
+        std::copy(&buffer[0], &buffer[0] + (n - firstRun), items + firstRun);
+        tail = (tail + n) & mask;
+        
+        xSemaphoreGive(mutex);
+        return n;
+    }
+    
+    /**
+     * @brief Get in-place view of the oldest items without removing them
+     * 
+     * With REJECT_NEWEST, producers never write into the returned region, so
+     * it stays valid until consume() is called. With OVERWRITE_OLDEST a
+     * producer may reclaim it; use popN() instead. Only one consumer may use
+     * peek/consume.
+     * 
+     * @param maxItems Upper bound on the number of items returned
+     * @return Up to two spans covering the oldest items
+     */
+    RingSpanPair<const T> peekContiguous(size_t maxItems = SIZE_MAX) {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        size_t t = tail;
+        size_t n = std::min(maxItems, (size_t)((head - t) & mask));
+        xSemaphoreGive(mutex);
+        
+        size_t firstRun = std::min(n, Size - t);
+        RingSpanPair<const T> spans = {
+            { &buffer[t], firstRun },
+            { &buffer[0], n - firstRun }
+        };
+        return spans;
+    }
+    
+    /**
+     * @brief Release items previously returned by peekContiguous()
+     * @param count Number of items to drop from the front
+     */
+    void consume(size_t count) {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        count = std::min(count, (size_t)((head - tail) & mask));
+        tail = (tail + count) & mask;
+        xSemaphoreGive(mutex);
+    }
+    
+    /**
+     * @brief Block until at least minItems are buffered (single consumer task)
+     * @param minItems Watermark to wait for
+     * @param timeoutTicks Maximum time to block
+     * @return true if the watermark was reached, false on timeout
+     */
+    bool waitForItems(size_t minItems, TickType_t timeoutTicks = portMAX_DELAY) {
+        return waiter.wait(minItems, timeoutTicks, [this]() { return count(); });
+    }
+    
     /**
      * @brief Check if buffer is empty
      */
@@ -137,6 +388,27 @@ public:
         xSemaphoreGive(mutex);
     }
     
+    /**
+     * @brief Snapshot of overflow counters
+     */
+    RingBufferStats getStats() {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        RingBufferStats snapshot = stats;
+        xSemaphoreGive(mutex);
+        return snapshot;
+    }
+    
+    /**
+     * @brief Reset overflow counters (high-water restarts at the current level)
+     */
+    void resetStats() {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        stats.drops = 0;
+        stats.overwrites = 0;
+        stats.highWater = count();
+        xSemaphoreGive(mutex);
+    }
+    
     /**
      * @brief Get buffer capacity
      */
@@ -145,6 +417,353 @@ public:
     }
 };
 
+/**
+ * @brief Lock-free single-producer/single-consumer ring buffer
+ * 
+ * Exactly one context may push and exactly one may pop. head and tail are
+ * free-running counters: the producer publishes a slot with a release store
+ * to head after writing it, the consumer frees a slot by advancing tail after
+ * reading it, and each side observes the other with an acquire load. No mutex
+ * is involved, so push() and pushFromISR() are safe from interrupt context.
+ * 
+ * With OVERWRITE_OLDEST the producer evicts the oldest item by advancing tail
+ * with a compare-and-swap before reusing its slot. The consumer advances tail
+ * with a compare-and-swap too, so an item evicted while it was being copied is
+ * detected and discarded instead of returned torn.
+ * 
+ * Unlike RingBuffer, all Size slots are usable.
+ * 
+ * @tparam T Type of elements stored (should be trivially copyable)
+ * @tparam Size Buffer size (must be power of 2)
+ */
+template<typename T, size_t Size>
+class SPSCRingBuffer {
+    static_assert((Size & (Size - 1)) == 0, "Size must be a power of 2");
+    static_assert(Size >= 2, "Size must be at least 2");
+    
+private:
+    static constexpr size_t mask = Size - 1;
+    
+    // Producer line: head and the counters only the producer writes
+    alignas(RING_BUFFER_CACHE_LINE) std::atomic<size_t> head{0};
+    std::atomic<uint32_t> drops{0};
+    std::atomic<uint32_t> overwrites{0};
+    std::atomic<uint32_t> highWater{0};
+    OverflowPolicy policy;
+    
+    // Consumer line: tail (also advanced by the producer when evicting)
+    alignas(RING_BUFFER_CACHE_LINE) std::atomic<size_t> tail{0};
+    size_t peekTail = 0;  // tail seen by the last peekContiguous()
+    
+    alignas(RING_BUFFER_CACHE_LINE) T buffer[Size];
+    RingWaiter waiter;
+    
+    bool tryPush(const T& item, size_t& level) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        size_t t = tail.load(std::memory_order_acquire);
+        if (h - t >= Size) {
+            if (policy == OverflowPolicy::REJECT_NEWEST) {
+                drops.fetch_add(1, std::memory_order_relaxed);
+                return false;  // Buffer full
+            }
+            // Evict the oldest item, unless the consumer frees a slot first
+            if (tail.compare_exchange_strong(t, t + 1, std::memory_order_acq_rel,
+                                             std::memory_order_acquire)) {
+                overwrites.fetch_add(1, std::memory_order_relaxed);
+                t++;
+            }
+        }
+        
+        buffer[h & mask] = item;
+        head.store(h + 1, std::memory_order_release);
+        level = h + 1 - t;
+        recordLevel(level);
+        return true;
+    }
+    
+    void recordLevel(size_t level) {
+        if (level > highWater.load(std::memory_order_relaxed)) {
+            highWater.store((uint32_t)level, std::memory_order_relaxed);
+        }
+    }
+    
+    // Advance tail from expected to target (consumer side). Returns false if
+    // the producer evicted any of those items first; tail still ends up at
+    // or past target.
+    bool release(size_t expected, size_t target) {
+        if (tail.compare_exchange_strong(expected, target, std::memory_order_acq_rel,
+                                         std::memory_order_acquire)) {
+            return true;
+        }
+        while ((ptrdiff_t)(target - expected) > 0 &&
+               !tail.compare_exchange_weak(expected, target, std::memory_order_acq_rel,
+                                           std::memory_order_acquire)) {
+        }
+        return false;
+    }
+    
+public:
+    explicit SPSCRingBuffer(OverflowPolicy overflowPolicy = OverflowPolicy::REJECT_NEWEST)
+        : policy(overflowPolicy) {}
+    SPSCRingBuffer(const SPSCRingBuffer&) = delete;
+    SPSCRingBuffer& operator=(const SPSCRingBuffer&) = delete;
+    
+    /**
+     * @brief Push item to buffer (producer side, never blocks)
+     * @param item Item to push
+     * @param timeoutTicks Ignored; kept for source compatibility with RingBuffer
+     * @return true if stored, false if rejected (REJECT_NEWEST and full)
+     */
+    bool push(const T& item, TickType_t timeoutTicks = 0) {
+        (void)timeoutTicks;
+        size_t level;
+        if (!tryPush(item, level)) {
+            return false;
+        }
+        waiter.notify(level);
+        return true;
+    }
+    
+    /**
+     * @brief Push item from ISR context
+     * @param item Item to push
+     * @param pxHigherPriorityTaskWoken Task switch flag
+     * @return true if stored, false if rejected (REJECT_NEWEST and full)
+     */
+    bool pushFromISR(const T& item, BaseType_t* pxHigherPriorityTaskWoken = nullptr) {
+        size_t level;
+        if (!tryPush(item, level)) {
+            return false;
+        }
+        waiter.notifyFromISR(level, pxHigherPriorityTaskWoken);
+        return true;
+    }
+    
+    /**
+     * @brief Pop item from buffer (consumer side, never blocks)
+     * @param item Reference to store popped item
+     * @param timeoutTicks Ignored; kept for source compatibility with RingBuffer
+     * @return true if successful, false if buffer empty
+     */
+    bool pop(T& item, TickType_t timeoutTicks = 0) {
+        (void)timeoutTicks;
+        while (true) {
+            size_t t = tail.load(std::memory_order_acquire);
+            const size_t h = head.load(std::memory_order_acquire);
+            if (h == t) {
+                return false;  // Buffer empty
+            }
+            
+            item = buffer[t & mask];
+            if (tail.compare_exchange_strong(t, t + 1, std::memory_order_acq_rel,
+                                             std::memory_order_relaxed)) {
+                return true;
+            }
+            // Evicted by the producer mid-copy; try the new oldest item
+        }
+    }
+    
+    /**
+     * @brief Push up to count items with a single index publish
+     * 
+     * With OVERWRITE_OLDEST every item is accepted; when count exceeds the
+     * capacity only the newest Size items are kept.
+     * 
+     * @param items Items to push (oldest first)
+     * @param count Number of items
+     * @return Number of items accepted
+     */
+    size_t pushN(const T* items, size_t count) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        size_t t = tail.load(std::memory_order_acquire);
+        size_t n = count;
+        
+        if (policy == OverflowPolicy::REJECT_NEWEST) {
+            n = std::min(count, Size - (h - t));
+            if (n < count) {
+                drops.fetch_add((uint32_t)(count - n), std::memory_order_relaxed);
+            }
+        } else {
+            if (n > Size) {
+                overwrites.fetch_add((uint32_t)(n - Size), std::memory_order_relaxed);
+                items += n - Size;
+                n = Size;
+            }
+            // Evict just enough old items; the consumer may free some meanwhile
+            while (h + n - t > Size) {
+                const size_t target = h + n - Size;
+                if (tail.compare_exchange_weak(t, target, std::memory_order_acq_rel,
+                                               std::memory_order_acquire)) {
+                    overwrites.fetch_add((uint32_t)(target - t), std::memory_order_relaxed);
+                    t = target;
+                }
+            }
+        }
+        
+        const size_t start = h & mask;
+        const size_t firstRun = std::min(n, Size - start);
+        std::copy(items, items + firstRun, &buffer[start]);
+        std::copy(items + firstRun, items + n, &buffer[0]);
+        
+        head.store(h + n, std::memory_order_release);
+        if (n > 0) {
+            recordLevel(h + n - t);
+            waiter.notify(h + n - t);
+        }
+        return policy == OverflowPolicy::REJECT_NEWEST ? n : count;
+    }
+    
+    /**
+     * @brief Pop up to maxItems items with a single index publish
+     * @param items Destination array (receives oldest first)
+     * @param maxItems Capacity of destination array
+     * @return Number of items popped
+     */
+    size_t popN(T* items, size_t maxItems) {
+        while (true) {
+            const size_t t = tail.load(std::memory_order_acquire);
+            const size_t h = head.load(std::memory_order_acquire);
+            const size_t n = std::min(maxItems, h - t);
+            if (n == 0) {
+                return 0;
+            }
+            
+            const size_t start = t & mask;
+            const size_t firstRun = std::min(n, Size - start);
+            std::copy(&buffer[start], &buffer[start] + firstRun, items);
+            std::copy(&buffer[0], &buffer[0] + (n - firstRun), items + firstRun);
+            
+            size_t expected = t;
+            if (tail.compare_exchange_strong(expected, t + n, std::memory_order_acq_rel,
+                                             std::memory_order_relaxed)) {
+                return n;
+            }
+            // Some of the copied items were evicted; copy again from the new tail
+        }
+    }
+    
+    /**
+     * @brief Get in-place view of the oldest items without removing them (consumer side)
+     * 
+     * With REJECT_NEWEST the producer never writes into the returned region,
+     * so it stays valid until consume() is called. With OVERWRITE_OLDEST the
+     * producer may evict and reuse those slots; consume() reports whether
+     * that happened.
+     * 
+     * @param maxItems Upper bound on the number of items returned
+     * @return Up to two spans covering the oldest items
+     */
+    RingSpanPair<const T> peekContiguous(size_t maxItems = SIZE_MAX) {
+        const size_t t = tail.load(std::memory_order_acquire);
+        const size_t h = head.load(std::memory_order_acquire);
+        const size_t n = std::min(maxItems, h - t);
+        peekTail = t;
+        
+        const size_t start = t & mask;
+        const size_t firstRun = std::min(n, Size - start);
+        RingSpanPair<const T> spans = {
+            { &buffer[start], firstRun },
+            { &buffer[0], n - firstRun }
+        };
+        return spans;
+    }
+    
+    /**
+     * @brief Release items returned by the last peekContiguous() (consumer side)
+     * @param count Number of items to drop from the front
+     * @return false if the producer evicted any of the peeked items while
+     *         they were in use (their contents may have been overwritten)
+     */
+    bool consume(size_t count) {
+        const size_t h = head.load(std::memory_order_acquire);
+        return release(peekTail, peekTail + std::min(count, h - peekTail));
+    }
+    
+    /**
+     * @brief Block until at least minItems are buffered (consumer side)
+     * 
+     * Woken by the producer's push() via the consumer task's notification,
+     * so there is no polling while the buffer is below the watermark.
+     * 
+     * @param minItems Watermark to wait for (at most Size)
+     * @param timeoutTicks Maximum time to block
+     * @return true if the watermark was reached, false on timeout
+     */
+    bool waitForItems(size_t minItems, TickType_t timeoutTicks = portMAX_DELAY) {
+        return waiter.wait(minItems, timeoutTicks, [this]() { return count(); });
+    }
+    
+    /**
+     * @brief Check if buffer is empty
+     */
+    bool isEmpty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+    
+    /**
+     * @brief Check if buffer is full
+     */
+    bool isFull() const {
+        return count() >= Size;
+    }
+    
+    /**
+     * @brief Get number of items in buffer
+     * 
+     * Exact when called from the producer or consumer; a snapshot otherwise.
+     */
+    size_t count() const {
+        const size_t t = tail.load(std::memory_order_acquire);
+        const size_t h = head.load(std::memory_order_acquire);
+        return h - t;
+    }
+    
+    /**
+     * @brief Get free space in buffer
+     */
+    size_t available() const {
+        return Size - count();
+    }
+    
+    /**
+     * @brief Clear the buffer (consumer side)
+     * 
+     * Discards everything published so far. Must only be called by the
+     * consumer, or while the producer is idle.
+     */
+    void clear() {
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+    
+    /**
+     * @brief Snapshot of overflow counters
+     */
+    RingBufferStats getStats() const {
+        RingBufferStats s;
+        s.drops = drops.load(std::memory_order_relaxed);
+        s.overwrites = overwrites.load(std::memory_order_relaxed);
+        s.highWater = highWater.load(std::memory_order_relaxed);
+        s.capacity = Size;
+        return s;
+    }
+    
+    /**
+     * @brief Reset overflow counters (high-water restarts at the current level)
+     */
+    void resetStats() {
+        drops.store(0, std::memory_order_relaxed);
+        overwrites.store(0, std::memory_order_relaxed);
+        highWater.store((uint32_t)count(), std::memory_order_relaxed);
+    }
+    
+    /**
+     * @brief Get buffer capacity
+     */
+    static constexpr size_t capacity() {
+        return Size;
+    }
+};
+
 /**
  * @brief Double buffer for zero-copy swapping
  * Used for batch processing (e.g., SD card writes)
@@ -0,0 +1,121 @@
+/**
+ * Seqlock "Latest Value" Register
+ *
+ * Holds the most recent value of a small struct shared between tasks (and
+ * cores). The single writer never waits: it bumps a sequence counter to an odd
+ * value, copies the new value in, and bumps it back to even. Readers copy the
+ * value and retry if the counter was odd or changed during the copy, so they
+ * never see a half-written struct and never hold anything the writer needs.
+ *
+ * Features:
+ * - Wait-free write(), callable from tasks or ISRs
+ * - Readers retry instead of blocking the writer
+ * - version() lets readers detect new data without copying it
+ *
+ * Only one context may write. Readers must not run in an ISR, and must not
+ * preempt the writer on the same core at higher priority for long: they
+ * back off with vTaskDelay() after a burst of failed attempts so a preempted
+ * writer can finish.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Failed read attempts before a reader sleeps for a tick
+#ifndef SEQLOCK_SPIN_LIMIT
+#define SEQLOCK_SPIN_LIMIT 64
+#endif
+
+/**
+ * @brief Single-writer latest-value register
+ * @tparam T Value type (must be trivially copyable)
+ */
+template<typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock values are copied with plain loads");
+
+private:
+    std::atomic<uint32_t> seq{0};
+    T value;
+
+public:
+    SeqLock() {
+        memset(&value, 0, sizeof(value));
+    }
+    
+    explicit SeqLock(const T& initial) : value(initial) {}
+    
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+    
+    /**
+     * @brief Publish a new value (single writer, never blocks)
+     * @param v Value to store
+     */
+    void write(const T& v) {
+        const uint32_t s = seq.load(std::memory_order_relaxed);
+    
+        // Odd sequence marks the write in progress before the value changes
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    
+        value = v;
+        seq.store(s + 2, std::memory_order_release);
+    }
+    
+    /**
+     * @brief Try to copy the current value once
+     * @param out Receives the value (only meaningful on success)
+     * @return true if the copy is consistent, false if a write overlapped it
+     */
+    bool tryRead(T& out) const {
+        const uint32_t before = seq.load(std::memory_order_acquire);
+        if (before & 1) {
+            return false;  // Write in progress
+        }
+    
+        out = value;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return seq.load(std::memory_order_relaxed) == before;
+    }
+    
+    /**
+     * @brief Copy the current value, retrying until consistent
+     * @param out Receives the value
+     */
+    void read(T& out) const {
+        uint32_t attempts = 0;
+        while (!tryRead(out)) {
+            if (++attempts >= SEQLOCK_SPIN_LIMIT) {
+                vTaskDelay(1);  // Writer may be preempted on this core
+                attempts = 0;
+            }
+        }
+    }
+    
+    /**
+     * @brief Copy the current value, retrying until consistent
+     */
+    T read() const {
+        T out;
+        read(out);
+        return out;
+    }
+    
+    /**
+     * @brief Number of completed writes
+     *
+     * A reader that remembers the last version it saw can skip the copy
+     * when nothing has changed.
+     */
+    uint32_t version() const {
+        return seq.load(std::memory_order_acquire) >> 1;
+    }
+};
@@ -105,6 +105,33 @@ void test_reset_clears_stats(void) {
     TEST_ASSERT_FALSE(alertManager->isTempAlertActive());
 }
 
+static IMUData imuAtG(float g) {
+    IMUData imu = {0};
+    imu.accel_z = g * GRAVITY_MS2;
+    imu.temperature = 25.0f;
+    return imu;
+}
+
+void test_gforce_alert_needs_min_duration(void) {
+    GPSData gps = {0};
+    gps.fix_quality = 1;
+    
+    // A 50ms spike is shorter than the 100ms debounce
+    for (uint32_t t = 0; t <= 50; t += 10) {
+        alertManager->process(imuAtG(4.0f), gps, 1000 + t);
+    }
+    alertManager->process(imuAtG(1.0f), gps, 1060);
+    TEST_ASSERT_EQUAL(0, alertManager->getTotalAlerts());
+    TEST_ASSERT_FALSE(alertManager->isGForceAlertActive());
+    
+    // Held for 150ms it fires
+    for (uint32_t t = 0; t <= 150; t += 10) {
+        alertManager->process(imuAtG(4.0f), gps, 2000 + t);
+    }
+    TEST_ASSERT_EQUAL(1, alertManager->getTotalAlerts());
+    TEST_ASSERT_TRUE(alertManager->isGForceAlertActive());
+}
+
 void setup() {
     UNITY_BEGIN();
     
@@ -114,6 +141,7 @@ void setup() {
     RUN_TEST(test_alert_type_enum);
     RUN_TEST(test_process_does_not_crash);
     RUN_TEST(test_reset_clears_stats);
+    RUN_TEST(test_gforce_alert_needs_min_duration);
     
     UNITY_END();
 }
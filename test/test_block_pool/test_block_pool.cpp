@@ -0,0 +1,160 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include "../../src/utils/BlockPool.h"
+#include "../../src/utils/BroadcastRing.h"
+
+struct Sample {
+    uint32_t sequence;
+    float values[8];
+};
+
+void setUp(void) {
+    // Empty
+}
+
+void tearDown(void) {
+    // Empty
+}
+
+void test_allocate_until_empty(void) {
+    BlockPool<Sample, 4> pool;
+    BlockPool<Sample, 4>::Handle handles[4];
+    
+    TEST_ASSERT_EQUAL(4, pool.available());
+    for (int i = 0; i < 4; i++) {
+        handles[i] = pool.allocate();
+        TEST_ASSERT_TRUE(handles[i] != (BlockPool<Sample, 4>::INVALID_HANDLE));
+        pool.get(handles[i]).sequence = i;
+    }
+    TEST_ASSERT_EQUAL(0, pool.available());
+    TEST_ASSERT_TRUE(pool.allocate() == (BlockPool<Sample, 4>::INVALID_HANDLE));
+    
+    // Blocks are distinct
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL(i, pool.get(handles[i]).sequence);
+    }
+    
+    for (int i = 0; i < 4; i++) {
+        pool.release(handles[i]);
+    }
+    BlockPoolStats stats = pool.getStats();
+    TEST_ASSERT_EQUAL(4, stats.available);
+    TEST_ASSERT_EQUAL(0, stats.lowWater);
+    TEST_ASSERT_EQUAL(1, stats.allocFailures);
+}
+
+void test_last_reference_frees_block(void) {
+    BlockPool<Sample, 2> pool;
+    BlockPool<Sample, 2>::Handle h = pool.allocate();
+    
+    pool.retain(h);
+    pool.release(h);
+    TEST_ASSERT_EQUAL(1, pool.available());
+    
+    pool.release(h);
+    TEST_ASSERT_EQUAL(2, pool.available());
+}
+
+void test_try_retain_rejects_recycled_handle(void) {
+    BlockPool<Sample, 1> pool;
+    BlockPool<Sample, 1>::Handle old = pool.allocate();
+    
+    TEST_ASSERT_TRUE(pool.tryRetain(old));
+    pool.release(old);
+    pool.release(old);
+    
+    // Freed: no reference can be taken
+    TEST_ASSERT_FALSE(pool.tryRetain(old));
+    
+    // Same block, new generation: the old handle must not alias it
+    BlockPool<Sample, 1>::Handle fresh = pool.allocate();
+    TEST_ASSERT_TRUE(fresh != old);
+    TEST_ASSERT_FALSE(pool.tryRetain(old));
+    TEST_ASSERT_TRUE(pool.tryRetain(fresh));
+    TEST_ASSERT_EQUAL(2, pool.getStats().staleRetains);
+    
+    pool.release(fresh);
+    pool.release(fresh);
+    TEST_ASSERT_EQUAL(1, pool.available());
+}
+
+void test_handles_through_broadcast_ring(void) {
+    // The pipeline pattern: the ring owns one reference per entry and the
+    // producer releases whatever publish() evicts; consumers retain what
+    // they read. Every block must come back once the ring is drained.
+    typedef BlockPool<Sample, 24> Pool;
+    static Pool pool;
+    static BroadcastRing<Pool::Handle, 16, 2> ring;
+    const uint32_t ITEMS = 100000;
+    int ids[2] = {ring.registerConsumer("fast"), ring.registerConsumer("slow")};
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> errors(0);
+    
+    auto consumer = [&](int id, size_t batchSize) {
+        Pool::Handle batch[4];
+        uint32_t next = 0;
+        while (true) {
+            bool finished = done.load();
+            size_t n = ring.pollN(id, batch, batchSize);
+            for (size_t i = 0; i < n; i++) {
+                if (!pool.tryRetain(batch[i])) continue;
+                const Sample& s = pool.get(batch[i]);
+                if (s.sequence < next || s.values[7] != (float)s.sequence) {
+                    errors++;
+                }
+                next = s.sequence + 1;
+                pool.release(batch[i]);
+            }
+            if (n == 0) {
+                if (finished) break;
+                std::this_thread::yield();
+            }
+        }
+    };
+    
+    std::thread fast(consumer, ids[0], 4);
+    std::thread slow(consumer, ids[1], 1);
+    
+    uint32_t allocFailures = 0;
+    for (uint32_t i = 0; i < ITEMS; i++) {
+        Pool::Handle h = pool.allocate();
+        if (h == Pool::INVALID_HANDLE) {
+            allocFailures++;
+            continue;
+        }
+        Sample& s = pool.get(h);
+        s.sequence = i;
+        for (int j = 0; j < 8; j++) {
+            s.values[j] = (float)i;
+        }
+        Pool::Handle evicted;
+        if (ring.publish(h, evicted)) {
+            pool.release(evicted);
+        }
+    }
+    done.store(true);
+    fast.join();
+    slow.join();
+    
+    // Only the ring's own references remain
+    TEST_ASSERT_EQUAL(0, errors.load());
+    TEST_ASSERT_EQUAL(0, allocFailures);
+    TEST_ASSERT_EQUAL(pool.capacity() - ring.capacity(), pool.available());
+}
+
+void setup() {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_allocate_until_empty);
+    RUN_TEST(test_last_reference_frees_block);
+    RUN_TEST(test_try_retain_rejects_recycled_handle);
+    RUN_TEST(test_handles_through_broadcast_ring);
+    
+    UNITY_END();
+}
+
+void loop() {
+    // Empty
+}
@@ -0,0 +1,101 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "../../src/utils/Crc.h"
+
+// One log block's worth of data
+static uint8_t data[16 * 1024];
+
+static void fillData() {
+    uint32_t x = 0x12345678;
+    for (size_t i = 0; i < sizeof(data); i++) {
+        x = x * 1103515245 + 12345;
+        data[i] = x >> 24;
+    }
+}
+
+void setUp(void) {
+    // Empty
+}
+
+void tearDown(void) {
+    // Empty
+}
+
+void test_check_values(void) {
+    const char* check = "123456789";
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, crc32Bytewise(0, check, 9));
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, crc32Slice8(0, check, 9));
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, crc32(check, 9));
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, crc16Ccitt(check, 9));
+    
+    TEST_ASSERT_EQUAL_HEX32(0, crc32(check, 0));
+}
+
+void test_paths_agree_at_any_alignment(void) {
+    fillData();
+    
+    // Every start offset and a spread of lengths, so the slicing path's
+    // alignment prologue and byte tail both get exercised
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t length = 0; length < 64; length++) {
+            uint32_t expected = crc32Bytewise(0, data + offset, length);
+            TEST_ASSERT_EQUAL_HEX32(expected, crc32Slice8(0, data + offset, length));
+            TEST_ASSERT_EQUAL_HEX32(expected, crc32Update(0, data + offset, length));
+        }
+    }
+    TEST_ASSERT_EQUAL_HEX32(crc32Bytewise(0, data, sizeof(data)),
+                            crc32Slice8(0, data, sizeof(data)));
+}
+
+void test_crc32_chains(void) {
+    fillData();
+    
+    uint32_t whole = crc32(data, 1000);
+    uint32_t split = crc32Update(crc32Update(0, data, 333), data + 333, 667);
+    TEST_ASSERT_EQUAL_HEX32(whole, split);
+}
+
+// Throughput of each path over one 16KB log block. Informational only:
+// wall-clock figures vary with host load, so nothing is asserted on them.
+typedef uint32_t (*Crc32Fn)(uint32_t, const void*, size_t);
+
+static void benchmarkMBps(Crc32Fn fn, const char* name) {
+    const int ROUNDS = 200;
+    uint32_t sink = 0;
+    
+    uint32_t start = micros();
+    for (int i = 0; i < ROUNDS; i++) {
+        sink ^= fn(sink, data, sizeof(data));
+    }
+    uint32_t elapsed = micros() - start;
+    if (elapsed == 0) elapsed = 1;
+    
+    float mbps = (float)ROUNDS * sizeof(data) / elapsed;
+    Serial.printf("crc32 %-9s %8.1f MB/s (%lu us per block, %08lX)\n",
+                  name, mbps, (unsigned long)(elapsed / ROUNDS), (unsigned long)sink);
+}
+
+void test_benchmark(void) {
+    fillData();
+    
+    benchmarkMBps(crc32Bytewise, "bytewise");
+    benchmarkMBps(crc32Slice8, "slice8");
+#if defined(ESP_PLATFORM)
+    benchmarkMBps(crc32Rom, "rom");
+#endif
+}
+
+void setup() {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_check_values);
+    RUN_TEST(test_paths_agree_at_any_alignment);
+    RUN_TEST(test_crc32_chains);
+    RUN_TEST(test_benchmark);
+    
+    UNITY_END();
+}
+
+void loop() {
+    // Empty
+}
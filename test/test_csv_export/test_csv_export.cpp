@@ -0,0 +1,200 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "../../src/storage/CsvExporter.h"
+
+static uint32_t rng = 0x12345678;
+
+static uint32_t nextRandom() {
+    rng = rng * 1103515245 + 12345;
+    return rng;
+}
+
+// Uniform in [-range, range)
+static float randomFloat(float range) {
+    return ((int32_t)nextRandom() / 2147483648.0f) * range;
+}
+
+static TelemetryPacket makePacket(uint32_t i) {
+    TelemetryPacket packet;
+    memset(&packet, 0, sizeof(packet));
+    packet.magic = PACKET_MAGIC;
+    packet.timestamp_ms = 1000 + i * 20;
+    packet.imu.accel_x = randomFloat(40.0f);
+    packet.imu.accel_y = randomFloat(40.0f);
+    packet.imu.accel_z = 9.81f + randomFloat(5.0f);
+    packet.imu.gyro_x = randomFloat(250.0f);
+    packet.imu.gyro_y = randomFloat(250.0f);
+    packet.imu.gyro_z = randomFloat(250.0f);
+    packet.imu.temperature = 25.0f + randomFloat(20.0f);
+    packet.gps.latitude = 48.0 + randomFloat(1.0f) * 0.01;
+    packet.gps.longitude = -123.0 + randomFloat(1.0f) * 0.01;
+    packet.gps.altitude = 300.0f + randomFloat(200.0f);
+    packet.gps.speed_kmh = 80.0f + randomFloat(80.0f);
+    packet.gps.heading = 180.0f + randomFloat(180.0f);
+    packet.gps.satellites = nextRandom() % 16;
+    packet.gps.fix_quality = nextRandom() % 3;
+    return packet;
+}
+
+// What exportToCSV used to write for a packet
+static size_t printfRow(const TelemetryPacket& packet, char* out, size_t size) {
+    int n = snprintf(out, size, "%u,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.2f,",
+                     (unsigned)packet.timestamp_ms,
+                     packet.imu.accel_x, packet.imu.accel_y, packet.imu.accel_z,
+                     packet.imu.gyro_x, packet.imu.gyro_y, packet.imu.gyro_z,
+                     packet.imu.temperature);
+    n += snprintf(out + n, size - n, "%.6f,%.6f,%.1f,%.1f,%.1f,%u,%u\n",
+                  packet.gps.latitude, packet.gps.longitude,
+                  packet.gps.altitude, packet.gps.speed_kmh, packet.gps.heading,
+                  packet.gps.satellites, packet.gps.fix_quality);
+    return n;
+}
+
+// Counts what it is given and throws it away
+class NullPrint : public Print {
+public:
+    size_t bytes = 0;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        (void)buffer;
+        bytes += size;
+        return size;
+    }
+};
+
+// Keeps everything it is given
+class StringPrint : public Print {
+public:
+    String text;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        for (size_t i = 0; i < size; i++) text += (char)buffer[i];
+        return size;
+    }
+};
+
+static void assertFixed(double value, uint8_t decimals) {
+    char expected[64];
+    char actual[64];
+    snprintf(expected, sizeof(expected), "%.*f", decimals, value);
+    *CsvExporter::formatFixed(actual, value, decimals) = '\0';
+    TEST_ASSERT_EQUAL_STRING(expected, actual);
+}
+
+void setUp(void) {
+    rng = 0x12345678;
+}
+
+void tearDown(void) {
+    // Empty
+}
+
+void test_fixed_matches_printf(void) {
+    assertFixed(0.0, 3);
+    assertFixed(-0.0, 3);
+    assertFixed(-0.0004f, 3);
+    assertFixed(0.0625f, 3);    // Exact half: rounds to even
+    assertFixed(0.0375f, 2);
+    assertFixed(9.9996f, 3);    // Carries into the whole part
+    assertFixed(123456789.0, 1);
+    assertFixed(4294967296.5, 2);
+    assertFixed(1e14, 3);
+    
+    // Every float precision the rows use, across sensor ranges
+    const uint8_t decimals[] = {1, 2, 3};
+    for (int i = 0; i < 20000; i++) {
+        float value = randomFloat(1000.0f);
+        assertFixed(value, decimals[i % 3]);
+    }
+}
+
+void test_coordinates_match_printf(void) {
+    // Latitudes and longitudes are doubles, so these are not exact once
+    // scaled; check both full ranges
+    for (int i = 0; i < 20000; i++) {
+        assertFixed(randomFloat(90.0f) + randomFloat(1.0f) * 1e-4, 6);
+        assertFixed(randomFloat(180.0f) + randomFloat(1.0f) * 1e-4, 6);
+    }
+}
+
+void test_out_of_range_values(void) {
+    char text[64];
+    *CsvExporter::formatFixed(text, 1e30, 3) = '\0';
+    TEST_ASSERT_EQUAL_STRING("1.000e+30", text);
+    *CsvExporter::formatFixed(text, -INFINITY, 1) = '\0';
+    TEST_ASSERT_EQUAL_STRING("-inf", text);
+    *CsvExporter::formatFixed(text, NAN, 1) = '\0';
+    TEST_ASSERT_EQUAL_STRING("nan", text);
+}
+
+void test_rows_match_printf(void) {
+    StringPrint sink;
+    CsvExporter exporter(sink);
+    exporter.writeHeader();
+    
+    String expected = CsvExporter::HEADER;
+    char row[CsvExporter::MAX_ROW_SIZE];
+    for (uint32_t i = 0; i < 500; i++) {
+        TelemetryPacket packet = makePacket(i);
+        exporter.writeRow(packet);
+        printfRow(packet, row, sizeof(row));
+        expected += row;
+    }
+    TEST_ASSERT_TRUE(exporter.finish());
+    TEST_ASSERT_EQUAL(500, exporter.getRows());
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), sink.text.c_str());
+}
+
+// Rows per second of each path into a sink that discards them.
+// Informational only: wall-clock rates vary with the host, so they are
+// printed, not asserted.
+static const uint32_t BENCH_ROWS = 2000;
+static TelemetryPacket benchPackets[64];
+
+static void benchmarkRowsPerSecond(bool usePrintf) {
+    NullPrint sink;
+    CsvExporter exporter(sink);
+    char row[CsvExporter::MAX_ROW_SIZE];
+    
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < BENCH_ROWS; i++) {
+        const TelemetryPacket& packet = benchPackets[i % 64];
+        if (usePrintf) {
+            sink.write((const uint8_t*)row, printfRow(packet, row, sizeof(row)));
+        } else {
+            exporter.writeRow(packet);
+        }
+    }
+    exporter.finish();
+    uint32_t elapsed = micros() - start;
+    if (elapsed == 0) elapsed = 1;
+    
+    float rate = BENCH_ROWS * 1e6f / elapsed;
+    Serial.printf("csv %-8s %9.0f rows/s (%lu bytes)\n",
+                  usePrintf ? "printf" : "exporter", rate, (unsigned long)sink.bytes);
+}
+
+void test_benchmark(void) {
+    for (uint32_t i = 0; i < 64; i++) {
+        benchPackets[i] = makePacket(i);
+    }
+    
+    benchmarkRowsPerSecond(true);
+    benchmarkRowsPerSecond(false);
+}
+
+void setup() {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_fixed_matches_printf);
+    RUN_TEST(test_coordinates_match_printf);
+    RUN_TEST(test_out_of_range_values);
+    RUN_TEST(test_rows_match_printf);
+    RUN_TEST(test_benchmark);
+    
+    UNITY_END();
+}
+
+void loop() {
+    // Empty
+}
@@ -0,0 +1,89 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "../../src/sensors/gps.h"
+
+// Runs on the native environment only: NMEA sentences are fed through the
+// host shim's UART receive buffer instead of a real receiver.
+
+GPS* gps = nullptr;
+
+void setUp(void) {
+    hostSerialClear(2);
+    gps = new GPS();
+    gps->begin();
+}
+
+void tearDown(void) {
+    delete gps;
+    gps = nullptr;
+}
+
+void test_parses_gga_fix(void) {
+    hostSerialInject(2, "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n");
+    gps->update();
+    
+    TEST_ASSERT_TRUE(gps->hasFix());
+    TEST_ASSERT_FLOAT_WITHIN(0.0001, 48.1173, gps->getLatitude());
+    TEST_ASSERT_FLOAT_WITHIN(0.0001, 11.5167, gps->getLongitude());
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 545.4f, gps->getAltitude());
+    TEST_ASSERT_EQUAL(8, gps->getSatellites());
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 0.9f, gps->getHDOP());
+}
+
+void test_parses_rmc_speed_and_heading(void) {
+    hostSerialInject(2, "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n");
+    gps->update();
+    
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 22.4f * 1.852f, gps->getSpeedKmh());
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 84.4f, gps->getHeading());
+    TEST_ASSERT_EQUAL(230394, gps->getDate());
+}
+
+void test_rejects_bad_checksum(void) {
+    hostSerialInject(2, "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*48\r\n");
+    gps->update();
+    
+    TEST_ASSERT_FALSE(gps->hasFix());
+    TEST_ASSERT_EQUAL(0, gps->getSentenceCount());
+}
+
+void test_sentence_split_across_updates(void) {
+    // UART reads can stop mid-sentence; the parser must resume
+    hostSerialInject(2, "$GPGGA,123519,4807.038,N,0113");
+    gps->update();
+    TEST_ASSERT_FALSE(gps->hasFix());
+    
+    hostSerialInject(2, "1.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n");
+    gps->update();
+    TEST_ASSERT_TRUE(gps->hasFix());
+    TEST_ASSERT_FLOAT_WITHIN(0.0001, 11.5167, gps->getLongitude());
+}
+
+void test_fill_data(void) {
+    hostSerialInject(2, "$GPGGA,123519,4807.038,S,01131.000,W,1,08,0.9,545.4,M,46.9,M,,*48\r\n");
+    gps->update();
+    
+    GPSData data;
+    gps->fillData(data, 1234);
+    TEST_ASSERT_EQUAL(1234, data.timestamp_ms);
+    TEST_ASSERT_FLOAT_WITHIN(0.0001, -48.1173, data.latitude);
+    TEST_ASSERT_FLOAT_WITHIN(0.0001, -11.5167, data.longitude);
+    TEST_ASSERT_EQUAL(1, data.fix_quality);
+    TEST_ASSERT_EQUAL(9, data.hdop);
+}
+
+void setup() {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_parses_gga_fix);
+    RUN_TEST(test_parses_rmc_speed_and_heading);
+    RUN_TEST(test_rejects_bad_checksum);
+    RUN_TEST(test_sentence_split_across_updates);
+    RUN_TEST(test_fill_data);
+    
+    UNITY_END();
+}
+
+void loop() {
+    // Empty
+}
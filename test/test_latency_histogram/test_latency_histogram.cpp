@@ -0,0 +1,132 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <thread>
+#include "../../src/utils/LatencyHistogram.h"
+
+void setUp(void) {
+    // Empty
+}
+
+void tearDown(void) {
+    // Empty
+}
+
+void test_empty_summary(void) {
+    static LatencyHistogram h;
+    LatencySummary s = h.summarize();
+    
+    TEST_ASSERT_EQUAL(0, s.count);
+    TEST_ASSERT_EQUAL(0, s.min);
+    TEST_ASSERT_EQUAL(0, s.p999);
+    TEST_ASSERT_EQUAL(0, s.max);
+}
+
+void test_buckets_are_contiguous(void) {
+    // Every value lands in a bucket whose bounds hold it, within 1/16
+    size_t last = 0;
+    for (uint32_t v = 1; v < (1u << LatencyHistogram::RANGE_BITS); v += 1 + v / 64) {
+        size_t index = LatencyHistogram::bucketFor(v);
+        TEST_ASSERT_TRUE(index == last || index == last + 1);
+        TEST_ASSERT_TRUE(v <= LatencyHistogram::bucketUpperBound(index));
+        TEST_ASSERT_TRUE(index == 0 || v > LatencyHistogram::bucketUpperBound(index - 1));
+        TEST_ASSERT_TRUE(LatencyHistogram::bucketUpperBound(index) - v <= v / 16);
+        last = index;
+    }
+    TEST_ASSERT_EQUAL(LatencyHistogram::BUCKET_COUNT - 1, LatencyHistogram::bucketFor(UINT32_MAX));
+}
+
+void test_small_values_exact(void) {
+    static LatencyHistogram h;
+    for (uint32_t v = 1; v <= 20; v++) {
+        h.record(v);
+    }
+    LatencySummary s = h.summarize();
+    
+    TEST_ASSERT_EQUAL(20, s.count);
+    TEST_ASSERT_EQUAL(1, s.min);
+    TEST_ASSERT_EQUAL(10, s.p50);
+    TEST_ASSERT_EQUAL(20, s.p99);
+    TEST_ASSERT_EQUAL(20, s.max);
+}
+
+void test_percentiles_of_long_tail(void) {
+    // 10000 values: 9900 around 1ms, 90 around 10ms, 10 at 100ms
+    static LatencyHistogram h;
+    for (uint32_t i = 0; i < 9900; i++) h.record(1000 + i % 50);
+    for (uint32_t i = 0; i < 90; i++) h.record(10000 + i);
+    for (uint32_t i = 0; i < 10; i++) h.record(100000);
+    LatencySummary s = h.summarize();
+    
+    TEST_ASSERT_EQUAL(10000, s.count);
+    TEST_ASSERT_EQUAL(1000, s.min);
+    TEST_ASSERT_INT_WITHIN(1049 / 16, 1049, s.p50);
+    TEST_ASSERT_INT_WITHIN(1049 / 16, 1049, s.p99);
+    TEST_ASSERT_INT_WITHIN(10089 / 16, 10089, s.p999);
+    TEST_ASSERT_EQUAL(100000, s.max);
+}
+
+void test_out_of_range_clamps(void) {
+    static LatencyHistogram h;
+    h.record(UINT32_MAX - 5);
+    LatencySummary s = h.summarize();
+    
+    TEST_ASSERT_EQUAL(1, s.count);
+    TEST_ASSERT_EQUAL(UINT32_MAX - 5, s.p50);
+    TEST_ASSERT_EQUAL(UINT32_MAX - 5, s.max);
+}
+
+void test_reset(void) {
+    static LatencyHistogram h;
+    h.record(500);
+    h.reset();
+    h.record(7);
+    LatencySummary s = h.summarize();
+    
+    TEST_ASSERT_EQUAL(1, s.count);
+    TEST_ASSERT_EQUAL(7, s.min);
+    TEST_ASSERT_EQUAL(7, s.max);
+}
+
+void test_concurrent_records_all_counted(void) {
+    static LatencyHistogram h;
+    const uint32_t PER_THREAD = 100000;
+    
+    auto writer = [&](uint32_t base) {
+        for (uint32_t i = 0; i < PER_THREAD; i++) {
+            h.record(base + i % 1000);
+        }
+    };
+    std::thread w1(writer, 0);
+    std::thread w2(writer, 5000);
+    
+    // Summaries along the way must stay sane
+    for (int i = 0; i < 100; i++) {
+        LatencySummary s = h.summarize();
+        TEST_ASSERT_TRUE(s.p50 <= s.p99 && s.p99 <= s.p999 && s.p999 <= s.max);
+    }
+    w1.join();
+    w2.join();
+    
+    LatencySummary s = h.summarize();
+    TEST_ASSERT_EQUAL(2 * PER_THREAD, s.count);
+    TEST_ASSERT_EQUAL(0, s.min);
+    TEST_ASSERT_EQUAL(5999, s.max);
+}
+
+void setup() {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_empty_summary);
+    RUN_TEST(test_buckets_are_contiguous);
+    RUN_TEST(test_small_values_exact);
+    RUN_TEST(test_percentiles_of_long_tail);
+    RUN_TEST(test_out_of_range_clamps);
+    RUN_TEST(test_reset);
+    RUN_TEST(test_concurrent_records_all_counted);
+    
+    UNITY_END();
+}
+
+void loop() {
+    // Empty
+}
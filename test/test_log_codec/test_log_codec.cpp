@@ -0,0 +1,202 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "../../src/storage/LogCodec.h"
+
+// A 50Hz stream: IMU noise on every packet, GPS advancing at 10Hz
+static TelemetryPacket makePacket(uint16_t i) {
+    TelemetryPacket packet;
+    memset(&packet, 0, sizeof(packet));
+    packet.magic = PACKET_MAGIC;
+    packet.version = PACKET_VERSION;
+    packet.sequence = i;
+    packet.timestamp_ms = 5000 + i * 20;
+    
+    packet.imu.timestamp_ms = packet.timestamp_ms - 3;
+    packet.imu.accel_x = 0.8f + 0.05f * ((i * 7) % 11);
+    packet.imu.accel_y = -0.3f + 0.04f * ((i * 5) % 13);
+    packet.imu.accel_z = 9.81f + 0.03f * ((i * 3) % 7);
+    packet.imu.gyro_x = 1.5f * ((i * 11) % 5) * DEG_TO_RAD;          // rad/s
+    packet.imu.gyro_y = (-2.0f + 0.5f * ((i * 13) % 9)) * DEG_TO_RAD;
+    packet.imu.gyro_z = 0.25f * (i % 17) * DEG_TO_RAD;
+    packet.imu.temperature = 31.5f + 0.01f * (i / 50);
+    
+    uint16_t fix = i / 5;
+    packet.gps.timestamp_ms = 5000 + fix * 100;
+    packet.gps.latitude = 48.1234567 + fix * 2e-6;
+    packet.gps.longitude = 11.7654321 - fix * 3e-6;
+    packet.gps.altitude = 520.0f + fix * 0.1f;
+    packet.gps.speed_kmh = 87.5f + (fix % 10) * 0.3f;
+    packet.gps.heading = 271.25f;
+    packet.gps.satellites = 11;
+    packet.gps.fix_quality = 1;
+    packet.gps.hdop = 9;
+    return packet;
+}
+
+static void assertClose(const TelemetryPacket& expected, const TelemetryPacket& actual) {
+    TEST_ASSERT_EQUAL(PACKET_MAGIC, actual.magic);
+    TEST_ASSERT_EQUAL(expected.sequence, actual.sequence);
+    TEST_ASSERT_EQUAL(expected.timestamp_ms, actual.timestamp_ms);
+    TEST_ASSERT_EQUAL(expected.imu.timestamp_ms, actual.imu.timestamp_ms);
+    TEST_ASSERT_FLOAT_WITHIN(0.0006, expected.imu.accel_x, actual.imu.accel_x);
+    TEST_ASSERT_FLOAT_WITHIN(0.0006, expected.imu.accel_z, actual.imu.accel_z);
+    TEST_ASSERT_FLOAT_WITHIN(0.00006, expected.imu.gyro_y, actual.imu.gyro_y);
+    TEST_ASSERT_FLOAT_WITHIN(0.006, expected.imu.temperature, actual.imu.temperature);
+    TEST_ASSERT_EQUAL(expected.gps.timestamp_ms, actual.gps.timestamp_ms);
+    TEST_ASSERT_FLOAT_WITHIN(1e-7, expected.gps.latitude, actual.gps.latitude);
+    TEST_ASSERT_FLOAT_WITHIN(1e-7, expected.gps.longitude, actual.gps.longitude);
+    TEST_ASSERT_FLOAT_WITHIN(0.006, expected.gps.speed_kmh, actual.gps.speed_kmh);
+    TEST_ASSERT_EQUAL(expected.gps.satellites, actual.gps.satellites);
+}
+
+void setUp(void) {
+    // Empty
+}
+
+void tearDown(void) {
+    // Empty
+}
+
+void test_round_trip_and_ratio(void) {
+    const int COUNT = 500;
+    static uint8_t encoded[COUNT * LOG_MAX_RECORD_SIZE];
+    LogEncoder encoder;
+    size_t total = 0;
+    for (int i = 0; i < COUNT; i++) {
+        size_t n = encoder.encode(makePacket(i), encoded + total);
+        TEST_ASSERT_TRUE(n <= LOG_MAX_RECORD_SIZE);
+        total += n;
+    }
+    
+    LogDecoder decoder;
+    size_t pos = 0;
+    for (int i = 0; i < COUNT; i++) {
+        TelemetryPacket packet;
+        size_t n = decoder.decode(encoded + pos, total - pos, packet);
+        TEST_ASSERT_TRUE(n > 0);
+        assertClose(makePacket(i), packet);
+        pos += n;
+    }
+    TEST_ASSERT_EQUAL(total, pos);
+    
+    // At least 4x smaller than raw packets
+    TEST_ASSERT_TRUE(total * 4 <= COUNT * sizeof(TelemetryPacket));
+}
+
+void test_sequence_jumps_and_extremes(void) {
+    TelemetryPacket a = makePacket(10);
+    TelemetryPacket b = makePacket(11);
+    b.sequence = 65535;            // Dropped packets, then wrap
+    b.timestamp_ms = 0xFFFFFFF0;   // Clock jump
+    b.imu.accel_x = -156.9f;       // Full-scale 16G
+    b.gps.latitude = -89.9999999;
+    b.gps.longitude = 179.9999999;
+    TelemetryPacket c = makePacket(12);
+    c.sequence = 0;
+    
+    uint8_t buffer[3 * LOG_MAX_RECORD_SIZE];
+    LogEncoder encoder;
+    size_t total = encoder.encode(a, buffer);
+    total += encoder.encode(b, buffer + total);
+    total += encoder.encode(c, buffer + total);
+    
+    LogDecoder decoder;
+    TelemetryPacket out;
+    size_t pos = decoder.decode(buffer, total, out);
+    assertClose(a, out);
+    pos += decoder.decode(buffer + pos, total - pos, out);
+    assertClose(b, out);
+    pos += decoder.decode(buffer + pos, total - pos, out);
+    assertClose(c, out);
+    TEST_ASSERT_EQUAL(total, pos);
+}
+
+void test_truncated_record_is_rejected(void) {
+    uint8_t buffer[LOG_MAX_RECORD_SIZE];
+    LogEncoder encoder;
+    size_t n = encoder.encode(makePacket(0), buffer);
+    
+    LogDecoder decoder;
+    TelemetryPacket out;
+    TEST_ASSERT_EQUAL(0, decoder.decode(buffer, n - 1, out));
+    
+    // A failed decode leaves the state alone, so the full record still works
+    TEST_ASSERT_EQUAL(n, decoder.decode(buffer, n, out));
+    assertClose(makePacket(0), out);
+}
+
+// 1kHz raw samples with vibration on every channel
+void test_raw_samples_round_trip(void) {
+    const int COUNT = 1000;
+    static uint8_t encoded[COUNT * LOG_MAX_SAMPLE_SIZE];
+    LogSampleEncoder encoder;
+    size_t total = 0;
+    for (int i = 0; i < COUNT; i++) {
+        IMUData sample = makePacket(i).imu;
+        sample.timestamp_ms = 5000 + i;
+        size_t n = encoder.encode(sample, encoded + total);
+        TEST_ASSERT_TRUE(n <= LOG_MAX_SAMPLE_SIZE);
+        total += n;
+    }
+    
+    LogSampleDecoder decoder;
+    size_t pos = 0;
+    for (int i = 0; i < COUNT; i++) {
+        IMUData expected = makePacket(i).imu;
+        IMUData sample;
+        size_t n = decoder.decode(encoded + pos, total - pos, sample);
+        TEST_ASSERT_TRUE(n > 0);
+        TEST_ASSERT_EQUAL(5000 + i, sample.timestamp_ms);
+        TEST_ASSERT_FLOAT_WITHIN(0.0006, expected.accel_y, sample.accel_y);
+        TEST_ASSERT_FLOAT_WITHIN(0.00006, expected.gyro_z, sample.gyro_z);
+        TEST_ASSERT_FLOAT_WITHIN(0.006, expected.temperature, sample.temperature);
+        pos += n;
+    }
+    TEST_ASSERT_EQUAL(total, pos);
+    
+    // At least 2x smaller than raw IMUData
+    TEST_ASSERT_TRUE(total * 2 <= COUNT * sizeof(IMUData));
+}
+
+void test_gyro_keeps_sensor_resolution(void) {
+    // One MPU6050 LSB at the +-1000 deg/s range the IMU uses, in rad/s as
+    // the driver reports it, survives packets and raw samples alike
+    const float LSB = DEG_TO_RAD / 32.8f;
+    LogEncoder encoder;
+    LogDecoder decoder;
+    LogSampleEncoder sampleEncoder;
+    LogSampleDecoder sampleDecoder;
+    uint8_t record[LOG_MAX_RECORD_SIZE];
+    for (int i = 0; i < 100; i++) {
+        TelemetryPacket packet = makePacket(i);
+        packet.imu.gyro_x = i * LSB;
+        packet.imu.gyro_z = -i * LSB;
+        size_t n = encoder.encode(packet, record);
+        TelemetryPacket decoded;
+        TEST_ASSERT_EQUAL(n, decoder.decode(record, n, decoded));
+        TEST_ASSERT_FLOAT_WITHIN(LSB / 2, packet.imu.gyro_x, decoded.imu.gyro_x);
+        TEST_ASSERT_FLOAT_WITHIN(LSB / 2, packet.imu.gyro_z, decoded.imu.gyro_z);
+        
+        IMUData sample;
+        n = sampleEncoder.encode(packet.imu, record);
+        TEST_ASSERT_EQUAL(n, sampleDecoder.decode(record, n, sample));
+        TEST_ASSERT_FLOAT_WITHIN(LSB / 2, packet.imu.gyro_x, sample.gyro_x);
+        TEST_ASSERT_FLOAT_WITHIN(LSB / 2, packet.imu.gyro_z, sample.gyro_z);
+    }
+}
+
+void setup() {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_round_trip_and_ratio);
+    RUN_TEST(test_sequence_jumps_and_extremes);
+    RUN_TEST(test_truncated_record_is_rejected);
+    RUN_TEST(test_raw_samples_round_trip);
+    RUN_TEST(test_gyro_keeps_sensor_resolution);
+    
+    UNITY_END();
+}
+
+void loop() {
+    // Empty
+}
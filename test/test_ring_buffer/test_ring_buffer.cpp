@@ -1,6 +1,8 @@
 #include <Arduino.h>
 #include <unity.h>
+#include <thread>
 #include "../../src/utils/RingBuffer.h"
+#include "../../src/utils/BroadcastRing.h"
 
 struct TestData {
     uint32_t timestamp;
@@ -8,9 +10,11 @@ struct TestData {
 };
 
 RingBuffer<TestData, 16> testBuffer;
+SPSCRingBuffer<TestData, 16> spscBuffer;
 
 void setUp(void) {
     testBuffer.clear();
+    spscBuffer.clear();
 }
 
 void tearDown(void) {
@@ -101,6 +105,494 @@ void test_pop_empty_returns_false(void) {
     TEST_ASSERT_FALSE(testBuffer.pop(result, 0)); // Non-blocking
 }
 
+void test_spsc_push_pop_single(void) {
+    TestData data = {12345, 3.14f};
+    
+    TEST_ASSERT_TRUE(spscBuffer.isEmpty());
+    TEST_ASSERT_TRUE(spscBuffer.push(data));
+    TEST_ASSERT_EQUAL(1, spscBuffer.count());
+    
+    TestData result;
+    TEST_ASSERT_TRUE(spscBuffer.pop(result));
+    TEST_ASSERT_EQUAL(12345, result.timestamp);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 3.14f, result.value);
+    TEST_ASSERT_TRUE(spscBuffer.isEmpty());
+    TEST_ASSERT_FALSE(spscBuffer.pop(result));
+}
+
+void test_spsc_uses_full_capacity(void) {
+    // SPSC buffer uses free-running indices, so all 16 slots are usable
+    for (int i = 0; i < 16; i++) {
+        TEST_ASSERT_TRUE(spscBuffer.push({(uint32_t)i, (float)i}));
+    }
+    TEST_ASSERT_TRUE(spscBuffer.isFull());
+    TEST_ASSERT_EQUAL(0, spscBuffer.available());
+    TEST_ASSERT_FALSE(spscBuffer.push({999, 999.0f}));
+    
+    // FIFO order survives index wrap-around
+    TestData result;
+    for (int i = 0; i < 16; i++) {
+        TEST_ASSERT_TRUE(spscBuffer.pop(result));
+        TEST_ASSERT_EQUAL(i, result.timestamp);
+        TEST_ASSERT_TRUE(spscBuffer.push({(uint32_t)(i + 16), 0.0f}));
+    }
+    for (int i = 16; i < 32; i++) {
+        TEST_ASSERT_TRUE(spscBuffer.pop(result));
+        TEST_ASSERT_EQUAL(i, result.timestamp);
+    }
+}
+
+void test_spsc_stress_concurrent(void) {
+    // Producer and consumer hammer a small buffer from separate threads.
+    // Every value must arrive exactly once, in order, with its payload intact.
+    static SPSCRingBuffer<TestData, 8> stressBuffer;
+    const uint32_t ITEMS = 200000;
+    
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < ITEMS; i++) {
+            TestData data = {i, (float)(i & 0xFFFF)};
+            while (!stressBuffer.push(data)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    
+    uint32_t expected = 0;
+    uint32_t errors = 0;
+    while (expected < ITEMS) {
+        TestData result;
+        if (stressBuffer.pop(result)) {
+            if (result.timestamp != expected || result.value != (float)(expected & 0xFFFF)) {
+                errors++;
+            }
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    
+    TEST_ASSERT_EQUAL(0, errors);
+    TEST_ASSERT_EQUAL(ITEMS, expected);
+    TEST_ASSERT_TRUE(stressBuffer.isEmpty());
+}
+
+void test_push_n_pop_n(void) {
+    TestData items[20];
+    for (int i = 0; i < 20; i++) {
+        items[i] = {(uint32_t)i, (float)i};
+    }
+    
+    // Mutex buffer accepts up to its capacity of 15
+    TEST_ASSERT_EQUAL(15, testBuffer.pushN(items, 20));
+    TEST_ASSERT_TRUE(testBuffer.isFull());
+    
+    TestData out[20];
+    TEST_ASSERT_EQUAL(10, testBuffer.popN(out, 10));
+    TEST_ASSERT_EQUAL(0, out[0].timestamp);
+    TEST_ASSERT_EQUAL(9, out[9].timestamp);
+    
+    // Wrapping push and pop keep FIFO order
+    TEST_ASSERT_EQUAL(5, testBuffer.pushN(&items[15], 5));
+    TEST_ASSERT_EQUAL(10, testBuffer.popN(out, 20));
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL(10 + i, out[i].timestamp);
+    }
+    
+    // SPSC buffer accepts all 16
+    TEST_ASSERT_EQUAL(16, spscBuffer.pushN(items, 20));
+    TEST_ASSERT_EQUAL(16, spscBuffer.popN(out, 20));
+    TEST_ASSERT_EQUAL(15, out[15].timestamp);
+}
+
+void test_peek_contiguous_wraps_into_two_spans(void) {
+    TestData out[16];
+    TestData items[16];
+    for (int i = 0; i < 16; i++) {
+        items[i] = {(uint32_t)i, 0.0f};
+    }
+    
+    // Move the read index to slot 12, then write 8 items across the wrap
+    SPSCRingBuffer<TestData, 16> wrapBuffer;
+    wrapBuffer.pushN(items, 12);
+    wrapBuffer.popN(out, 12);
+    wrapBuffer.pushN(items, 8);
+    
+    RingSpanPair<const TestData> spans = wrapBuffer.peekContiguous();
+    TEST_ASSERT_EQUAL(8, spans.total());
+    TEST_ASSERT_EQUAL(4, spans.first.count);
+    TEST_ASSERT_EQUAL(4, spans.second.count);
+    TEST_ASSERT_EQUAL(0, spans.first.data[0].timestamp);
+    TEST_ASSERT_EQUAL(4, spans.second.data[0].timestamp);
+    
+    // Peeking does not remove; consume does
+    TEST_ASSERT_EQUAL(8, wrapBuffer.count());
+    wrapBuffer.consume(spans.first.count);
+    TEST_ASSERT_EQUAL(4, wrapBuffer.count());
+    
+    spans = wrapBuffer.peekContiguous(2);
+    TEST_ASSERT_EQUAL(2, spans.total());
+    TEST_ASSERT_EQUAL(4, spans.first.data[0].timestamp);
+    wrapBuffer.consume(100);  // Clamped to what is available
+    TEST_ASSERT_TRUE(wrapBuffer.isEmpty());
+    
+    // Same layout on the mutex buffer
+    testBuffer.pushN(items, 12);
+    testBuffer.popN(out, 12);
+    testBuffer.pushN(items, 8);
+    RingSpanPair<const TestData> mutexSpans = testBuffer.peekContiguous();
+    TEST_ASSERT_EQUAL(4, mutexSpans.first.count);
+    TEST_ASSERT_EQUAL(4, mutexSpans.second.count);
+    testBuffer.consume(mutexSpans.total());
+    TEST_ASSERT_TRUE(testBuffer.isEmpty());
+}
+
+void test_spsc_bulk_stress_concurrent(void) {
+    // Batched producer/consumer with uneven batch sizes across the wrap
+    static SPSCRingBuffer<TestData, 32> stressBuffer;
+    const uint32_t ITEMS = 200000;
+    
+    std::thread producer([&]() {
+        TestData batch[7];
+        uint32_t next = 0;
+        while (next < ITEMS) {
+            size_t n = 0;
+            while (n < 7 && next + n < ITEMS) {
+                batch[n] = {next + (uint32_t)n, 0.0f};
+                n++;
+            }
+            size_t pushed = stressBuffer.pushN(batch, n);
+            next += pushed;
+            if (pushed < n) std::this_thread::yield();
+        }
+    });
+    
+    uint32_t expected = 0;
+    uint32_t errors = 0;
+    while (expected < ITEMS) {
+        RingSpanPair<const TestData> spans = stressBuffer.peekContiguous(11);
+        for (size_t i = 0; i < spans.first.count; i++) {
+            if (spans.first.data[i].timestamp != expected++) errors++;
+        }
+        for (size_t i = 0; i < spans.second.count; i++) {
+            if (spans.second.data[i].timestamp != expected++) errors++;
+        }
+        stressBuffer.consume(spans.total());
+        if (spans.total() == 0) std::this_thread::yield();
+    }
+    producer.join();
+    
+    TEST_ASSERT_EQUAL(0, errors);
+    TEST_ASSERT_TRUE(stressBuffer.isEmpty());
+}
+
+void test_broadcast_consumers_are_independent(void) {
+    BroadcastRing<TestData, 16, 2> ring;
+    int a = ring.registerConsumer("a");
+    int b = ring.registerConsumer("b");
+    TEST_ASSERT_EQUAL(0, a);
+    TEST_ASSERT_EQUAL(1, b);
+    TEST_ASSERT_EQUAL(-1, ring.registerConsumer("c"));
+    
+    for (int i = 0; i < 10; i++) {
+        ring.publish({(uint32_t)i, (float)i});
+    }
+    
+    // Consumer A reads everything, B reads nothing yet
+    TestData out[16];
+    TEST_ASSERT_EQUAL(10, ring.pollN(a, out, 16));
+    TEST_ASSERT_EQUAL(0, out[0].timestamp);
+    TEST_ASSERT_EQUAL(9, out[9].timestamp);
+    TEST_ASSERT_EQUAL(0, ring.pending(a));
+    TEST_ASSERT_EQUAL(10, ring.pending(b));
+    
+    // B still sees the same items in the same order
+    TestData item;
+    TEST_ASSERT_TRUE(ring.poll(b, item));
+    TEST_ASSERT_EQUAL(0, item.timestamp);
+    TEST_ASSERT_EQUAL(9, ring.pending(b));
+    TEST_ASSERT_FALSE(ring.poll(a, item));
+    
+    BroadcastConsumerStats stats = ring.getConsumerStats(b);
+    TEST_ASSERT_EQUAL(1, stats.consumed);
+    TEST_ASSERT_EQUAL(9, stats.lag);
+    TEST_ASSERT_EQUAL(0, stats.overruns);
+}
+
+void test_broadcast_slow_consumer_counts_overruns(void) {
+    BroadcastRing<TestData, 16, 2> ring;
+    int fast = ring.registerConsumer("fast");
+    int slow = ring.registerConsumer("slow");
+    
+    TestData out[16];
+    for (int i = 0; i < 40; i++) {
+        ring.publish({(uint32_t)i, 0.0f});
+        TEST_ASSERT_EQUAL(1, ring.pollN(fast, out, 16));
+    }
+    
+    // Slow consumer only gets the last 16 items; the rest are overruns
+    TEST_ASSERT_EQUAL(16, ring.pollN(slow, out, 16));
+    TEST_ASSERT_EQUAL(24, out[0].timestamp);
+    TEST_ASSERT_EQUAL(39, out[15].timestamp);
+    
+    BroadcastConsumerStats slowStats = ring.getConsumerStats(slow);
+    TEST_ASSERT_EQUAL(24, slowStats.overruns);
+    TEST_ASSERT_EQUAL(16, slowStats.consumed);
+    TEST_ASSERT_EQUAL(40, slowStats.maxLag);
+    TEST_ASSERT_EQUAL(0, ring.getConsumerStats(fast).overruns);
+}
+
+void test_broadcast_latest_skips_backlog(void) {
+    BroadcastRing<TestData, 16, 1> ring;
+    int id = ring.registerConsumer("latest");
+    
+    TestData item;
+    TEST_ASSERT_FALSE(ring.latest(id, item));
+    
+    for (int i = 0; i < 5; i++) {
+        ring.publish({(uint32_t)i, 0.0f});
+    }
+    TEST_ASSERT_TRUE(ring.latest(id, item));
+    TEST_ASSERT_EQUAL(4, item.timestamp);
+    TEST_ASSERT_FALSE(ring.latest(id, item));
+    
+    BroadcastConsumerStats stats = ring.getConsumerStats(id);
+    TEST_ASSERT_EQUAL(4, stats.skipped);
+    TEST_ASSERT_EQUAL(0, stats.overruns);
+}
+
+void test_broadcast_stress_concurrent(void) {
+    // One producer, two consumers reading at different speeds. Every item
+    // delivered must be intact and in order; anything missing must be
+    // accounted for as an overrun.
+    static BroadcastRing<TestData, 32, 2> ring;
+    const uint32_t ITEMS = 200000;
+    int ids[2] = {ring.registerConsumer("c0"), ring.registerConsumer("c1")};
+    uint32_t errors[2] = {0, 0};
+    uint32_t received[2] = {0, 0};
+    std::atomic<bool> done(false);
+    
+    std::thread consumers[2];
+    for (int c = 0; c < 2; c++) {
+        consumers[c] = std::thread([&, c]() {
+            TestData batch[5];
+            uint32_t next = 0;
+            while (true) {
+                bool finished = done.load();
+                size_t n = ring.pollN(ids[c], batch, c == 0 ? 5 : 1);
+                for (size_t i = 0; i < n; i++) {
+                    if (batch[i].timestamp < next ||
+                        batch[i].value != (float)(batch[i].timestamp & 0xFFFF)) {
+                        errors[c]++;
+                    }
+                    next = batch[i].timestamp + 1;
+                }
+                received[c] += n;
+                if (n == 0) {
+                    if (finished) break;
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    
+    for (uint32_t i = 0; i < ITEMS; i++) {
+        ring.publish({i, (float)(i & 0xFFFF)});
+    }
+    done.store(true);
+    consumers[0].join();
+    consumers[1].join();
+    
+    for (int c = 0; c < 2; c++) {
+        BroadcastConsumerStats stats = ring.getConsumerStats(ids[c]);
+        TEST_ASSERT_EQUAL(0, errors[c]);
+        TEST_ASSERT_EQUAL(received[c], stats.consumed);
+        TEST_ASSERT_EQUAL(ITEMS, stats.consumed + stats.overruns);
+    }
+}
+
+void test_wait_for_items_times_out_below_watermark(void) {
+    spscBuffer.push({1, 0.0f});
+    
+    // Already satisfied: returns immediately
+    TEST_ASSERT_TRUE(spscBuffer.waitForItems(1, 0));
+    
+    // Below watermark and nobody pushing: times out
+    TickType_t start = xTaskGetTickCount();
+    TEST_ASSERT_FALSE(spscBuffer.waitForItems(4, pdMS_TO_TICKS(20)));
+    TEST_ASSERT_TRUE(xTaskGetTickCount() - start >= pdMS_TO_TICKS(20));
+    TEST_ASSERT_FALSE(testBuffer.waitForItems(1, pdMS_TO_TICKS(5)));
+}
+
+void test_wait_for_items_woken_by_producer(void) {
+    // Consumer blocks until the producer thread reaches the watermark.
+    // Repeat to shake out lost wakeups between arming and publishing.
+    static SPSCRingBuffer<TestData, 16> waitBuffer;
+    const int ROUNDS = 2000;
+    int timeouts = 0;
+    
+    std::thread producer([&]() {
+        for (int i = 0; i < ROUNDS * 4; i++) {
+            while (!waitBuffer.push({(uint32_t)i, 0.0f})) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    
+    TestData out[4];
+    for (int r = 0; r < ROUNDS; r++) {
+        if (!waitBuffer.waitForItems(4, pdMS_TO_TICKS(1000))) {
+            timeouts++;
+        }
+        TEST_ASSERT_EQUAL(4, waitBuffer.popN(out, 4));
+    }
+    producer.join();
+    
+    TEST_ASSERT_EQUAL(0, timeouts);
+    TEST_ASSERT_TRUE(waitBuffer.isEmpty());
+}
+
+void test_broadcast_wait_for_items_per_consumer(void) {
+    static BroadcastRing<TestData, 16, 2> ring;
+    int a = ring.registerConsumer("a");
+    int idle = ring.registerConsumer("idle");
+    const int ROUNDS = 2000;
+    int timeouts = 0;
+    
+    std::thread producer([&]() {
+        for (int i = 0; i < ROUNDS; i++) {
+            // Keep the waiting consumer from being lapped
+            while (ring.pending(a) >= 8) {
+                std::this_thread::yield();
+            }
+            ring.publish({(uint32_t)i, 0.0f});
+        }
+    });
+    
+    TestData item;
+    for (int r = 0; r < ROUNDS; r++) {
+        if (!ring.waitForItems(a, 1, pdMS_TO_TICKS(1000))) {
+            timeouts++;
+        }
+        TEST_ASSERT_TRUE(ring.poll(a, item));
+        TEST_ASSERT_EQUAL(r, item.timestamp);
+    }
+    producer.join();
+    
+    TEST_ASSERT_EQUAL(0, timeouts);
+    
+    // The other consumer's cursor is untouched
+    TEST_ASSERT_TRUE(ring.waitForItems(idle, 16, 0));
+}
+
+void test_reject_newest_counts_drops(void) {
+    static RingBuffer<TestData, 8> mutexBuffer;
+    static SPSCRingBuffer<TestData, 8> lockFree;
+    
+    for (uint32_t i = 0; i < 10; i++) {
+        mutexBuffer.push({i, 0.0f}, 0);
+        lockFree.push({i, 0.0f});
+    }
+    
+    RingBufferStats a = mutexBuffer.getStats();
+    TEST_ASSERT_EQUAL(3, a.drops);
+    TEST_ASSERT_EQUAL(0, a.overwrites);
+    TEST_ASSERT_EQUAL(7, a.highWater);
+    TEST_ASSERT_EQUAL(7, a.capacity);
+    
+    RingBufferStats b = lockFree.getStats();
+    TEST_ASSERT_EQUAL(2, b.drops);
+    TEST_ASSERT_EQUAL(0, b.overwrites);
+    TEST_ASSERT_EQUAL(8, b.highWater);
+    TEST_ASSERT_EQUAL(8, b.capacity);
+    
+    // Oldest items survive
+    TestData result;
+    TEST_ASSERT_TRUE(lockFree.pop(result));
+    TEST_ASSERT_EQUAL(0, result.timestamp);
+    
+    lockFree.resetStats();
+    TEST_ASSERT_EQUAL(0, lockFree.getStats().drops);
+    TEST_ASSERT_EQUAL(7, lockFree.getStats().highWater);
+}
+
+void test_overwrite_oldest_keeps_newest(void) {
+    static RingBuffer<TestData, 8> mutexBuffer(OverflowPolicy::OVERWRITE_OLDEST);
+    static SPSCRingBuffer<TestData, 8> lockFree(OverflowPolicy::OVERWRITE_OLDEST);
+    
+    for (uint32_t i = 0; i < 20; i++) {
+        TEST_ASSERT_TRUE(mutexBuffer.push({i, 0.0f}, 0));
+        TEST_ASSERT_TRUE(lockFree.push({i, 0.0f}));
+    }
+    
+    RingBufferStats a = mutexBuffer.getStats();
+    TEST_ASSERT_EQUAL(0, a.drops);
+    TEST_ASSERT_EQUAL(13, a.overwrites);
+    TEST_ASSERT_EQUAL(7, a.highWater);
+    
+    RingBufferStats b = lockFree.getStats();
+    TEST_ASSERT_EQUAL(0, b.drops);
+    TEST_ASSERT_EQUAL(12, b.overwrites);
+    TEST_ASSERT_EQUAL(8, b.highWater);
+    
+    TestData out[8];
+    TEST_ASSERT_EQUAL(7, mutexBuffer.popN(out, 8));
+    TEST_ASSERT_EQUAL(13, out[0].timestamp);
+    TEST_ASSERT_EQUAL(19, out[6].timestamp);
+    
+    TEST_ASSERT_EQUAL(8, lockFree.popN(out, 8));
+    TEST_ASSERT_EQUAL(12, out[0].timestamp);
+    TEST_ASSERT_EQUAL(19, out[7].timestamp);
+    
+    // Bulk push larger than the buffer keeps only the newest Size items
+    TestData burst[20];
+    for (uint32_t i = 0; i < 20; i++) {
+        burst[i] = {100 + i, 0.0f};
+    }
+    TEST_ASSERT_EQUAL(20, lockFree.pushN(burst, 20));
+    TEST_ASSERT_EQUAL(8, lockFree.count());
+    TEST_ASSERT_TRUE(lockFree.pop(out[0]));
+    TEST_ASSERT_EQUAL(112, out[0].timestamp);
+    TEST_ASSERT_EQUAL(24, lockFree.getStats().overwrites);
+}
+
+void test_spsc_overwrite_stress_concurrent(void) {
+    // Producer never waits; the consumer must still see an increasing
+    // sequence of intact items, and every item is either received or
+    // counted as overwritten.
+    static SPSCRingBuffer<TestData, 8> stressBuffer(OverflowPolicy::OVERWRITE_OLDEST);
+    const uint32_t ITEMS = 200000;
+    std::atomic<bool> done(false);
+    
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < ITEMS; i++) {
+            TestData data = {i, (float)(i & 0xFFFF)};
+            stressBuffer.push(data);
+        }
+        done.store(true);
+    });
+    
+    uint32_t received = 0;
+    uint32_t errors = 0;
+    int64_t last = -1;
+    TestData batch[4];
+    while (!done.load() || !stressBuffer.isEmpty()) {
+        size_t n = stressBuffer.popN(batch, 4);
+        for (size_t i = 0; i < n; i++) {
+            if ((int64_t)batch[i].timestamp <= last ||
+                batch[i].value != (float)(batch[i].timestamp & 0xFFFF)) {
+                errors++;
+            }
+            last = batch[i].timestamp;
+        }
+        received += n;
+    }
+    producer.join();
+    
+    TEST_ASSERT_EQUAL(0, errors);
+    TEST_ASSERT_EQUAL(ITEMS, received + stressBuffer.getStats().overwrites);
+}
+
 void setup() {
     UNITY_BEGIN();
     
@@ -111,6 +603,22 @@ void setup() {
     RUN_TEST(test_clear_buffer);
     RUN_TEST(test_available_space);
     RUN_TEST(test_pop_empty_returns_false);
+    RUN_TEST(test_spsc_push_pop_single);
+    RUN_TEST(test_spsc_uses_full_capacity);
+    RUN_TEST(test_spsc_stress_concurrent);
+    RUN_TEST(test_push_n_pop_n);
+    RUN_TEST(test_peek_contiguous_wraps_into_two_spans);
+    RUN_TEST(test_spsc_bulk_stress_concurrent);
+    RUN_TEST(test_broadcast_consumers_are_independent);
+    RUN_TEST(test_broadcast_slow_consumer_counts_overruns);
+    RUN_TEST(test_broadcast_latest_skips_backlog);
+    RUN_TEST(test_broadcast_stress_concurrent);
+    RUN_TEST(test_wait_for_items_times_out_below_watermark);
+    RUN_TEST(test_wait_for_items_woken_by_producer);
+    RUN_TEST(test_broadcast_wait_for_items_per_consumer);
+    RUN_TEST(test_reject_newest_counts_drops);
+    RUN_TEST(test_overwrite_oldest_keeps_newest);
+    RUN_TEST(test_spsc_overwrite_stress_concurrent);
     
     UNITY_END();
 }
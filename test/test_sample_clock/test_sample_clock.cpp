@@ -0,0 +1,118 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "../../src/sensors/SampleClock.h"
+
+// The clock runs in real time, so these tests sleep and check spacing and
+// counts with some slack for scheduling.
+
+SampleClock* sampleClock = nullptr;
+
+void setUp(void) {
+    sampleClock = new SampleClock();
+}
+
+void tearDown(void) {
+    delete sampleClock;
+    sampleClock = nullptr;
+}
+
+void test_timer_ticks_at_period(void) {
+    TEST_ASSERT_TRUE(sampleClock->beginTimer(2000));
+    TEST_ASSERT_EQUAL(2000, sampleClock->getPeriodUs());
+    
+    SampleTick first, tick;
+    TEST_ASSERT_TRUE(sampleClock->wait(pdMS_TO_TICKS(100)));
+    TEST_ASSERT_TRUE(sampleClock->take(first));
+    TEST_ASSERT_FALSE(sampleClock->take(tick));
+    
+    // Tick times stay on the schedule of the first, however late each wakeup
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_TRUE(sampleClock->wait(pdMS_TO_TICKS(100)));
+        TEST_ASSERT_TRUE(sampleClock->take(tick));
+    }
+    const uint32_t ticks = tick.index - first.index;
+    TEST_ASSERT_TRUE(ticks >= 100);
+    TEST_ASSERT_INT_WITHIN(1000, ticks * 2000, tick.timeUs - first.timeUs);
+}
+
+void test_late_take_counts_missed(void) {
+    TEST_ASSERT_TRUE(sampleClock->beginTimer(1000));
+    
+    SampleTick tick;
+    TEST_ASSERT_TRUE(sampleClock->wait(pdMS_TO_TICKS(100)));
+    TEST_ASSERT_TRUE(sampleClock->take(tick));
+    TEST_ASSERT_EQUAL(0, sampleClock->getMissed());
+    const uint32_t before = tick.index;
+    
+    // Ten periods pass; one wakeup takes the latest, the rest are missed
+    delay(10);
+    TEST_ASSERT_TRUE(sampleClock->wait(0));
+    TEST_ASSERT_TRUE(sampleClock->take(tick));
+    TEST_ASSERT_EQUAL(tick.index - before - 1, sampleClock->getMissed());
+    TEST_ASSERT_INT_WITHIN(4, 9, sampleClock->getMissed());
+}
+
+void test_first_take_is_not_missed(void) {
+    TEST_ASSERT_TRUE(sampleClock->beginTimer(1000));
+    delay(10);
+    
+    SampleTick tick;
+    TEST_ASSERT_TRUE(sampleClock->take(tick));
+    TEST_ASSERT_TRUE(tick.index > 1);
+    TEST_ASSERT_EQUAL(0, sampleClock->getMissed());
+}
+
+void test_begin_twice_and_zero_period_fail(void) {
+    TEST_ASSERT_FALSE(sampleClock->beginTimer(0));
+    TEST_ASSERT_FALSE(sampleClock->isRunning());
+    TEST_ASSERT_TRUE(sampleClock->beginTimer(5000));
+    TEST_ASSERT_FALSE(sampleClock->beginTimer(5000));
+    TEST_ASSERT_FALSE(sampleClock->beginDataReady(MPU6050_INT_PIN, 5000));
+    TEST_ASSERT_TRUE(sampleClock->getSource() == SampleClock::Source::TIMER);
+}
+
+void test_end_stops_ticks(void) {
+    TEST_ASSERT_TRUE(sampleClock->beginTimer(1000));
+    delay(5);
+    sampleClock->end();
+    TEST_ASSERT_FALSE(sampleClock->isRunning());
+    TEST_ASSERT_FALSE(sampleClock->wait(pdMS_TO_TICKS(5)));
+    
+    const uint32_t ticks = sampleClock->getTicks();
+    delay(5);
+    TEST_ASSERT_EQUAL(ticks, sampleClock->getTicks());
+    
+    // And restarts from the first tick
+    TEST_ASSERT_TRUE(sampleClock->beginTimer(1000));
+    SampleTick tick;
+    TEST_ASSERT_TRUE(sampleClock->wait(pdMS_TO_TICKS(100)));
+    TEST_ASSERT_TRUE(sampleClock->take(tick));
+    TEST_ASSERT_TRUE(tick.index <= 2);
+}
+
+void test_data_ready_without_line_times_out(void) {
+    // Nothing is wired to the pin on a host (or a bench board without INT)
+    TEST_ASSERT_TRUE(sampleClock->beginDataReady(MPU6050_INT_PIN, IMU_PERIOD_US));
+    TEST_ASSERT_TRUE(sampleClock->getSource() == SampleClock::Source::DATA_READY);
+    TEST_ASSERT_FALSE(sampleClock->wait(pdMS_TO_TICKS(20)));
+    
+    SampleTick tick;
+    TEST_ASSERT_FALSE(sampleClock->take(tick));
+}
+
+void setup() {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_timer_ticks_at_period);
+    RUN_TEST(test_late_take_counts_missed);
+    RUN_TEST(test_first_take_is_not_missed);
+    RUN_TEST(test_begin_twice_and_zero_period_fail);
+    RUN_TEST(test_end_stops_ticks);
+    RUN_TEST(test_data_ready_without_line_times_out);
+    
+    UNITY_END();
+}
+
+void loop() {
+    // Empty
+}
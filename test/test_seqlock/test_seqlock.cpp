@@ -0,0 +1,104 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include "../../src/utils/SeqLock.h"
+
+struct Sample {
+    uint32_t sequence;
+    float values[8];
+};
+
+void setUp(void) {
+    // Empty
+}
+
+void tearDown(void) {
+    // Empty
+}
+
+void test_starts_zeroed(void) {
+    SeqLock<Sample> reg;
+    Sample s = reg.read();
+    
+    TEST_ASSERT_EQUAL(0, s.sequence);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.0f, s.values[7]);
+    TEST_ASSERT_EQUAL(0, reg.version());
+}
+
+void test_write_then_read(void) {
+    SeqLock<Sample> reg;
+    Sample in = {42, {1, 2, 3, 4, 5, 6, 7, 8}};
+    reg.write(in);
+    
+    Sample out;
+    TEST_ASSERT_TRUE(reg.tryRead(out));
+    TEST_ASSERT_EQUAL(42, out.sequence);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 8.0f, out.values[7]);
+    TEST_ASSERT_EQUAL(1, reg.version());
+    
+    in.sequence = 43;
+    reg.write(in);
+    TEST_ASSERT_EQUAL(43, reg.read().sequence);
+    TEST_ASSERT_EQUAL(2, reg.version());
+}
+
+void test_concurrent_readers_never_see_torn_values(void) {
+    // Writer fills every field with the same value; a torn read would mix
+    // fields from two different writes.
+    static SeqLock<Sample> reg;
+    const uint32_t WRITES = 200000;
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> torn(0);
+    std::atomic<uint32_t> backwards(0);
+    
+    auto reader = [&]() {
+        uint32_t last = 0;
+        while (!done.load()) {
+            Sample s = reg.read();
+            for (int i = 0; i < 8; i++) {
+                if (s.values[i] != (float)s.sequence) {
+                    torn++;
+                    break;
+                }
+            }
+            if (s.sequence < last) {
+                backwards++;
+            }
+            last = s.sequence;
+        }
+    };
+    
+    std::thread r1(reader);
+    std::thread r2(reader);
+    
+    for (uint32_t i = 1; i <= WRITES; i++) {
+        Sample s;
+        s.sequence = i;
+        for (int j = 0; j < 8; j++) {
+            s.values[j] = (float)i;
+        }
+        reg.write(s);
+    }
+    done.store(true);
+    r1.join();
+    r2.join();
+    
+    TEST_ASSERT_EQUAL(0, torn.load());
+    TEST_ASSERT_EQUAL(0, backwards.load());
+    TEST_ASSERT_EQUAL(WRITES, reg.version());
+}
+
+void setup() {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_starts_zeroed);
+    RUN_TEST(test_write_then_read);
+    RUN_TEST(test_concurrent_readers_never_see_torn_values);
+    
+    UNITY_END();
+}
+
+void loop() {
+    // Empty
+}
@@ -0,0 +1,184 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "../../src/sensors/synthetic.h"
+
+// The generators run on their own clock, so these tests sleep and check
+// counts with some slack for scheduling.
+
+IMU* imu = nullptr;
+GPS* gps = nullptr;
+
+void setUp(void) {
+    imu = new IMU();
+    gps = new GPS();
+}
+
+void tearDown(void) {
+    delete imu;
+    delete gps;
+    imu = nullptr;
+    gps = nullptr;
+}
+
+static size_t drainIMU(SyntheticIMU& source, StampedIMU* samples, size_t maxSamples) {
+    size_t total = 0;
+    size_t count;
+    while (total < maxSamples && (count = source.poll(samples + total, maxSamples - total)) > 0) {
+        total += count;
+    }
+    return total;
+}
+
+void test_imu_samples_on_schedule(void) {
+    SyntheticIMUConfig config;
+    config.rateHz = 1000;
+    SyntheticIMU source(*imu, config);
+    
+    static StampedIMU samples[256];
+    size_t total = drainIMU(source, samples, 256);
+    delay(50);
+    total += drainIMU(source, samples + total, 256 - total);
+    
+    TEST_ASSERT_INT_WITHIN(15, 51, total);
+    for (size_t i = 1; i < total; i++) {
+        TEST_ASSERT_EQUAL(samples[i - 1].data.timestamp_ms + 1, samples[i].data.timestamp_ms);
+        TEST_ASSERT_EQUAL(samples[i - 1].acquired_us + 1000, samples[i].acquired_us);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, GRAVITY_MS2, samples[total - 1].data.accel_z);
+    TEST_ASSERT_EQUAL(total, source.getStats().samples);
+    TEST_ASSERT_EQUAL(0, source.getStats().skipped);
+}
+
+void test_imu_run_length(void) {
+    SyntheticIMUConfig config;
+    config.rateHz = 1000;
+    config.runMs = 20;
+    SyntheticIMU source(*imu, config);
+    
+    StampedIMU samples[64];
+    drainIMU(source, samples, 64);
+    TEST_ASSERT_FALSE(source.isFinished());
+    delay(40);
+    drainIMU(source, samples, 64);
+    
+    TEST_ASSERT_TRUE(source.isFinished());
+    TEST_ASSERT_EQUAL(20, source.getStats().samples);
+}
+
+void test_imu_skips_backlog(void) {
+    SyntheticIMUConfig config;
+    config.rateHz = 1000;
+    SyntheticIMU source(*imu, config);
+    
+    static StampedIMU samples[256];
+    drainIMU(source, samples, 256);
+    delay(300);
+    size_t total = drainIMU(source, samples, 256);
+    
+    // Only the last MAX_BACKLOG_MS worth is handed on
+    TEST_ASSERT_INT_WITHIN(5, SyntheticIMU::MAX_BACKLOG_MS, total);
+    TEST_ASSERT_INT_WITHIN(30, 200, source.getStats().skipped);
+}
+
+void test_imu_impact_profile(void) {
+    SyntheticIMUConfig config = SyntheticIMUConfig::forProfile(SyntheticProfile::IMPACTS);
+    config.rateHz = 1000;
+    SyntheticIMU source(*imu, config);
+    
+    // The first impact starts with the first sample
+    static StampedIMU samples[256];
+    float peak = 0.0f;
+    for (int i = 0; i < 8; i++) {
+        size_t count = drainIMU(source, samples, 256);
+        for (size_t j = 0; j < count; j++) {
+            peak = max(peak, samples[j].data.accel_z / GRAVITY_MS2);
+        }
+        delay(50);
+    }
+    
+    TEST_ASSERT_EQUAL(1, source.getStats().impacts);
+    TEST_ASSERT_TRUE(peak > ALERT_G_FORCE_CRIT);
+}
+
+static SyntheticGPSConfig cleanGPS() {
+    SyntheticGPSConfig config;
+    config.rateHz = 25;
+    config.noiseM = 0.0f;
+    config.dropoutRate = 0.0f;
+    config.corruptRate = 0.0f;
+    config.outageEveryMs = 0;
+    return config;
+}
+
+static uint32_t drainGPS(SyntheticGPS& source, uint32_t forMs) {
+    uint32_t fixes = 0;
+    uint32_t start = millis();
+    StampedGPS fix;
+    while (millis() - start < forMs) {
+        while (source.poll(fix)) fixes++;
+        delay(5);
+    }
+    return fixes;
+}
+
+void test_gps_stream_parses(void) {
+    SyntheticGPSConfig config = cleanGPS();
+    SyntheticGPS source(*gps, config);
+    
+    uint32_t fixes = drainGPS(source, 200);
+    
+    TEST_ASSERT_INT_WITHIN(2, 6, fixes);
+    TEST_ASSERT_TRUE(gps->hasFix());
+    TEST_ASSERT_EQUAL(2 * fixes, gps->getSentenceCount());
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 100.0f, gps->getParseSuccessRate());
+    
+    // On the lap around the centre
+    const double northM = (gps->getLatitude() - config.latitude) * 111320.0;
+    TEST_ASSERT_TRUE(fabs(northM) <= config.radiusM + 1.0);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, config.speedKmh, gps->getSpeedKmh());
+}
+
+void test_gps_corruption_rejected(void) {
+    SyntheticGPSConfig config = cleanGPS();
+    config.corruptRate = 1.0f;
+    SyntheticGPS source(*gps, config);
+    
+    uint32_t fixes = drainGPS(source, 100);
+    
+    TEST_ASSERT_TRUE(fixes > 0);
+    TEST_ASSERT_EQUAL(2 * fixes, source.getStats().corrupted);
+    TEST_ASSERT_FALSE(gps->hasFix());
+    TEST_ASSERT_EQUAL(0, gps->getSentenceCount());
+}
+
+void test_gps_dropouts(void) {
+    SyntheticGPSConfig config = cleanGPS();
+    config.dropoutRate = 1.0f;
+    SyntheticGPS source(*gps, config);
+    
+    uint32_t fixes = drainGPS(source, 100);
+    
+    // Stale fixes still come out on time, with nothing behind them
+    TEST_ASSERT_TRUE(fixes > 0);
+    TEST_ASSERT_EQUAL(fixes, source.getStats().dropped);
+    TEST_ASSERT_EQUAL(0, source.getStats().bytes);
+    TEST_ASSERT_FALSE(gps->hasFix());
+}
+
+void setup() {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_imu_samples_on_schedule);
+    RUN_TEST(test_imu_run_length);
+    RUN_TEST(test_imu_skips_backlog);
+    RUN_TEST(test_imu_impact_profile);
+    RUN_TEST(test_gps_stream_parses);
+    RUN_TEST(test_gps_corruption_rejected);
+    RUN_TEST(test_gps_dropouts);
+    
+    UNITY_END();
+}
+
+void loop() {
+    // Empty
+}
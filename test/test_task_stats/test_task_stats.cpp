@@ -0,0 +1,137 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "../../src/core/TaskStats.h"
+
+// Passes are fed explicit start/end times, so nothing here sleeps
+
+void setUp(void) {
+    // Empty
+}
+
+void tearDown(void) {
+    // Empty
+}
+
+void test_run_time_percentiles(void) {
+    static TaskStats stats("test", 0, 0);
+    for (uint32_t i = 0; i < 100; i++) {
+        stats.record(i * 1000, i * 1000 + (i < 99 ? 20 : 700));
+    }
+    TaskStatsSnapshot s = stats.snapshot();
+    
+    TEST_ASSERT_EQUAL_STRING("test", s.name);
+    TEST_ASSERT_EQUAL(100, s.iterations);
+    TEST_ASSERT_EQUAL(20, s.runTime.p50);
+    TEST_ASSERT_EQUAL(20, s.runTime.p99);
+    TEST_ASSERT_EQUAL(700, s.runTime.max);
+    TEST_ASSERT_EQUAL(0, s.deadlineMisses);
+    TEST_ASSERT_EQUAL(0, s.jitter.count);
+}
+
+void test_jitter_against_period(void) {
+    // 10ms period; every tenth pass starts 3ms late, the next one early
+    static TaskStats stats("sensor", 10000, 0);
+    uint32_t start = 0;
+    for (uint32_t i = 0; i < 50; i++) {
+        start += 10000 + (i % 10 == 5 ? 3000 : 0) - (i % 10 == 6 ? 3000 : 0);
+        stats.record(start, start + 100);
+    }
+    TaskStatsSnapshot s = stats.snapshot();
+    
+    // The first pass has nothing to be measured against
+    TEST_ASSERT_EQUAL(49, s.jitter.count);
+    TEST_ASSERT_EQUAL(0, s.jitter.p50);
+    TEST_ASSERT_INT_WITHIN(3000 / 16, 3000, s.jitter.p99);
+    TEST_ASSERT_EQUAL(3000, s.jitter.max);
+}
+
+void test_periodic_deadline_includes_lateness(void) {
+    static TaskStats stats("sensor", 10000, 2000);
+    stats.record(0, 100);
+    stats.record(10000, 11500);    // On time, runs 1.5ms: made it
+    stats.record(21500, 21600);    // 1.5ms late, quick: made it
+    stats.record(33000, 33600);    // 1.5ms late, runs 0.6ms: missed
+    stats.record(41000, 44000);    // Early, but runs 3ms: missed
+    
+    TEST_ASSERT_EQUAL(2, stats.snapshot().deadlineMisses);
+}
+
+void test_event_driven_deadline_is_run_time(void) {
+    static TaskStats stats("logging", 0, 5000);
+    stats.record(0, 4000);
+    stats.record(100000, 106000);
+    stats.record(100001, 100002);
+    
+    TaskStatsSnapshot s = stats.snapshot();
+    TEST_ASSERT_EQUAL(1, s.deadlineMisses);
+    TEST_ASSERT_EQUAL(0, s.jitter.count);
+}
+
+void test_idle_breaks_period_chain(void) {
+    static TaskStats stats("compute", 20000, 5000);
+    stats.record(0, 100);
+    stats.idle();
+    stats.record(500000, 500100);   // Long gap after idling is not a miss
+    stats.record(520000, 520100);
+    
+    TaskStatsSnapshot s = stats.snapshot();
+    TEST_ASSERT_EQUAL(1, s.jitter.count);
+    TEST_ASSERT_EQUAL(0, s.jitter.max);
+    TEST_ASSERT_EQUAL(0, s.deadlineMisses);
+}
+
+void test_counter_wrap(void) {
+    // micros() wraps every 71 minutes
+    static TaskStats stats("sensor", 10000, 2000);
+    stats.record(UINT32_MAX - 4999, UINT32_MAX - 4899);
+    stats.record(5000, 5100);
+    
+    TaskStatsSnapshot s = stats.snapshot();
+    TEST_ASSERT_EQUAL(0, s.jitter.max);
+    TEST_ASSERT_EQUAL(100, s.runTime.max);
+    TEST_ASSERT_EQUAL(0, s.deadlineMisses);
+}
+
+void test_reset_starts_new_window(void) {
+    static TaskStats stats("sensor", 10000, 2000);
+    stats.record(0, 100);
+    stats.record(15000, 15100);     // Missed
+    stats.reset();
+    stats.record(25000, 25200);     // Still measured against the last pass
+    
+    TaskStatsSnapshot s = stats.snapshot();
+    TEST_ASSERT_EQUAL(1, s.iterations);
+    TEST_ASSERT_EQUAL(0, s.deadlineMisses);
+    TEST_ASSERT_EQUAL(1, s.jitter.count);
+    TEST_ASSERT_EQUAL(200, s.runTime.max);
+}
+
+void test_set_period(void) {
+    static TaskStats stats("sensor", 10000, 0);
+    stats.setPeriod(1000);
+    stats.record(0, 10);
+    stats.record(1000, 1010);
+    
+    TaskStatsSnapshot s = stats.snapshot();
+    TEST_ASSERT_EQUAL(1000, s.periodUs);
+    TEST_ASSERT_EQUAL(0, s.jitter.max);
+}
+
+void setup() {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_run_time_percentiles);
+    RUN_TEST(test_jitter_against_period);
+    RUN_TEST(test_periodic_deadline_includes_lateness);
+    RUN_TEST(test_event_driven_deadline_is_run_time);
+    RUN_TEST(test_idle_breaks_period_chain);
+    RUN_TEST(test_counter_wrap);
+    RUN_TEST(test_reset_starts_new_window);
+    RUN_TEST(test_set_period);
+    
+    UNITY_END();
+}
+
+void loop() {
+    // Empty
+}
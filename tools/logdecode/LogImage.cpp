@@ -0,0 +1,209 @@
+#include "LogImage.h"
+#include "../../src/storage/LogCodec.h"
+#include "../../src/utils/Crc.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool LogImage::open(const char* path, std::string& error) {
+    close();
+    
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open";
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)LOG_LEGACY_HEADER_SIZE) {
+        ::close(fd);
+        error = "too short to be a log";
+        return false;
+    }
+    void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        error = "cannot map";
+        return false;
+    }
+    data = (const uint8_t*)mapped;
+    size = st.st_size;
+    madvise(mapped, size, MADV_WILLNEED);
+    
+    memset(&header, 0, sizeof(header));
+    memcpy(&header, data, min(size, sizeof(header)));
+    if (header.magic != LOG_FILE_MAGIC) {
+        error = "not a log file";
+    } else if (header.version < LOG_FORMAT_LEGACY || header.version > LOG_FORMAT_STREAMS) {
+        error = "unsupported format version " + std::to_string(header.version);
+    } else if (header.crc32 != crc32(&header, offsetof(LogFileHeader, crc32))) {
+        error = "header CRC mismatch";
+    } else if (header.version == LOG_FORMAT_LEGACY) {
+        // No sequence or streams yet; blockSectors was a reserved field
+        header.fileSequence = 0;
+        header.streams = 0;
+        if (header.packetSize != sizeof(TelemetryPacket)) {
+            error = "unexpected packet size " + std::to_string(header.packetSize);
+        } else {
+            units = (size - LOG_LEGACY_HEADER_SIZE) / sizeof(TelemetryPacket);
+            return true;
+        }
+    } else if (header.blockSectors == 0 || size < LOG_SECTOR_SIZE) {
+        error = "bad block size";
+    } else {
+        blockSize = header.blockSectors * LOG_SECTOR_SIZE;
+        if (size >= LOG_SECTOR_SIZE + sizeof(LogBlockHeader)) {
+            LogBlockHeader first;
+            memcpy(&first, data + LOG_SECTOR_SIZE, sizeof(first));
+            firstBlockIndex = first.magic == LOG_BLOCK_MAGIC ? first.blockIndex : 0;
+        }
+        indexed = readFooter();
+        if (!indexed) {
+            units = walkBlocks();
+        }
+        return true;
+    }
+    
+    close();
+    return false;
+}
+
+void LogImage::close() {
+    if (data) {
+        munmap((void*)data, size);
+    }
+    data = nullptr;
+    size = 0;
+    units = 0;
+    indexed = false;
+}
+
+// A closed file's footer gives its block count directly
+bool LogImage::readFooter() {
+    LogFooter footer;
+    if (size < LOG_SECTOR_SIZE + sizeof(footer)) return false;
+    memcpy(&footer, data + size - sizeof(footer), sizeof(footer));
+    
+    const size_t entryBytes = (size_t)footer.entryCount * sizeof(LogIndexEntry);
+    if (footer.magic != LOG_FOOTER_MAGIC || footer.indexOffset < LOG_SECTOR_SIZE ||
+        footer.indexOffset + entryBytes + sizeof(footer) > size ||
+        LOG_SECTOR_SIZE + (uint64_t)footer.blockCount * blockSize > footer.indexOffset) {
+        return false;
+    }
+    uint32_t crc = crc32Update(logCrcSeed(header), data + footer.indexOffset, entryBytes);
+    crc = crc32Update(crc, &footer, sizeof(footer) - sizeof(footer.crc32));
+    if (crc != footer.crc32) {
+        return false;
+    }
+    
+    units = footer.blockCount;
+    return true;
+}
+
+bool LogImage::blockHeaderValid(uint32_t slot) const {
+    const size_t offset = LOG_SECTOR_SIZE + (size_t)slot * blockSize;
+    if (offset + blockSize > size) return false;
+    
+    LogBlockHeader block;
+    memcpy(&block, data + offset, sizeof(block));
+    return block.magic == LOG_BLOCK_MAGIC && block.blockIndex == firstBlockIndex + slot;
+}
+
+// End of the data of a file that was never closed: the last valid block
+// before a run of more than MAX_CORRUPT_RUN bad ones. Headers only, so
+// even a full-size file is a few thousand small reads of memory.
+uint32_t LogImage::walkBlocks() const {
+    const uint32_t slots = (size - LOG_SECTOR_SIZE) / blockSize;
+    uint32_t end = 0;
+    for (uint32_t slot = 0; slot < slots && slot <= end + MAX_CORRUPT_RUN; slot++) {
+        if (blockHeaderValid(slot)) {
+            end = slot + 1;
+        }
+    }
+    return end;
+}
+
+void LogImage::decode(uint32_t first, uint32_t last, uint16_t stream, LogChunk& out) const {
+    last = min(last, units);
+    
+    if (header.version == LOG_FORMAT_LEGACY) {
+        if (stream != LOG_STREAM_PACKETS) return;
+        out.packets.reserve(out.packets.size() + (last > first ? last - first : 0));
+        for (uint32_t i = first; i < last; i++) {
+            TelemetryPacket packet;
+            memcpy(&packet, data + LOG_LEGACY_HEADER_SIZE + (size_t)i * sizeof(packet), sizeof(packet));
+            if (packet.magic == PACKET_MAGIC) {
+                out.packets.push_back(packet);
+            } else {
+                out.badUnits++;
+            }
+        }
+        return;
+    }
+    
+    for (uint32_t slot = first; slot < last; slot++) {
+        decodeBlock(slot, stream, out);
+    }
+}
+
+void LogImage::decodeBlock(uint32_t slot, uint16_t stream, LogChunk& out) const {
+    if (!blockHeaderValid(slot)) {
+        out.badUnits++;
+        return;
+    }
+    const uint8_t* block = data + LOG_SECTOR_SIZE + (size_t)slot * blockSize;
+    LogBlockHeader blockHeader;
+    memcpy(&blockHeader, block, sizeof(blockHeader));
+    
+    const uint16_t blockStream = header.version >= LOG_FORMAT_STREAMS ? blockHeader.stream
+                                                                      : (uint16_t)LOG_STREAM_PACKETS;
+    if (blockStream != stream) {
+        return;
+    }
+    
+    const bool checked = header.version >= LOG_FORMAT_CHECKED;
+    if (checked) {
+        uint32_t stored;
+        memcpy(&stored, block + blockSize - LOG_BLOCK_CRC_SIZE, sizeof(stored));
+        if (crc32Update(logCrcSeed(header), block, blockSize - LOG_BLOCK_CRC_SIZE) != stored) {
+            out.badUnits++;
+            return;
+        }
+    }
+    
+    const uint8_t* payload = block + sizeof(LogBlockHeader);
+    const size_t room = blockSize - sizeof(LogBlockHeader) - (checked ? LOG_BLOCK_CRC_SIZE : 0);
+    
+    if (header.version == LOG_FORMAT_RAW) {
+        const size_t count = min((size_t)blockHeader.packetCount, room / sizeof(TelemetryPacket));
+        for (size_t i = 0; i < count; i++) {
+            TelemetryPacket packet;
+            memcpy(&packet, payload + i * sizeof(packet), sizeof(packet));
+            out.packets.push_back(packet);
+        }
+        return;
+    }
+    
+    // Delta records, coded against the previous one in the same block
+    size_t left = min((size_t)blockHeader.payloadBytes, room);
+    LogDecoder decoder;
+    LogSampleDecoder sampleDecoder;
+    for (uint16_t i = 0; i < blockHeader.packetCount; i++) {
+        size_t used;
+        if (stream == LOG_STREAM_IMU) {
+            IMUData sample;
+            used = sampleDecoder.decode(payload, left, sample);
+            if (used > 0) out.samples.push_back(sample);
+        } else {
+            TelemetryPacket packet;
+            used = decoder.decode(payload, left, packet);
+            if (used > 0) out.packets.push_back(packet);
+        }
+        if (used == 0) {
+            out.badUnits++;
+            return;
+        }
+        payload += used;
+        left -= used;
+    }
+}
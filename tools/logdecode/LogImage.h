@@ -0,0 +1,84 @@
+/**
+ * Memory-mapped Log Image
+ *
+ * A log file mapped read-only into memory, for host tools. open()
+ * validates the file header (magic, version, CRC) and finds the data:
+ *
+ *   format 1        The original logger: a 50-byte header followed by
+ *                   whole TelemetryPackets. Units are packets.
+ *   formats 2..5    LogFormat.h blocks. Units are block slots, counted
+ *                   from the footer of a closed file, or by walking the
+ *                   block headers of one that was never closed (up to
+ *                   the first run of more than MAX_CORRUPT_RUN bad ones).
+ *
+ * decode() turns any range of units into records, verifying block CRCs
+ * (format 4 on) as it goes. It touches only the mapping and its own
+ * output, so disjoint ranges can be decoded on as many threads as there
+ * are cores.
+ */
+
+#pragma once
+
+#include "../../src/storage/LogFormat.h"
+#include <string>
+#include <vector>
+
+// Records of one range of units, in file order
+struct LogChunk {
+    std::vector<TelemetryPacket> packets;
+    std::vector<IMUData> samples;
+    uint32_t badUnits = 0;    // Blocks (or legacy packets) that failed validation
+};
+
+class LogImage {
+public:
+    static constexpr uint8_t MAX_CORRUPT_RUN = 4;
+    
+private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    LogFileHeader header;
+    uint32_t blockSize = 0;
+    uint32_t firstBlockIndex = 0;
+    uint32_t units = 0;
+    bool indexed = false;
+    
+    bool readFooter();
+    uint32_t walkBlocks() const;
+    bool blockHeaderValid(uint32_t slot) const;
+    void decodeBlock(uint32_t slot, uint16_t stream, LogChunk& out) const;
+    
+public:
+    LogImage() {}
+    ~LogImage() { close(); }
+    LogImage(const LogImage&) = delete;
+    LogImage& operator=(const LogImage&) = delete;
+    
+    /**
+     * @brief Map a file and validate it
+     * @param error Set to the reason when false is returned
+     */
+    bool open(const char* path, std::string& error);
+    void close();
+    
+    /**
+     * @brief Records of units [first, last) of a stream (LogStream)
+     */
+    void decode(uint32_t first, uint32_t last, uint16_t stream, LogChunk& out) const;
+    
+    const LogFileHeader& getHeader() const { return header; }
+    uint32_t getUnitCount() const { return units; }
+    size_t getSize() const { return size; }
+    
+    // Bytes up to the last unit (preallocated space left out)
+    uint64_t getDataSize() const {
+        return header.version == LOG_FORMAT_LEGACY
+            ? offsetof(LogFileHeader, fileSequence) + (uint64_t)units * header.packetSize
+            : LOG_SECTOR_SIZE + (uint64_t)units * blockSize;
+    }
+    bool hasIndex() const { return indexed; }
+    bool hasStream(uint16_t stream) const {
+        return header.version >= LOG_FORMAT_STREAMS ? (header.streams >> stream) & 1
+                                                    : stream == LOG_STREAM_PACKETS;
+    }
+};
@@ -0,0 +1,355 @@
+/**
+ * logdecode - decode rally_NNN.bin logs on a host machine
+ *
+ *   logdecode [-f csv|cols] [-s packets|imu] [-j threads] [-o dir] file...
+ *
+ * Each file is mapped into memory, validated (LogImage), split into
+ * chunks of blocks and decoded on all cores. CSV rows are formatted on
+ * the worker threads too, with the firmware's CsvExporter, so the output
+ * matches /api/convert. Chunks are written out in file order.
+ *
+ * Output goes next to each input (or into -o dir): rally_003.csv, or
+ * rally_003_imu.csv for the raw IMU stream; .cols for columnar output.
+ *
+ * Columnar files (-f cols) hold each field as one contiguous
+ * little-endian array, so analysis code can map a column straight into
+ * an array (numpy.frombuffer, etc.):
+ *
+ *   ColumnFileHeader
+ *   ColumnDesc[columns]
+ *   column data, each array starting at its desc's offset (8-byte aligned)
+ */
+
+#include "LogImage.h"
+#include "../../src/storage/CsvExporter.h"
+#include <atomic>
+#include <chrono>
+#include <getopt.h>
+#include <sys/stat.h>
+#include <thread>
+
+struct __attribute__((packed)) ColumnFileHeader {
+    char magic[4];            // "RCOL"
+    uint16_t version;         // 1
+    uint16_t columns;
+    uint64_t rows;
+};
+
+struct __attribute__((packed)) ColumnDesc {
+    char name[20];            // NUL-padded
+    char type;                // 'u' unsigned, 'f' float
+    uint8_t size;             // Bytes per value
+    uint8_t reserved[2];
+    uint64_t offset;          // File offset of the array
+};
+
+static const char* IMU_CSV_HEADER = "Timestamp,AccelX,AccelY,AccelZ,GyroX,GyroY,GyroZ,TempC\n";
+
+struct Options {
+    bool columnar = false;
+    uint16_t stream = LOG_STREAM_PACKETS;
+    unsigned threads = 0;
+    std::string outDir;
+};
+
+// One chunk of a file: a range of units, its records, and its CSV text
+struct Job {
+    uint32_t first;
+    uint32_t last;
+    LogChunk chunk;
+    size_t rows = 0;
+    std::string text;
+};
+
+static size_t formatSample(const IMUData& sample, char* out) {
+    char* p = out;
+    p = CsvExporter::formatUnsigned(p, sample.timestamp_ms);
+    const float values[] = {sample.accel_x, sample.accel_y, sample.accel_z,
+                            sample.gyro_x, sample.gyro_y, sample.gyro_z};
+    for (float value : values) {
+        *p++ = ',';
+        p = CsvExporter::formatFixed(p, value, 3);
+    }
+    *p++ = ',';
+    p = CsvExporter::formatFixed(p, sample.temperature, 2);
+    *p++ = '\n';
+    return p - out;
+}
+
+static void formatJob(Job& job) {
+    char row[CsvExporter::MAX_ROW_SIZE];
+    job.text.reserve((job.chunk.packets.size() + job.chunk.samples.size()) * 128);
+    for (const TelemetryPacket& packet : job.chunk.packets) {
+        job.text.append(row, CsvExporter::formatRow(packet, row));
+    }
+    for (const IMUData& sample : job.chunk.samples) {
+        job.text.append(row, formatSample(sample, row));
+    }
+    
+    // Only the text is needed from here on
+    std::vector<TelemetryPacket>().swap(job.chunk.packets);
+    std::vector<IMUData>().swap(job.chunk.samples);
+}
+
+// Writes one column per field, gathering values across all jobs
+class ColumnWriter {
+private:
+    FILE* out;
+    const std::vector<Job>& jobs;
+    std::vector<ColumnDesc> descs;
+    uint64_t rows = 0;
+    uint64_t offset = 0;
+    
+    void pad() {
+        static const uint8_t zeros[8] = {0};
+        const uint64_t aligned = (offset + 7) & ~7ULL;
+        fwrite(zeros, 1, aligned - offset, out);
+        offset = aligned;
+    }
+    
+public:
+    ColumnWriter(FILE* file, const std::vector<Job>& allJobs, size_t rowCount, size_t columns)
+        : out(file), jobs(allJobs), rows(rowCount) {
+        descs.reserve(columns);
+        offset = sizeof(ColumnFileHeader) + columns * sizeof(ColumnDesc);
+    }
+    
+    // Reserve the header and directory; filled in by finish()
+    void begin() {
+        std::vector<uint8_t> zeros(offset, 0);
+        fwrite(zeros.data(), 1, zeros.size(), out);
+    }
+    
+    template<typename Record, typename Value, typename Get>
+    void column(const char* name, char type, Get get) {
+        pad();
+        ColumnDesc desc;
+        memset(&desc, 0, sizeof(desc));
+        strncpy(desc.name, name, sizeof(desc.name));
+        desc.type = type;
+        desc.size = sizeof(Value);
+        desc.offset = offset;
+        descs.push_back(desc);
+        
+        std::vector<Value> values;
+        for (const Job& job : jobs) {
+            const std::vector<Record>& records = recordsOf<Record>(job.chunk);
+            values.resize(records.size());
+            for (size_t i = 0; i < records.size(); i++) {
+                values[i] = get(records[i]);
+            }
+            fwrite(values.data(), sizeof(Value), values.size(), out);
+            offset += values.size() * sizeof(Value);
+        }
+    }
+    
+    void finish() {
+        ColumnFileHeader header;
+        memcpy(header.magic, "RCOL", 4);
+        header.version = 1;
+        header.columns = descs.size();
+        header.rows = rows;
+        fseek(out, 0, SEEK_SET);
+        fwrite(&header, sizeof(header), 1, out);
+        fwrite(descs.data(), sizeof(ColumnDesc), descs.size(), out);
+    }
+    
+    template<typename Record>
+    static const std::vector<Record>& recordsOf(const LogChunk& chunk);
+};
+
+template<>
+const std::vector<TelemetryPacket>& ColumnWriter::recordsOf<TelemetryPacket>(const LogChunk& chunk) {
+    return chunk.packets;
+}
+
+template<>
+const std::vector<IMUData>& ColumnWriter::recordsOf<IMUData>(const LogChunk& chunk) {
+    return chunk.samples;
+}
+
+static void writeColumns(FILE* out, const std::vector<Job>& jobs, size_t rows, uint16_t stream) {
+    typedef TelemetryPacket P;
+    typedef IMUData S;
+    if (stream == LOG_STREAM_IMU) {
+        ColumnWriter writer(out, jobs, rows, 8);
+        writer.begin();
+        writer.column<S, uint32_t>("timestamp_ms", 'u', [](const S& s) { return s.timestamp_ms; });
+        writer.column<S, float>("accel_x", 'f', [](const S& s) { return s.accel_x; });
+        writer.column<S, float>("accel_y", 'f', [](const S& s) { return s.accel_y; });
+        writer.column<S, float>("accel_z", 'f', [](const S& s) { return s.accel_z; });
+        writer.column<S, float>("gyro_x", 'f', [](const S& s) { return s.gyro_x; });
+        writer.column<S, float>("gyro_y", 'f', [](const S& s) { return s.gyro_y; });
+        writer.column<S, float>("gyro_z", 'f', [](const S& s) { return s.gyro_z; });
+        writer.column<S, float>("temperature", 'f', [](const S& s) { return s.temperature; });
+        writer.finish();
+        return;
+    }
+    
+    ColumnWriter writer(out, jobs, rows, 16);
+    writer.begin();
+    writer.column<P, uint32_t>("timestamp_ms", 'u', [](const P& p) { return p.timestamp_ms; });
+    writer.column<P, uint16_t>("sequence", 'u', [](const P& p) { return p.sequence; });
+    writer.column<P, float>("accel_x", 'f', [](const P& p) { return p.imu.accel_x; });
+    writer.column<P, float>("accel_y", 'f', [](const P& p) { return p.imu.accel_y; });
+    writer.column<P, float>("accel_z", 'f', [](const P& p) { return p.imu.accel_z; });
+    writer.column<P, float>("gyro_x", 'f', [](const P& p) { return p.imu.gyro_x; });
+    writer.column<P, float>("gyro_y", 'f', [](const P& p) { return p.imu.gyro_y; });
+    writer.column<P, float>("gyro_z", 'f', [](const P& p) { return p.imu.gyro_z; });
+    writer.column<P, float>("temperature", 'f', [](const P& p) { return p.imu.temperature; });
+    writer.column<P, double>("latitude", 'f', [](const P& p) { return p.gps.latitude; });
+    writer.column<P, double>("longitude", 'f', [](const P& p) { return p.gps.longitude; });
+    writer.column<P, float>("altitude", 'f', [](const P& p) { return p.gps.altitude; });
+    writer.column<P, float>("speed_kmh", 'f', [](const P& p) { return p.gps.speed_kmh; });
+    writer.column<P, float>("heading", 'f', [](const P& p) { return p.gps.heading; });
+    writer.column<P, uint8_t>("satellites", 'u', [](const P& p) { return p.gps.satellites; });
+    writer.column<P, uint8_t>("fix_quality", 'u', [](const P& p) { return p.gps.fix_quality; });
+    writer.finish();
+}
+
+static std::string outputPath(const char* input, const Options& options) {
+    std::string path = input;
+    const size_t slash = path.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : path.substr(0, slash);
+    std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    const size_t dot = name.rfind('.');
+    if (dot != std::string::npos) name.erase(dot);
+    
+    if (!options.outDir.empty()) dir = options.outDir;
+    if (options.stream == LOG_STREAM_IMU) name += "_imu";
+    return dir + "/" + name + (options.columnar ? ".cols" : ".csv");
+}
+
+static bool decodeFile(const char* path, const Options& options) {
+    const auto start = std::chrono::steady_clock::now();
+    
+    LogImage image;
+    std::string error;
+    if (!image.open(path, error)) {
+        fprintf(stderr, "%s: %s\n", path, error.c_str());
+        return false;
+    }
+    if (!image.hasStream(options.stream)) {
+        fprintf(stderr, "%s: no %s stream\n", path,
+                options.stream == LOG_STREAM_IMU ? "raw IMU" : "packet");
+        return false;
+    }
+    
+    // A few chunks per thread, so an uneven chunk does not hold up the rest
+    const uint32_t units = image.getUnitCount();
+    const uint32_t chunkCount = max(1u, min(units, options.threads * 4));
+    std::vector<Job> jobs(chunkCount);
+    for (uint32_t i = 0; i < chunkCount; i++) {
+        jobs[i].first = (uint64_t)units * i / chunkCount;
+        jobs[i].last = (uint64_t)units * (i + 1) / chunkCount;
+    }
+    
+    std::atomic<uint32_t> nextJob{0};
+    auto work = [&]() {
+        for (uint32_t i = nextJob++; i < chunkCount; i = nextJob++) {
+            image.decode(jobs[i].first, jobs[i].last, options.stream, jobs[i].chunk);
+            jobs[i].rows = jobs[i].chunk.packets.size() + jobs[i].chunk.samples.size();
+            if (!options.columnar) {
+                formatJob(jobs[i]);
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < options.threads; i++) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    
+    size_t rows = 0;
+    uint32_t badUnits = 0;
+    for (const Job& job : jobs) {
+        rows += job.rows;
+        badUnits += job.chunk.badUnits;
+    }
+    
+    const std::string outPath = outputPath(path, options);
+    FILE* out = fopen(outPath.c_str(), "wb");
+    if (!out) {
+        fprintf(stderr, "%s: cannot write %s\n", path, outPath.c_str());
+        return false;
+    }
+    if (options.columnar) {
+        writeColumns(out, jobs, rows, options.stream);
+    } else {
+        fputs(options.stream == LOG_STREAM_IMU ? IMU_CSV_HEADER : CsvExporter::HEADER, out);
+        for (const Job& job : jobs) {
+            fwrite(job.text.data(), 1, job.text.size(), out);
+        }
+    }
+    const bool ok = fclose(out) == 0;
+    
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    fprintf(stderr, "%s: format %u, %u %s%s (%u bad), %zu rows -> %s in %.2fs (%.0f MB/s)\n",
+            path, image.getHeader().version, units,
+            image.getHeader().version == LOG_FORMAT_LEGACY ? "packets" : "blocks",
+            image.hasIndex() ? ", indexed" : "", badUnits, rows, outPath.c_str(),
+            seconds, image.getDataSize() / 1e6 / max(seconds, 1e-6));
+    return ok;
+}
+
+static void usage() {
+    fprintf(stderr,
+            "usage: logdecode [-f csv|cols] [-s packets|imu] [-j threads] [-o dir] file...\n"
+            "  -f  output format: CSV (default) or columnar binary\n"
+            "  -s  stream to decode: fused packets (default) or raw IMU samples\n"
+            "  -j  decoding threads (default: all cores)\n"
+            "  -o  output directory (default: next to each input)\n");
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    options.threads = std::thread::hardware_concurrency();
+    
+    int opt;
+    while ((opt = getopt(argc, argv, "f:s:j:o:h")) != -1) {
+        switch (opt) {
+            case 'f':
+                if (strcmp(optarg, "csv") != 0 && strcmp(optarg, "cols") != 0) {
+                    usage();
+                    return 2;
+                }
+                options.columnar = strcmp(optarg, "cols") == 0;
+                break;
+            case 's':
+                if (strcmp(optarg, "packets") != 0 && strcmp(optarg, "imu") != 0) {
+                    usage();
+                    return 2;
+                }
+                options.stream = strcmp(optarg, "imu") == 0 ? LOG_STREAM_IMU : LOG_STREAM_PACKETS;
+                break;
+            case 'j':
+                options.threads = atoi(optarg);
+                break;
+            case 'o':
+                options.outDir = optarg;
+                break;
+            default:
+                usage();
+                return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (optind >= argc) {
+        usage();
+        return 2;
+    }
+    if (options.threads == 0) {
+        options.threads = 1;
+    }
+    if (!options.outDir.empty()) {
+        mkdir(options.outDir.c_str(), 0755);
+    }
+    
+    int failures = 0;
+    for (int i = optind; i < argc; i++) {
+        failures += decodeFile(argv[i], options) ? 0 : 1;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,274 @@
+/**
+ * logdecode self-test (ctest)
+ *
+ * Writes logs in every format LogImage reads - format 1 and synthetic
+ * format 2..4 files by hand, format 5 through BinaryLogger itself, closed
+ * and cut off - and checks that decoding them in any number of chunks
+ * gives back every record in order.
+ */
+
+#include "LogImage.h"
+#include "../../src/storage/BinaryLogger.h"
+#include "../../src/storage/LogCodec.h"
+#include <stdio.h>
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+static const uint32_t COUNT = 5000;
+
+static TelemetryPacket makePacket(uint32_t i) {
+    TelemetryPacket packet;
+    memset(&packet, 0, sizeof(packet));
+    packet.magic = PACKET_MAGIC;
+    packet.version = PACKET_VERSION;
+    packet.sequence = i;
+    packet.timestamp_ms = 1000 + i * 20;
+    packet.imu.accel_x = i * 0.5f;
+    packet.gps.latitude = 48.0 + i * 1e-6;
+    return packet;
+}
+
+static IMUData makeSample(uint32_t i) {
+    IMUData sample;
+    memset(&sample, 0, sizeof(sample));
+    sample.timestamp_ms = 1000 + i * 10;
+    sample.gyro_z = i * 0.25f;
+    return sample;
+}
+
+static std::string hostPath(const char* name) {
+    return std::string(SD_MOUNT_POINT) + name;
+}
+
+static LogFileHeader makeHeader(uint16_t version) {
+    LogFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = LOG_FILE_MAGIC;
+    header.version = version;
+    header.packetSize = sizeof(TelemetryPacket);
+    header.blockSectors = version == LOG_FORMAT_LEGACY ? 0 : LOG_BLOCK_SIZE / LOG_SECTOR_SIZE;
+    strncpy(header.vehicleId, "SELFTEST", sizeof(header.vehicleId));
+    header.crc32 = crc32(&header, offsetof(LogFileHeader, crc32));
+    return header;
+}
+
+// Format 1: the 50-byte header, then packets back to back
+static void writeLegacy(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "wb");
+    LogFileHeader header = makeHeader(LOG_FORMAT_LEGACY);
+    fwrite(&header, offsetof(LogFileHeader, fileSequence), 1, f);
+    for (uint32_t i = 0; i < COUNT; i++) {
+        TelemetryPacket packet = makePacket(i);
+        fwrite(&packet, sizeof(packet), 1, f);
+    }
+    fclose(f);
+}
+
+// Formats 2..4, never closed: header sector, then full blocks
+static void writeBlocks(const std::string& path, uint16_t version) {
+    FILE* f = fopen(path.c_str(), "wb");
+    LogFileHeader header = makeHeader(version);
+    static uint8_t block[LOG_BLOCK_SIZE];
+    memset(block, 0, LOG_SECTOR_SIZE);
+    memcpy(block, &header, sizeof(header));
+    fwrite(block, LOG_SECTOR_SIZE, 1, f);
+    
+    const bool checked = version >= LOG_FORMAT_CHECKED;
+    const size_t room = LOG_BLOCK_SIZE - sizeof(LogBlockHeader) - (checked ? LOG_BLOCK_CRC_SIZE : 0);
+    uint32_t next = 0;
+    for (uint32_t blockIndex = 0; next < COUNT; blockIndex++) {
+        memset(block, 0, sizeof(block));
+        uint8_t* payload = block + sizeof(LogBlockHeader);
+        size_t bytes = 0;
+        uint16_t count = 0;
+        LogEncoder encoder;
+        while (next < COUNT) {
+            const TelemetryPacket packet = makePacket(next);
+            if (version == LOG_FORMAT_RAW) {
+                if (room - bytes < sizeof(packet)) break;
+                memcpy(payload + bytes, &packet, sizeof(packet));
+                bytes += sizeof(packet);
+            } else {
+                if (room - bytes < LOG_MAX_RECORD_SIZE) break;
+                bytes += encoder.encode(packet, payload + bytes);
+            }
+            count++;
+            next++;
+        }
+        
+        LogBlockHeader blockHeader;
+        blockHeader.magic = LOG_BLOCK_MAGIC;
+        blockHeader.blockIndex = blockIndex;
+        blockHeader.packetCount = count;
+        blockHeader.stream = sizeof(TelemetryPacket);
+        blockHeader.payloadBytes = version == LOG_FORMAT_RAW ? 0 : bytes;
+        memcpy(block, &blockHeader, sizeof(blockHeader));
+        if (checked) {
+            uint32_t crc = crc32Update(logCrcSeed(header), block, LOG_BLOCK_SIZE - LOG_BLOCK_CRC_SIZE);
+            memcpy(block + LOG_BLOCK_SIZE - LOG_BLOCK_CRC_SIZE, &crc, sizeof(crc));
+        }
+        fwrite(block, LOG_BLOCK_SIZE, 1, f);
+    }
+    fclose(f);
+}
+
+static void copyFile(const std::string& from, const std::string& to) {
+    FILE* in = fopen(from.c_str(), "rb");
+    FILE* out = fopen(to.c_str(), "wb");
+    static uint8_t buffer[64 * 1024];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        fwrite(buffer, 1, got, out);
+    }
+    fclose(in);
+    fclose(out);
+}
+
+// Format 5 through the logger: a closed copy and one cut off mid-file
+static void writeStreams(const std::string& closedPath, const std::string& openPath) {
+    SD.begin(SD_CS_PIN, SPI, SD_SPI_FREQUENCY, SD_MOUNT_POINT);
+    for (uint32_t i = 0; i < MAX_LOG_FILES; i++) {
+        char filename[32];
+        LogCatalog::slotFilename(i, filename, sizeof(filename));
+        SD.remove(filename);
+    }
+    SD.remove(LOG_CATALOG_FILE);
+    
+    BinaryLogger* logger = new BinaryLogger();
+    CHECK(logger->begin());
+    for (uint32_t i = 0; i < COUNT; i++) {
+        TelemetryPacket packet = makePacket(i);
+        IMUData samples[2] = {makeSample(2 * i), makeSample(2 * i + 1)};
+        while (!logger->write(packet)) vTaskDelay(1);
+        while (logger->write(samples, 2) != 2) vTaskDelay(1);
+    }
+    CHECK(logger->sync());
+    
+    char filename[32];
+    logger->getCurrentFilename(filename, sizeof(filename));
+    copyFile(hostPath(filename), openPath);
+    logger->end();
+    delete logger;
+    copyFile(hostPath(filename), closedPath);
+}
+
+// Decode in `chunks` pieces and put them back together
+static LogChunk decodeAll(const LogImage& image, uint16_t stream, uint32_t chunks) {
+    LogChunk all;
+    const uint32_t units = image.getUnitCount();
+    for (uint32_t i = 0; i < chunks; i++) {
+        LogChunk part;
+        image.decode((uint64_t)units * i / chunks, (uint64_t)units * (i + 1) / chunks, stream, part);
+        all.packets.insert(all.packets.end(), part.packets.begin(), part.packets.end());
+        all.samples.insert(all.samples.end(), part.samples.begin(), part.samples.end());
+        all.badUnits += part.badUnits;
+    }
+    return all;
+}
+
+static void checkPackets(const std::string& path, uint16_t version, bool indexed) {
+    LogImage image;
+    std::string error;
+    CHECK(image.open(path.c_str(), error));
+    CHECK(image.getHeader().version == version);
+    CHECK(image.hasIndex() == indexed);
+    
+    const uint32_t splits[] = {1, 3, 16};
+    for (uint32_t chunks : splits) {
+        LogChunk all = decodeAll(image, LOG_STREAM_PACKETS, chunks);
+        CHECK(all.badUnits == 0);
+        CHECK(all.packets.size() == COUNT);
+        for (uint32_t i = 0; i < all.packets.size() && i < COUNT; i++) {
+            if (all.packets[i].sequence != i || all.packets[i].timestamp_ms != 1000 + i * 20 ||
+                fabsf(all.packets[i].imu.accel_x - i * 0.5f) > 0.001f) {
+                fprintf(stderr, "%s: packet %u differs\n", path.c_str(), (unsigned)i);
+                failures++;
+                break;
+            }
+        }
+    }
+}
+
+static void checkSamples(const std::string& path) {
+    LogImage image;
+    std::string error;
+    CHECK(image.open(path.c_str(), error));
+    CHECK(image.hasStream(LOG_STREAM_IMU));
+    
+    LogChunk all = decodeAll(image, LOG_STREAM_IMU, 5);
+    CHECK(all.badUnits == 0);
+    CHECK(all.packets.empty());
+    CHECK(all.samples.size() == 2 * COUNT);
+    for (uint32_t i = 0; i < all.samples.size(); i++) {
+        if (all.samples[i].timestamp_ms != 1000 + i * 10) {
+            fprintf(stderr, "%s: sample %u differs\n", path.c_str(), (unsigned)i);
+            failures++;
+            break;
+        }
+    }
+}
+
+// A damaged block costs only its own packets
+static void checkCorruptBlock(const std::string& from, const std::string& path) {
+    copyFile(from, path);
+    FILE* f = fopen(path.c_str(), "r+b");
+    fseek(f, LOG_SECTOR_SIZE + LOG_BLOCK_SIZE + 100, SEEK_SET);
+    fputc(0x5A, f);
+    fclose(f);
+    
+    LogImage image;
+    std::string error;
+    CHECK(image.open(path.c_str(), error));
+    LogChunk all = decodeAll(image, LOG_STREAM_PACKETS, 4);
+    CHECK(all.badUnits == 1);
+    CHECK(all.packets.size() < COUNT);
+    CHECK(all.packets.size() > COUNT - LOG_BLOCK_SIZE / 8);
+    CHECK(!all.packets.empty() && all.packets.back().sequence == COUNT - 1);
+}
+
+static void checkRejects(const std::string& from, const std::string& path) {
+    copyFile(from, path);
+    FILE* f = fopen(path.c_str(), "r+b");
+    fseek(f, offsetof(LogFileHeader, vehicleId), SEEK_SET);
+    fputc('X', f);
+    fclose(f);
+    
+    LogImage image;
+    std::string error;
+    CHECK(!image.open(path.c_str(), error));
+    CHECK(error == "header CRC mismatch");
+}
+
+int main() {
+    const std::string dir = SD_MOUNT_POINT;
+    writeStreams(dir + "/v5_closed.bin", dir + "/v5_open.bin");
+    writeLegacy(dir + "/v1.bin");
+    writeBlocks(dir + "/v2.bin", LOG_FORMAT_RAW);
+    writeBlocks(dir + "/v3.bin", LOG_FORMAT_DELTA);
+    writeBlocks(dir + "/v4.bin", LOG_FORMAT_CHECKED);
+    
+    checkPackets(dir + "/v1.bin", LOG_FORMAT_LEGACY, false);
+    checkPackets(dir + "/v2.bin", LOG_FORMAT_RAW, false);
+    checkPackets(dir + "/v3.bin", LOG_FORMAT_DELTA, false);
+    checkPackets(dir + "/v4.bin", LOG_FORMAT_CHECKED, false);
+    checkPackets(dir + "/v5_closed.bin", LOG_FORMAT_STREAMS, true);
+    checkPackets(dir + "/v5_open.bin", LOG_FORMAT_STREAMS, false);
+    checkSamples(dir + "/v5_closed.bin");
+    checkSamples(dir + "/v5_open.bin");
+    checkCorruptBlock(dir + "/v4.bin", dir + "/v4_corrupt.bin");
+    checkRejects(dir + "/v3.bin", dir + "/v3_bad_header.bin");
+    
+    if (failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("logdecode self-test passed\n");
+    return 0;
+}